@@ -0,0 +1,23 @@
+######################################################################
+# Valkyrie qmake include file: common to the benchmarks
+#
+# Included from bench/<name>/<name>.pro
+######################################################################
+
+VK_ROOT = $$PWD/..
+VK_SRC  = $${VK_ROOT}/src
+
+include( $${VK_ROOT}/vk_config.pri )
+
+# timings of a debug build mean nothing
+CONFIG       -= debug
+CONFIG       += release
+CONFIG       += console
+
+TEMPLATE      = app
+
+MOC_DIR       = moc
+OBJECTS_DIR   = obj
+DESTDIR       = $${VK_ROOT}/bin
+
+INCLUDEPATH  += $${VK_SRC}
@@ -0,0 +1,15 @@
+######################################################################
+# Valkyrie qmake project file: build the benchmarks
+#
+# Not part of the default build: qmake && make in this directory.
+#  - vglogbench:  log parser alone, fast tokenizer vs QXmlStreamReader,
+#                 and the parallel loader by thread count
+#  - vgloggen:    synthetic valgrind xml logs, to measure with
+#  - vgviewbench: parse + memcheck/helgrind view ingestion, headless
+#
+# vgviewbench builds the application's sources: qmake in src/ first,
+# as that generates src/utils/vk_defines.h
+######################################################################
+
+TEMPLATE = subdirs
+SUBDIRS  = vglogbench vgloggen vgviewbench
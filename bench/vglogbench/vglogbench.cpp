@@ -0,0 +1,301 @@
+/****************************************************************************
+** vglogbench
+**  - times the valgrind xml log parser: fast tokenizer vs QXmlStreamReader,
+**    and the parallel loader over a range of thread counts
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgloginput.h"
+#include "utils/vglogloader.h"
+#include "utils/vglogreader.h"
+#include "utils/vglogtokenizer.h"
+#include "utils/vk_utils.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <QXmlStreamReader>
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// default runs of each: the best is reported
+#define VG_BENCH_RUNS 5
+// default VgLogLoader thread counts
+#define VG_BENCH_THREADS "1,2,4,8"
+
+
+
+// ============================================================
+// vk_utils.cpp would bring in the whole config:
+// just what the parser uses.
+
+void vkPrint( const char* msg, ... )
+{
+   va_list ap;
+   va_start( ap, msg );
+   vfprintf( stdout, msg, ap );
+   va_end( ap );
+   fprintf( stdout, "\n" );
+}
+
+void vkPrintErr( const char* msg, ... )
+{
+   va_list ap;
+   va_start( ap, msg );
+   vfprintf( stderr, msg, ap );
+   va_end( ap );
+   fprintf( stderr, "\n" );
+}
+
+void vkDebug( const char* msg, ... )
+{
+   va_list ap;
+   va_start( ap, msg );
+   vfprintf( stderr, msg, ap );
+   va_end( ap );
+   fprintf( stderr, "\n" );
+}
+
+__attribute__(( noreturn ) )
+void vk_assert_fail( const char* expr, const char* file,
+                     unsigned int line, const char* fn )
+{
+   vkPrintErr( "Assertion failed '%s':", expr );
+   vkPrintErr( "   at %s#%u:%s\n", file, line, fn );
+   exit( 1 );
+}
+
+__attribute__(( noreturn ) )
+void vk_assert_never_reached_fail( const char* file,
+                                   unsigned int line,
+                                   const char* fn )
+{
+   vkPrintErr( "Assertion 'never reached' failed," );
+   vkPrintErr( "   at %s#%u:%s", file, line, fn );
+   exit( 1 );
+}
+
+
+
+// ============================================================
+/*
+  Counts the records decoded, and drops them
+*/
+class VgNullSink : public VgLogSink
+{
+public:
+   VgNullSink() : records( 0 ) { }
+
+   bool init( QString /*doc_tag*/ ) {
+      return true;
+   }
+   bool appendNode( const VgLogRecord& /*rec*/, QString& /*errMsg*/ ) {
+      records++;
+      return true;
+   }
+
+   int records;
+};
+
+
+/*
+  A benchmark: false if it failed.
+   - count gets the records decoded, or -1 if it doesn't decode.
+*/
+typedef bool ( *BenchFn )( const QByteArray& log, int& count );
+
+/* raw tokenizing: no handler, so no decoding */
+static bool tokenizeFast( const QByteArray& log, int& count )
+{
+   VgLogTokenizer tokenizer( 0 );
+   count = -1;
+   return tokenizer.parse( log.constData(), log.size() ) == VgLogTokenizer::OK;
+}
+
+static bool tokenizeQXml( const QByteArray& log, int& count )
+{
+   QXmlStreamReader xml( log );
+   count = -1;
+   while ( !xml.atEnd() ) {
+      xml.readNext();
+   }
+   return !xml.hasError();
+}
+
+/* the whole VgLogReader path, into a null sink */
+static bool decode( const QByteArray& log, bool fast, int& count )
+{
+   VgNullSink sink;
+   VgLogReader reader( &sink );
+   reader.setFastPath( fast );
+   bool ok = reader.parseData( log );
+   count = sink.records;
+   return ok;
+}
+
+static bool decodeFast( const QByteArray& log, int& count )
+{
+   return decode( log, true, count );
+}
+
+static bool decodeQXml( const QByteArray& log, int& count )
+{
+   return decode( log, false, count );
+}
+
+
+static void bench( const char* what, BenchFn fn, const QByteArray& log, int runs )
+{
+   qint64 best = -1;
+   int count = -1;
+
+   for ( int i = 0; i < runs; i++ ) {
+      QElapsedTimer timer;
+      timer.start();
+      if ( !fn( log, count ) ) {
+         printf( "%-28s failed\n", what );
+         return;
+      }
+      qint64 ns = timer.nsecsElapsed();
+      if ( best < 0 || ns < best ) {
+         best = ns;
+      }
+   }
+
+   // bytes per ns == GB/s
+   double gbs = ( double )log.size() / qMax( best, ( qint64 )1 );
+   printf( "%-28s %8.3f GB/s %10.1f ms", what, gbs, best / 1e6 );
+   if ( count >= 0 ) {
+      printf( " %10d records", count );
+   }
+   printf( "\n" );
+}
+
+
+/*
+  VgLogLoader on the log file itself, with the given thread count
+   - it maps the file: the page cache is warm after the runs above.
+*/
+static void benchLoader( QString fname, qint64 size, int nthreads, int runs )
+{
+   qint64 best = -1;
+   int count = -1;
+
+   for ( int i = 0; i < runs; i++ ) {
+      VgNullSink sink;
+      VgLogLoader loader( &sink );
+      QElapsedTimer timer;
+      timer.start();
+      if ( !loader.load( fname, nthreads ) ) {
+         printf( "load: %2d threads              failed "
+                 "(compressed, or not for the loader)\n", nthreads );
+         return;
+      }
+      qint64 ns = timer.nsecsElapsed();
+      if ( best < 0 || ns < best ) {
+         best = ns;
+      }
+      count = sink.records;
+   }
+
+   // bytes per us ~= MB/s
+   double mbs = ( double )size * 1000.0 / qMax( best, ( qint64 )1 );
+   printf( "load: %2d threads %20.1f MB/s %8.1f ms %10d records\n",
+           nthreads, mbs, best / 1e6, count );
+}
+
+
+/*
+  Read the whole log into memory: compressed logs are inflated first.
+*/
+static bool readLog( QString fname, QByteArray& log )
+{
+   VgLogInput input;
+   if ( !input.open( fname ) ) {
+      vkPrintErr( "%s", qPrintable( input.errorString() ) );
+      return false;
+   }
+
+   char buf[ 64 * 1024 ];
+   qint64 nread;
+   while ( ( nread = input.read( buf, sizeof( buf ) ) ) > 0 ) {
+      log.append( buf, nread );
+   }
+   if ( nread < 0 ) {
+      vkPrintErr( "%s", qPrintable( input.errorString() ) );
+      return false;
+   }
+   return true;
+}
+
+
+int main( int argc, char* argv[] )
+{
+   QString threadList = VG_BENCH_THREADS;
+   QStringList args;
+   for ( int i = 1; i < argc; i++ ) {
+      if ( strcmp( argv[i], "--threads" ) == 0 && i + 1 < argc ) {
+         threadList = argv[++i];
+      }
+      else {
+         args << QFile::decodeName( argv[i] );
+      }
+   }
+
+   QList<int> threads;
+   foreach( const QString& n, threadList.split( ',', QString::SkipEmptyParts ) ) {
+      if ( n.toInt() > 0 ) {
+         threads << n.toInt();
+      }
+   }
+
+   if ( args.isEmpty() || threads.isEmpty() ) {
+      vkPrintErr( "usage: %s [--threads <n,n,...>] <log.xml> [<runs>]", argv[0] );
+      return 1;
+   }
+
+   int runs = ( args.count() > 1 ) ? args[1].toInt() : VG_BENCH_RUNS;
+   if ( runs < 1 ) {
+      runs = 1;
+   }
+
+   QByteArray log;
+   if ( !readLog( args[0], log ) ) {
+      return 1;
+   }
+
+   printf( "%s: %.1f MB, best of %d runs, text scan: %s\n\n",
+           qPrintable( args[0] ), log.size() / ( 1024.0 * 1024.0 ), runs,
+           VgLogTokenizer::scanMode() );
+
+   bench( "tokenize: fast",             tokenizeFast, log, runs );
+   bench( "tokenize: QXmlStreamReader", tokenizeQXml, log, runs );
+   bench( "decode: fast",               decodeFast,   log, runs );
+   bench( "decode: QXmlStreamReader",   decodeQXml,   log, runs );
+
+   printf( "\n" );
+   foreach( int n, threads ) {
+      benchLoader( args[0], log.size(), n, runs );
+   }
+
+   return 0;
+}
@@ -0,0 +1,44 @@
+######################################################################
+# Valkyrie qmake project file: build the log parser benchmark
+#
+# Run: bin/vglogbench [--threads <n,n,...>] <log.xml> [<runs>]
+######################################################################
+
+QT += widgets      # vk_utils.h
+
+include( ../bench.pri )
+
+TARGET        = vglogbench
+
+
+######################################################################
+# Just the log parser and loader: no gui, no config
+SOURCES += \
+    vglogbench.cpp \
+    $${VK_SRC}/utils/vgloginput.cpp \
+    $${VK_SRC}/utils/vglogloader.cpp \
+    $${VK_SRC}/utils/vglogreader.cpp \
+    $${VK_SRC}/utils/vglogrecord.cpp \
+    $${VK_SRC}/utils/vglogsource.cpp \
+    $${VK_SRC}/utils/vglogtokenizer.cpp \
+    $${VK_SRC}/utils/vk_atoms.cpp
+
+HEADERS += \
+    $${VK_SRC}/utils/vgloginput.h \
+    $${VK_SRC}/utils/vglogloader.h \
+    $${VK_SRC}/utils/vglogreader.h \
+    $${VK_SRC}/utils/vglogrecord.h \
+    $${VK_SRC}/utils/vglogsource.h \
+    $${VK_SRC}/utils/vglogtokenizer.h \
+    $${VK_SRC}/utils/vk_atoms.h
+
+
+######################################################################
+# Compressed logs: as for the application
+LIBS += -lz
+
+CONFIG += link_pkgconfig
+packagesExist( libzstd ) {
+  PKGCONFIG += libzstd
+  DEFINES   += VK_HAVE_ZSTD
+}
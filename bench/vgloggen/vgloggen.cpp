@@ -0,0 +1,740 @@
+/****************************************************************************
+** vgloggen
+**  - writes synthetic valgrind xml logs (protocol 4), for benchmarking
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// output buffer: logs are big
+#define GEN_OUTBUF_SIZE ( 1024 * 1024 )
+
+// error counts bumped each time <errorcounts> is written
+#define GEN_COUNT_BUMPS 16
+
+// innermost frames favour the first so many functions (malloc & co)
+#define GEN_HOT_SYMBOLS 32
+
+
+
+// ============================================================
+/*
+  What to generate: see usage()
+*/
+struct GenOpts {
+   GenOpts()
+      : errors( 10000 ), depth( 12 ), symbols( 2000 ), leakRatio( 0.2 ),
+        helgrind( false ), countsEvery( 0 ), threads( 4 ), suppressions( false ),
+        seed( 1 ), outfile( 0 ) { }
+
+   long errors;         // unique errors, leaks included
+   int depth;           // frames per stack
+   int symbols;         // distinct functions
+   double leakRatio;    // memcheck: fraction of errors that are leaks
+   bool helgrind;
+   long countsEvery;    // <errorcounts> every so many errors: 0 = at the end
+   int threads;         // helgrind: threads announced
+   bool suppressions;   // a <suppression> per error, as --gen-suppressions=all
+   unsigned long seed;
+   const char* outfile; // 0: stdout
+};
+
+
+/*
+  xorshift64*: the same logs on every platform, unlike rand()
+*/
+class GenRandom
+{
+public:
+   GenRandom( unsigned long seed )
+      : state( seed * 0x9E3779B97F4A7C15ULL + 1 ) { }
+
+   uint64_t next() {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545F4914F6CDD1DULL;
+   }
+   // [0, n)
+   long below( long n ) {
+      return n <= 1 ? 0 : ( long )( next() % ( uint64_t )n );
+   }
+   bool chance( double p ) {
+      return ( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ) < p;
+   }
+
+private:
+   uint64_t state;
+};
+
+
+/*
+  A function, as valgrind would describe it: fn already xml-escaped,
+  raw as it goes in a suppression's cdata
+*/
+struct GenSymbol {
+   string fn;
+   string raw;
+   string obj;
+   string dir;
+   string file;
+   unsigned long ip;
+   int line;
+};
+
+
+
+// ============================================================
+class LogGen
+{
+public:
+   LogGen( const GenOpts& opts, FILE* out );
+   void write();
+
+private:
+   void makeSymbols();
+   void header();
+   void status( const char* state );
+   void stack( int depth );
+   void memcheckError( long n );
+   void leakError( long n, long nLeaks );
+   void helgrindError( long n );
+   void announceThread( int tid );
+   void suppression( const char* skind, const char* skaux );
+   void errorCounts();
+   void suppCounts();
+
+private:
+   const GenOpts& opts;
+   FILE* out;
+   GenRandom rnd;
+   vector<GenSymbol> symbols;
+   vector<long> counts;           // per non-leak error, by unique
+   vector<bool> announced;        // helgrind threads
+   vector<long> errStack;         // the current error's first stack
+   long msecs;                    // the log's clock
+};
+
+
+LogGen::LogGen( const GenOpts& o, FILE* f )
+   : opts( o ), out( f ), rnd( o.seed ), msecs( 0 )
+{ }
+
+
+static string xmlEscape( const char* s )
+{
+   string res;
+   for ( ; *s != 0; s++ ) {
+      switch ( *s ) {
+      case '<': res += "&lt;";  break;
+      case '>': res += "&gt;";  break;
+      case '&': res += "&amp;"; break;
+      default:  res += *s;      break;
+      }
+   }
+   return res;
+}
+
+
+/*
+  The function pool: a mix of c, c++ and templated names
+  (the latter with entities to resolve), in a few objects.
+*/
+void LogGen::makeSymbols()
+{
+   static const char* const types[] = { "int", "char", "unsigned long", "Node*" };
+   char buf[512];
+
+   int nObjs = opts.symbols / 200 + 1;
+   symbols.resize( opts.symbols );
+
+   for ( int i = 0; i < opts.symbols; i++ ) {
+      GenSymbol& sym = symbols[i];
+
+      switch ( i % 4 ) {
+      case 0:
+         snprintf( buf, sizeof( buf ), "process_%d", i );
+         break;
+      case 1:
+         snprintf( buf, sizeof( buf ), "ns%d::Widget%d::update(int, char const*)",
+                   i % 17, i );
+         break;
+      case 2:
+         snprintf( buf, sizeof( buf ),
+                   "std::vector<%s, std::allocator<%s> >::push_back_%d(%s const&)",
+                   types[i / 4 % 4], types[i / 4 % 4], i, types[i / 4 % 4] );
+         break;
+      default:
+         snprintf( buf, sizeof( buf ), "Parser%d::parse(std::string const&) const", i );
+         break;
+      }
+      sym.raw = buf;
+      sym.fn = xmlEscape( buf );
+
+      int obj = i % nObjs;
+      if ( obj == 0 ) {
+         sym.obj = "/home/user/build/bin/bench_app";
+      }
+      else {
+         snprintf( buf, sizeof( buf ), "/usr/lib/x86_64-linux-gnu/libmod%d.so.1", obj );
+         sym.obj = buf;
+      }
+
+      snprintf( buf, sizeof( buf ), "/home/user/src/module_%d", i / 64 );
+      sym.dir = buf;
+      snprintf( buf, sizeof( buf ), "file_%d.cpp", i / 8 );
+      sym.file = buf;
+
+      sym.ip = 0x400000UL + obj * 0x1000000UL + i * 0x40UL;
+      sym.line = 1 + ( i * 37 ) % 2000;
+   }
+}
+
+
+void LogGen::header()
+{
+   const char* tool = opts.helgrind ? "helgrind" : "memcheck";
+
+   fprintf( out,
+            "<?xml version=\"1.0\"?>\n"
+            "\n"
+            "<valgrindoutput>\n"
+            "\n"
+            "<protocolversion>4</protocolversion>\n"
+            "<protocoltool>%s</protocoltool>\n"
+            "\n"
+            "<preamble>\n"
+            "  <line>%s</line>\n"
+            "  <line>Copyright (C) 2002-2010, and GNU GPL'd, by Julian Seward et al.</line>\n"
+            "  <line>Using Valgrind-3.6.0 and LibVEX; rerun with -h for copyright info</line>\n"
+            "  <line>Command: ./bench_app --synthetic</line>\n"
+            "</preamble>\n"
+            "\n"
+            "<pid>4242</pid>\n"
+            "<ppid>4241</ppid>\n"
+            "<tool>%s</tool>\n"
+            "\n"
+            "<args>\n"
+            "  <vargv>\n"
+            "    <exe>/usr/bin/valgrind</exe>\n"
+            "    <arg>--tool=%s</arg>\n"
+            "    <arg>--xml=yes</arg>\n"
+            "    <arg>--xml-file=bench.xml</arg>\n"
+            "  </vargv>\n"
+            "  <argv>\n"
+            "    <exe>./bench_app</exe>\n"
+            "    <arg>--synthetic</arg>\n"
+            "  </argv>\n"
+            "</args>\n"
+            "\n",
+            tool,
+            opts.helgrind ? "Helgrind, a thread error detector"
+                          : "Memcheck, a memory error detector",
+            tool, tool );
+}
+
+
+void LogGen::status( const char* state )
+{
+   msecs += 1 + rnd.below( 1000 );
+   fprintf( out,
+            "<status>\n"
+            "  <state>%s</state>\n"
+            "  <time>%02ld:%02ld:%02ld:%02ld.%03ld </time>\n"
+            "</status>\n"
+            "\n",
+            state,
+            msecs / 86400000, ( msecs / 3600000 ) % 24, ( msecs / 60000 ) % 60,
+            ( msecs / 1000 ) % 60, msecs % 1000 );
+}
+
+
+/*
+  A stack: frames drawn from the function pool, with the innermost
+  frame most likely a popular one (as are allocators etc).
+   - an error's first stack is kept for its suppression
+*/
+void LogGen::stack( int depth )
+{
+   bool first = errStack.empty();
+   fprintf( out, "  <stack>\n" );
+
+   for ( int i = 0; i < depth; i++ ) {
+      long n = ( i == 0 && rnd.chance( 0.5 ) )
+               ? rnd.below( GEN_HOT_SYMBOLS < opts.symbols ? GEN_HOT_SYMBOLS : opts.symbols )
+               : rnd.below( opts.symbols );
+      const GenSymbol& sym = symbols[n];
+      if ( first ) {
+         errStack.push_back( n );
+      }
+
+      fprintf( out,
+               "    <frame>\n"
+               "      <ip>0x%lX</ip>\n"
+               "      <obj>%s</obj>\n"
+               "      <fn>%s</fn>\n"
+               "      <dir>%s</dir>\n"
+               "      <file>%s</file>\n"
+               "      <line>%d</line>\n"
+               "    </frame>\n",
+               sym.ip + rnd.below( 0x40 ), sym.obj.c_str(), sym.fn.c_str(),
+               sym.dir.c_str(), sym.file.c_str(), sym.line + ( int )rnd.below( 20 ) );
+   }
+
+   fprintf( out, "  </stack>\n" );
+}
+
+
+/*
+  A memcheck error: something bad done to a heap block,
+  with the block's allocation stack, or an uninitialised value.
+*/
+void LogGen::memcheckError( long n )
+{
+   static const char* const kinds[] = {
+      "InvalidRead", "InvalidWrite", "InvalidFree", "UninitCondition", "UninitValue"
+   };
+   static const char* const skinds[] = {
+      "Addr", "Addr", "Free", "Cond", "Value"
+   };
+   int k = rnd.below( 5 );
+   int size = 1 << rnd.below( 4 );
+   char skind[32];
+
+   fprintf( out,
+            "<error>\n"
+            "  <unique>0x%lx</unique>\n"
+            "  <tid>%d</tid>\n"
+            "  <kind>%s</kind>\n",
+            n, 1 + ( int )rnd.below( opts.threads ), kinds[k] );
+
+   switch ( k ) {
+   case 0:
+   case 1:
+      fprintf( out, "  <what>Invalid %s of size %d</what>\n",
+               k == 0 ? "read" : "write", size );
+      break;
+   case 2:
+      fprintf( out, "  <what>Invalid free() / delete / delete[] / realloc()</what>\n" );
+      break;
+   case 3:
+      fprintf( out, "  <what>Conditional jump or move depends on uninitialised value(s)</what>\n" );
+      break;
+   default:
+      fprintf( out, "  <what>Use of uninitialised value of size %d</what>\n", size * 2 );
+      break;
+   }
+
+   stack( opts.depth );
+
+   if ( k <= 2 ) {
+      fprintf( out, "  <auxwhat>Address 0x%lx is %d bytes inside a block of size %d free'd</auxwhat>\n",
+               0x5000000UL + n * 0x40, ( int )rnd.below( 16 ), 16 + ( int )rnd.below( 256 ) );
+      stack( opts.depth / 2 + 1 );
+   }
+
+   if ( k <= 1 || k == 4 ) {
+      snprintf( skind, sizeof( skind ), "Memcheck:%s%d", skinds[k],
+                k == 4 ? size * 2 : size );
+   }
+   else {
+      snprintf( skind, sizeof( skind ), "Memcheck:%s", skinds[k] );
+   }
+   suppression( skind, 0 );
+
+   fprintf( out, "</error>\n\n" );
+}
+
+
+void LogGen::leakError( long n, long nLeaks )
+{
+   static const char* const kinds[] = {
+      "Leak_DefinitelyLost", "Leak_IndirectlyLost", "Leak_PossiblyLost", "Leak_StillReachable"
+   };
+   static const char* const lost[] = {
+      "definitely lost", "indirectly lost", "possibly lost", "still reachable"
+   };
+   static const char* const skaux[] = {
+      "match-leak-kinds: definite", "match-leak-kinds: indirect",
+      "match-leak-kinds: possible", "match-leak-kinds: reachable"
+   };
+   int k = rnd.below( 4 );
+   long blocks = 1 + rnd.below( 100 );
+   long bytes = blocks * ( 8 + rnd.below( 1024 ) );
+
+   fprintf( out,
+            "<error>\n"
+            "  <unique>0x%lx</unique>\n"
+            "  <tid>1</tid>\n"
+            "  <kind>%s</kind>\n"
+            "  <xwhat>\n"
+            "    <text>%ld bytes in %ld blocks are %s in loss record %ld of %ld</text>\n"
+            "    <leakedbytes>%ld</leakedbytes>\n"
+            "    <leakedblocks>%ld</leakedblocks>\n"
+            "  </xwhat>\n",
+            n, kinds[k], bytes, blocks, lost[k], n - ( opts.errors - nLeaks ) + 1, nLeaks,
+            bytes, blocks );
+
+   stack( opts.depth );
+   suppression( "Memcheck:Leak", skaux[k] );
+
+   fprintf( out, "</error>\n\n" );
+}
+
+
+void LogGen::announceThread( int tid )
+{
+   fprintf( out,
+            "<announcethread>\n"
+            "  <hthreadid>%d</hthreadid>\n",
+            tid );
+   if ( tid > 1 ) {
+      stack( opts.depth / 2 + 1 );
+      errStack.clear();   // not an error's
+   }
+   fprintf( out, "</announcethread>\n\n" );
+}
+
+
+/*
+  A helgrind error: mostly races, between two announced threads.
+*/
+void LogGen::helgrindError( long n )
+{
+   int tid = 1 + rnd.below( opts.threads );
+   int other = 1 + ( tid + rnd.below( opts.threads - 1 ) ) % opts.threads;
+
+   if ( !announced[tid] ) {
+      announceThread( tid );
+      announced[tid] = true;
+   }
+   if ( !announced[other] ) {
+      announceThread( other );
+      announced[other] = true;
+   }
+
+   int k = rnd.below( 10 );
+   const char* kind = ( k < 7 ) ? "Race" : ( k < 9 ) ? "LockOrder" : "UnlockUnlocked";
+   unsigned long addr = 0x6000000UL + n * 0x10;
+
+   fprintf( out,
+            "<error>\n"
+            "  <unique>0x%lx</unique>\n"
+            "  <tid>%d</tid>\n"
+            "  <kind>%s</kind>\n"
+            "  <xwhat>\n",
+            n, tid, kind );
+
+   if ( k < 7 ) {
+      fprintf( out,
+               "    <text>Possible data race during write of size 4 at 0x%lX by thread #%d</text>\n"
+               "    <hthreadid>%d</hthreadid>\n"
+               "  </xwhat>\n",
+               addr, tid, tid );
+      stack( opts.depth );
+      fprintf( out,
+               "  <xauxwhat>\n"
+               "    <text>This conflicts with a previous read of size 4 by thread #%d</text>\n"
+               "    <hthreadid>%d</hthreadid>\n"
+               "  </xauxwhat>\n",
+               other, other );
+      stack( opts.depth );
+   }
+   else if ( k < 9 ) {
+      fprintf( out,
+               "    <text>Thread #%d: lock order \"0x%lX before 0x%lX\" violated</text>\n"
+               "    <hthreadid>%d</hthreadid>\n"
+               "  </xwhat>\n",
+               tid, addr, addr + 8, tid );
+      stack( opts.depth );
+      fprintf( out, "  <auxwhat>Required order was established by acquisition of lock at 0x%lX</auxwhat>\n",
+               addr );
+      stack( opts.depth / 2 + 1 );
+   }
+   else {
+      fprintf( out,
+               "    <text>Thread #%d unlocked a not-locked lock at 0x%lX </text>\n"
+               "    <hthreadid>%d</hthreadid>\n"
+               "  </xwhat>\n",
+               tid, addr, tid );
+      stack( opts.depth );
+   }
+
+   char skind[32];
+   snprintf( skind, sizeof( skind ), "Helgrind:%s", kind );
+   suppression( skind, 0 );
+
+   fprintf( out, "</error>\n\n" );
+}
+
+
+/*
+  The error's suppression, from its first stack: the frames again
+  in <rawtext>, as a cdata section with the names unescaped.
+   - nothing unless asked for, but the stack's always forgotten
+*/
+void LogGen::suppression( const char* skind, const char* skaux )
+{
+   if ( !opts.suppressions ) {
+      errStack.clear();
+      return;
+   }
+
+   fprintf( out,
+            "  <suppression>\n"
+            "    <sname>insert_a_suppression_name_here</sname>\n"
+            "    <skind>%s</skind>\n",
+            skind );
+   if ( skaux != 0 ) {
+      fprintf( out, "    <skaux>%s</skaux>\n", skaux );
+   }
+   for ( size_t i = 0; i < errStack.size(); i++ ) {
+      fprintf( out, "    <sframe> <fun>%s</fun> </sframe>\n",
+               symbols[errStack[i]].fn.c_str() );
+   }
+
+   fprintf( out,
+            "    <rawtext>\n"
+            "<![CDATA[\n"
+            "{\n"
+            "   <insert_a_suppression_name_here>\n"
+            "   %s\n",
+            skind );
+   if ( skaux != 0 ) {
+      fprintf( out, "   %s\n", skaux );
+   }
+   for ( size_t i = 0; i < errStack.size(); i++ ) {
+      fprintf( out, "   fun:%s\n", symbols[errStack[i]].raw.c_str() );
+   }
+   fprintf( out,
+            "}\n"
+            "]]>\n"
+            "    </rawtext>\n"
+            "  </suppression>\n" );
+
+   errStack.clear();
+}
+
+
+/*
+  Counts for every (non-leak) error so far: a few have recurred
+  since last time.
+*/
+void LogGen::errorCounts()
+{
+   long seen = counts.size();
+   if ( seen == 0 ) {
+      return;
+   }
+
+   for ( int i = 0; i < GEN_COUNT_BUMPS; i++ ) {
+      counts[rnd.below( seen )] += 1 + rnd.below( 3 );
+   }
+
+   fprintf( out, "<errorcounts>\n" );
+   for ( long n = 0; n < seen; n++ ) {
+      fprintf( out,
+               "  <pair>\n"
+               "    <count>%ld</count>\n"
+               "    <unique>0x%lx</unique>\n"
+               "  </pair>\n",
+               counts[n], n );
+   }
+   fprintf( out, "</errorcounts>\n\n" );
+}
+
+
+void LogGen::suppCounts()
+{
+   fprintf( out,
+            "<suppcounts>\n"
+            "  <pair>\n"
+            "    <count>%ld</count>\n"
+            "    <name>dl-hack3-cond-1</name>\n"
+            "  </pair>\n"
+            "</suppcounts>\n\n",
+            1 + rnd.below( 10 ) );
+}
+
+
+/*
+  The whole log: as valgrind, memcheck's leaks come after the
+  program's finished, followed by the final counts.
+*/
+void LogGen::write()
+{
+   makeSymbols();
+   announced.assign( opts.threads + 1, false );
+
+   long nLeaks = opts.helgrind ? 0 : ( long )( opts.errors * opts.leakRatio + 0.5 );
+   long nErrors = opts.errors - nLeaks;
+
+   header();
+   status( "RUNNING" );
+
+   for ( long n = 0; n < nErrors; n++ ) {
+      if ( opts.helgrind ) {
+         helgrindError( n );
+      }
+      else {
+         memcheckError( n );
+      }
+      counts.push_back( 1 );
+
+      if ( opts.countsEvery > 0 && ( n + 1 ) % opts.countsEvery == 0 ) {
+         errorCounts();
+      }
+   }
+
+   status( "FINISHED" );
+
+   for ( long n = nErrors; n < opts.errors; n++ ) {
+      leakError( n, nLeaks );
+   }
+
+   errorCounts();
+   suppCounts();
+
+   fprintf( out, "</valgrindoutput>\n\n" );
+}
+
+
+
+// ============================================================
+static void usage( const char* prog )
+{
+   fprintf( stderr,
+            "usage: %s [options]\n"
+            "Writes a synthetic valgrind xml log (protocol 4).\n"
+            "  --tool=memcheck|helgrind   [memcheck]\n"
+            "  --errors=<n>               unique errors, leaks included [10000]\n"
+            "  --stack-depth=<n>          frames per stack [12]\n"
+            "  --symbols=<n>              distinct functions [2000]\n"
+            "  --leak-ratio=<f>           memcheck: fraction of errors that are leaks [0.2]\n"
+            "  --errorcounts-every=<n>    <errorcounts> every n errors, 0: at the end [0]\n"
+            "  --threads=<n>              threads [4]\n"
+            "  --gen-suppressions=no|all  a suppression per error, with cdata [no]\n"
+            "  --seed=<n>                 [1]\n"
+            "  -o <file>                  [stdout]\n",
+            prog );
+}
+
+
+/*
+  --name=value: value if arg is for 'name', else 0
+*/
+static const char* optArg( const char* arg, const char* name )
+{
+   size_t len = strlen( name );
+   if ( strncmp( arg, name, len ) != 0 || arg[len] != '=' ) {
+      return 0;
+   }
+   return arg + len + 1;
+}
+
+
+int main( int argc, char* argv[] )
+{
+   GenOpts opts;
+   const char* val;
+
+   for ( int i = 1; i < argc; i++ ) {
+      const char* arg = argv[i];
+
+      if ( ( val = optArg( arg, "--tool" ) ) != 0 ) {
+         if ( strcmp( val, "helgrind" ) == 0 ) {
+            opts.helgrind = true;
+         }
+         else if ( strcmp( val, "memcheck" ) != 0 ) {
+            usage( argv[0] );
+            return 1;
+         }
+      }
+      else if ( ( val = optArg( arg, "--errors" ) ) != 0 ) {
+         opts.errors = atol( val );
+      }
+      else if ( ( val = optArg( arg, "--stack-depth" ) ) != 0 ) {
+         opts.depth = atoi( val );
+      }
+      else if ( ( val = optArg( arg, "--symbols" ) ) != 0 ) {
+         opts.symbols = atoi( val );
+      }
+      else if ( ( val = optArg( arg, "--leak-ratio" ) ) != 0 ) {
+         opts.leakRatio = atof( val );
+      }
+      else if ( ( val = optArg( arg, "--errorcounts-every" ) ) != 0 ) {
+         opts.countsEvery = atol( val );
+      }
+      else if ( ( val = optArg( arg, "--threads" ) ) != 0 ) {
+         opts.threads = atoi( val );
+      }
+      else if ( ( val = optArg( arg, "--gen-suppressions" ) ) != 0 ) {
+         if ( strcmp( val, "all" ) == 0 ) {
+            opts.suppressions = true;
+         }
+         else if ( strcmp( val, "no" ) != 0 ) {
+            usage( argv[0] );
+            return 1;
+         }
+      }
+      else if ( ( val = optArg( arg, "--seed" ) ) != 0 ) {
+         opts.seed = strtoul( val, 0, 0 );
+      }
+      else if ( strcmp( arg, "-o" ) == 0 && i + 1 < argc ) {
+         opts.outfile = argv[++i];
+      }
+      else {
+         usage( argv[0] );
+         return 1;
+      }
+   }
+
+   if ( opts.errors < 0 || opts.depth < 1 || opts.symbols < 1 ||
+        opts.leakRatio < 0 || opts.leakRatio > 1 ||
+        opts.countsEvery < 0 || opts.threads < 2 ) {
+      usage( argv[0] );
+      return 1;
+   }
+
+   FILE* out = stdout;
+   if ( opts.outfile != 0 ) {
+      out = fopen( opts.outfile, "w" );
+      if ( out == 0 ) {
+         perror( opts.outfile );
+         return 1;
+      }
+   }
+   setvbuf( out, 0, _IOFBF, GEN_OUTBUF_SIZE );
+
+   LogGen gen( opts, out );
+   gen.write();
+
+   if ( fclose( out ) != 0 ) {
+      perror( opts.outfile != 0 ? opts.outfile : "stdout" );
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,14 @@
+######################################################################
+# Valkyrie qmake project file: build the synthetic log generator
+#
+# Run: bin/vgloggen --help
+######################################################################
+
+include( ../bench.pri )
+
+# plain c++: no Qt
+CONFIG       -= qt
+
+TARGET        = vgloggen
+
+SOURCES += vgloggen.cpp
@@ -0,0 +1,348 @@
+/****************************************************************************
+** vgviewbench
+**  - times a log's ingestion into the memcheck / helgrind log views
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/helgrind_logview.h"
+#include "toolview/memcheck_logview.h"
+#include "utils/vgloginput.h"
+#include "utils/vglogreader.h"
+#include "utils/vk_config.h"
+#include "utils/vk_utils.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTreeView>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+
+VkCfgGlbl* vkCfgGlbl = NULL;  // as main.cpp: no config needed here
+VkCfgProj* vkCfgProj = NULL;
+
+
+// records per batched view update: as ToolObject hands over a
+// worker's records (VG_LOG_FLUSH_BATCHES batches of 100)
+#define VG_BENCH_BATCH 1600
+
+// bytes sniffed for the tool, if not given
+#define VG_BENCH_SNIFF ( 64 * 1024 )
+
+
+
+// ============================================================
+// Allocation counting: glibc lets us stand in for malloc & co.
+#ifdef __GLIBC__
+#define VG_BENCH_ALLOCS
+
+extern "C" {
+   extern void* __libc_malloc( size_t size );
+   extern void* __libc_calloc( size_t n, size_t size );
+   extern void* __libc_realloc( void* ptr, size_t size );
+   extern void  __libc_free( void* ptr );
+}
+
+static unsigned long long nAllocs = 0;
+static unsigned long long nAllocBytes = 0;
+
+static inline void countAlloc( size_t size )
+{
+   __atomic_fetch_add( &nAllocs, 1, __ATOMIC_RELAXED );
+   __atomic_fetch_add( &nAllocBytes, size, __ATOMIC_RELAXED );
+}
+
+extern "C" {
+   void* malloc( size_t size ) {
+      countAlloc( size );
+      return __libc_malloc( size );
+   }
+   void* calloc( size_t n, size_t size ) {
+      countAlloc( n * size );
+      return __libc_calloc( n, size );
+   }
+   void* realloc( void* ptr, size_t size ) {
+      countAlloc( size );
+      return __libc_realloc( ptr, size );
+   }
+   void free( void* ptr ) {
+      __libc_free( ptr );
+   }
+}
+#endif
+
+
+
+// ============================================================
+/*
+  Hands the records on to the view in batches, as ToolObject does
+  with a worker's records (see ToolObject::flushVgLogRecords())
+*/
+class VgBatchSink : public VgLogSink
+{
+public:
+   VgBatchSink( VgLogView* lv, int batch )
+      : logview( lv ), batchSize( batch ), inBatch( 0 ), records( 0 ) { }
+
+   bool init( QString doc_tag ) {
+      return logview->init( doc_tag );
+   }
+
+   bool appendNode( const VgLogRecord& rec, QString& errMsg ) {
+      if ( batchSize > 0 && inBatch == 0 ) {
+         logview->beginUpdate();
+      }
+      records++;
+      bool ok = logview->appendNode( rec, errMsg );
+      if ( batchSize > 0 && ++inBatch == batchSize ) {
+         logview->endUpdate();
+         inBatch = 0;
+      }
+      return ok;
+   }
+
+   void flush() {
+      if ( inBatch > 0 ) {
+         logview->endUpdate();
+         inBatch = 0;
+      }
+   }
+
+   int count() {
+      return records;
+   }
+
+private:
+   VgLogView* logview;
+   int batchSize;
+   int inBatch;
+   int records;
+};
+
+
+/*
+  What one run cost
+*/
+struct VgBenchRun {
+   bool ok;
+   qint64 nsecs;
+   int records;
+   int items;                 // model items, once all's in
+   unsigned long long allocs;
+   unsigned long long allocBytes;
+};
+
+
+struct VgBenchOpts {
+   VgBenchOpts() : helgrind( false ), toolGiven( false ), fast( true ),
+                   batch( VG_BENCH_BATCH ), runs( 1 ) { }
+
+   QString logfile;
+   bool helgrind;
+   bool toolGiven;
+   bool fast;
+   int batch;
+   int runs;
+};
+
+
+static long peakRssKb()
+{
+   struct rusage ru;
+   if ( getrusage( RUSAGE_SELF, &ru ) != 0 ) {
+      return 0;
+   }
+   return ru.ru_maxrss;   // kB, on linux
+}
+
+
+/*
+  memcheck or helgrind: from the log's <protocoltool>
+*/
+static bool sniffHelgrind( QString logfile )
+{
+   VgLogInput input;
+   if ( !input.open( logfile ) ) {
+      return false;
+   }
+
+   QByteArray head( VG_BENCH_SNIFF, '\0' );
+   qint64 nread = input.read( head.data(), head.size() );
+   head.resize( qMax( nread, ( qint64 )0 ) );
+   return head.contains( "<protocoltool>helgrind</protocoltool>" );
+}
+
+
+/*
+  Items in the model: those set up so far
+*/
+static int countItems( VgOutputItem* item )
+{
+   int n = item->childCount();
+   for ( int i=0; i<item->childCount(); ++i ) {
+      n += countItems( item->child( i ) );
+   }
+   return n;
+}
+
+
+/*
+  Parse the log into a fresh model, in its own (hidden) tree view,
+  set up as the tool views do theirs
+*/
+static VgBenchRun ingest( const VgBenchOpts& opts )
+{
+   VgBenchRun run;
+
+   VgLogModel* model = new VgLogModel( 0 );
+   QTreeView* tree = new QTreeView();
+   tree->setUniformRowHeights( true );
+   tree->setModel( model );
+   VgLogView* logview = opts.helgrind ? ( VgLogView* )new HelgrindLogView( model )
+                                      : ( VgLogView* )new MemcheckLogView( model );
+   VgBatchSink sink( logview, opts.batch );
+   VgLogReader reader( &sink );
+   reader.setFastPath( opts.fast );
+
+#ifdef VG_BENCH_ALLOCS
+   unsigned long long allocs0 = nAllocs;
+   unsigned long long allocBytes0 = nAllocBytes;
+#endif
+   QElapsedTimer timer;
+   timer.start();
+
+   run.ok = reader.parse( opts.logfile );
+   sink.flush();
+
+   run.nsecs = timer.nsecsElapsed();
+#ifdef VG_BENCH_ALLOCS
+   run.allocs = nAllocs - allocs0;
+   run.allocBytes = nAllocBytes - allocBytes0;
+#else
+   run.allocs = 0;
+   run.allocBytes = 0;
+#endif
+
+   if ( !run.ok ) {
+      vkPrintErr( "%s", qPrintable( reader.handler()->fatalMsg() ) );
+   }
+
+   run.records = sink.count();
+   run.items = countItems( model->rootItem() );
+
+   delete logview;
+   delete tree;
+   delete model;
+   return run;
+}
+
+
+static void usage( const char* prog )
+{
+   vkPrintErr( "usage: %s <log.xml> [options]\n"
+               "  --tool=memcheck|helgrind   [from the log]\n"
+               "  --batch=<n>                records per view update, 0: none [%d]\n"
+               "  --runs=<n>                 the best is reported [1]\n"
+               "  --no-fast                  QXmlStreamReader only: no VgLogTokenizer",
+               prog, VG_BENCH_BATCH );
+}
+
+
+int main( int argc, char* argv[] )
+{
+   // no display needed
+   if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() ) {
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+   }
+   QApplication app( argc, argv );
+
+   VgBenchOpts opts;
+   QStringList args = app.arguments();
+
+   for ( int i = 1; i < args.count(); i++ ) {
+      QString arg = args[i];
+
+      if ( arg == "--tool=memcheck" || arg == "--tool=helgrind" ) {
+         opts.helgrind = ( arg == "--tool=helgrind" );
+         opts.toolGiven = true;
+      }
+      else if ( arg.startsWith( "--batch=" ) ) {
+         opts.batch = arg.mid( 8 ).toInt();
+      }
+      else if ( arg.startsWith( "--runs=" ) ) {
+         opts.runs = qMax( arg.mid( 7 ).toInt(), 1 );
+      }
+      else if ( arg == "--no-fast" ) {
+         opts.fast = false;
+      }
+      else if ( !arg.startsWith( "-" ) && opts.logfile.isEmpty() ) {
+         opts.logfile = arg;
+      }
+      else {
+         usage( argv[0] );
+         return 1;
+      }
+   }
+
+   if ( opts.logfile.isEmpty() ) {
+      usage( argv[0] );
+      return 1;
+   }
+   if ( !opts.toolGiven ) {
+      opts.helgrind = sniffHelgrind( opts.logfile );
+   }
+
+   long rss0 = peakRssKb();
+   qint64 bytes = QFileInfo( opts.logfile ).size();
+
+   VgBenchRun best;
+   best.ok = false;
+   for ( int i = 0; i < opts.runs; i++ ) {
+      VgBenchRun run = ingest( opts );
+      if ( !run.ok ) {
+         return 1;
+      }
+      if ( !best.ok || run.nsecs < best.nsecs ) {
+         best = run;
+      }
+   }
+
+   double secs = qMax( best.nsecs, ( qint64 )1 ) / 1e9;
+   double mbytes = bytes / ( 1024.0 * 1024.0 );
+   long rss = peakRssKb();
+
+   printf( "%s: %.1f MB, %s, best of %d runs, fast path %s, batches of %d\n\n",
+           qPrintable( opts.logfile ), mbytes,
+           opts.helgrind ? "helgrind" : "memcheck", opts.runs,
+           opts.fast ? "on" : "off", opts.batch );
+   printf( "parse + ingest: %10.1f ms %10.1f MB/s\n", secs * 1000, mbytes / secs );
+   printf( "records:        %10d %10.0f /s\n", best.records, best.records / secs );
+   printf( "model items:    %10d %10.0f /s\n", best.items, best.items / secs );
+#ifdef VG_BENCH_ALLOCS
+   printf( "allocations:    %10llu %10.1f MB\n",
+           best.allocs, best.allocBytes / ( 1024.0 * 1024.0 ) );
+#else
+   printf( "allocations:    not counted on this platform\n" );
+#endif
+   printf( "peak RSS:       %10.1f MB (%.1f MB at start)\n",
+           rss / 1024.0, rss0 / 1024.0 );
+
+   return 0;
+}
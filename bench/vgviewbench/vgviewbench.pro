@@ -0,0 +1,19 @@
+######################################################################
+# Valkyrie qmake project file: build the log view ingestion benchmark
+#
+# Run: QT_QPA_PLATFORM=offscreen bin/vgviewbench <log.xml> [options]
+# (offscreen is the default, if QT_QPA_PLATFORM isn't set)
+######################################################################
+
+QT += widgets
+QT += printsupport
+QT += network
+
+include( ../bench.pri )
+
+TARGET        = vgviewbench
+
+# the application, all but main()
+include( $${VK_SRC}/src.pri )
+
+SOURCES += vgviewbench.cpp
@@ -25,18 +25,49 @@ The Valgrind process control & log parsing goes like this:
 
 === Happy flow ===
 start() -> vgproc                               ->(writes)-> XML_LOG
-        -> logpoller ->(triggers)-> readVgLog() <-(reads )<- XML_LOG
-
-vgproc      ->(finished/died)-> processDone() ->(if parser done)-> DONE
-readVgLog() ->(finished parsing log)          ->(if vgproc done)-> DONE
+        -> logpoller ->(triggers)-> readVgLog()
+                     ->(queues)->   vgworker::parse()  <-(reads )<- XML_LOG
+vgworker thread ->(record batches)-> appendVgLogRecords()
+flushTimer ->(a frame's worth)-> flushVgLogRecords() -> VgLogView
+
+vgproc        ->(finished/died)-> processDone() ->(if parser done)-> DONE
+vgLogParsed() ->(finished parsing log)          ->(if vgproc done)-> DONE
+
+=== Piped log (valkyrie/log-transport=pipe) ===
+start() -> logpipe <-(--xml-fd)<- vgproc       ->(tee)-> XML_LOG
+logpipe ->(data)-> logPipeData() ->(queues)-> vgworker::parseStream()
+vgworker ->(bytes parsed)-> vgLogStreamParsed(): logpipe paused while
+          the worker's too far behind, so the pipe holds back valgrind.
+
+=== Streamed log (valkyrie/log-transport=socket) ===
+start() -> logserver <-(--xml-socket)<- vgproc, and each traced child
+logserver ->(new connection)-> logConnOpened() -> new vgworker + VgLogView
+          ->(data)->           logConnData()   ->(queues)-> vgworker::parseStream()
+          paused, as for logpipe, while that connection's worker is behind.
+parser is done once every vgworker has seen the end of its log.
+
+=== Saved log (Open Log) ===
+start() ->(queues)-> vgworker::load()
+vgworker thread ->(record batches)-> appendVgLogRecords() -> VgLogView
+                ->(progress)->       vgLogProgress()      -> status bar
+                ->(paged: rest)->    vgLogPagedRest()     -> VgLogView
+vgLogParsed() ->(finished loading log)-> DONE
+toolview ->(Load More Errors)-> VgLogView::loadMoreErrors() <-(reads)<- XML_LOG
+
+=== Followed log (Follow Log: written by some other process) ===
+start() -> logpoller ->(triggers)-> readVgLog() ->(queues)-> vgworker::parse()
+logpoller ->(log truncated/replaced)-> vgLogReplaced() -> new vgworker + VgLogView
+vgLogParsed() ->(finished parsing log)-> DONE
 
 === Exceptions ===
-processDone() ->(parser alive && vgproc error)-> stopProcess()
-readVgLog()   ->(parser error && vgproc alive)-> stopProcess()
-User Input    ->(Stop command)-> stop()       -> stopProcess()
+processDone()        ->(parser alive && vgproc error)-> stopProcess()
+vgLogParsed()        ->(parser error && vgproc alive)-> stopProcess()
+flushVgLogRecords()  ->(logview error && vgproc alive)-> stopProcess()
+User Input           ->(Stop command)-> stop()       -> stopProcess()
 
 stopProcess()
   -> cleanup logpoller
+  -> abort & cleanup vgworker
   -> cleanup vgproc
        ->(QProc::terminate)->SIGTERM->          -> processDone() -> DONE
        ->(timeout)-> killProc() ->(QtProc::kill)-> processDone() -> DONE
@@ -59,6 +90,7 @@ stopProcess()
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"      // vk_assert, VK_DEBUG, etc.
 #include "utils/vglogreader.h"
+#include "utils/vglogsource.h"
 #include "options/vk_option.h"   // PERROR* and friends
 //#include "vk_file_utils.h"       // FileCopy()
 
@@ -76,6 +108,18 @@ stopProcess()
 #define TIMEOUT_KILL_PROC       2000 // msec: 'please stop?' to 'die!'
 #define TIMEOUT_WAIT_UNTIL_DONE 5000 // msec: 'half done' to 'advise stop'
 
+// Saved logs at least this big are loaded in lazy mode:
+#define VG_LOG_LAZY_MIN ( 256 * 1024 * 1024 )
+
+// Records from the workers are shown at most this often (msecs)...
+#define VG_LOG_FLUSH_MSECS 30
+// ... unless this many batches are waiting: don't hold up the worker
+#define VG_LOG_FLUSH_BATCHES 16
+
+// Streamed logs: stop reading from valgrind while more than this is
+// queued for a worker, till it's down to half that.
+#define VG_LOG_QUEUED_MAX ( 8 * 1024 * 1024 )
+
 
 //TODO: mock a valgrind process, and setup some unit tests (and a test framework!)
 //TODO: have popups called from toolview, not object... maybe.
@@ -92,12 +136,40 @@ stopProcess()
 ToolObject::ToolObject( const QString& toolname, VGTOOL::ToolID id )
    : VkObject( toolname ),
      toolView( 0 ), vgRunSaved( true ), processId( VGTOOL::PROC_NONE ),
-     toolId( id ), vgreader( 0 ), vgproc( 0 )
+     toolId( id ), vgworker( 0 ), parserThread( 0 ),
+     parsePending( false ), parseAgain( false ), vgproc( 0 )
 {
+   // shows records a frame at a time: no repaint per record
+   flushTimer = new QTimer( this );
+   flushTimer->setSingleShot( true );
+   flushTimer->setInterval( VG_LOG_FLUSH_MSECS );
+   connect( flushTimer, SIGNAL( timeout() ),
+            this,         SLOT( flushVgLogRecords() ) );
+
    // init logpoller
    logpoller = new VkLogPoller( this );
    connect( logpoller, SIGNAL( logUpdated() ),
             this,        SLOT( readVgLog() ) );
+   connect( logpoller, SIGNAL( logReplaced() ),
+            this,        SLOT( vgLogReplaced() ) );
+
+   // init logserver
+   logserver = new VkLogServer( this );
+   connect( logserver, SIGNAL( opened( int ) ),
+            this,        SLOT( logConnOpened( int ) ) );
+   connect( logserver, SIGNAL( received( int, QByteArray ) ),
+            this,        SLOT( logConnData( int, QByteArray ) ) );
+   connect( logserver, SIGNAL( closed( int ) ),
+            this,        SLOT( logConnClosed( int ) ) );
+   connect( logserver, SIGNAL( saved( QString, QString ) ),
+            this,        SLOT( vgLogSaved( QString, QString ) ) );
+
+   // init logpipe
+   logpipe = new VkLogPipe( this );
+   connect( logpipe, SIGNAL( received( QByteArray ) ),
+            this,      SLOT( logPipeData( QByteArray ) ) );
+   connect( logpipe, SIGNAL( closed() ),
+            this,      SLOT( logPipeClosed() ) );
 }
 
 ToolObject::~ToolObject()
@@ -117,12 +189,9 @@ ToolObject::~ToolObject()
       vgproc = 0;
    }
 
-   if ( vgreader ) {
-      delete vgreader;
-      vgreader = 0;
-   }
+   stopLogWorkers();
 
-   // logpoller auto deleted by Qt when 'this' dies
+   // logpoller, logserver, logpipe auto deleted by Qt when 'this' dies
 
    // cleanup temp-log
    if ( QFile::exists( tmplogFname ) ) {
@@ -242,6 +311,9 @@ bool ToolObject::start( VGTOOL::ToolProcessId procId,
    case VGTOOL::PROC_PARSE_LOG:
       ok = parseLogFile();
       break;
+   case VGTOOL::PROC_FOLLOW_LOG:
+      ok = followLogFile();
+      break;
    default:
       vk_assert_never_reached();
    }
@@ -255,6 +327,9 @@ bool ToolObject::start( VGTOOL::ToolProcessId procId,
   Called by valkyrie->runTool() if cmdline --view-log=<file> specified.
   ToolView::openLogFile() if gui parse-log selected.
   If 'checked' == true, file perms/format has already been checked
+   - the log is loaded by a worker, in the parser thread:
+     vgLogProgress() keeps the status bar up to date, and
+     stopProcess() stops it, keeping what's been loaded so far.
 */
 bool ToolObject::parseLogFile()
 {
@@ -282,29 +357,76 @@ bool ToolObject::parseLogFile()
       return false;
    }
    // log file ok
-   log_file = ret_file;
-   vkCfgProj->setValue( "valkyrie/view-log", log_file );
+   viewLogFname = ret_file;
+   vkCfgProj->setValue( "valkyrie/view-log", viewLogFname );
+
+   // a compressed log can only be streamed, so can't be read lazily
+   bool compressed = VgLogInput::isCompressedFile( viewLogFname );
+   bool lazy = !compressed &&
+               QFileInfo( viewLogFname ).size() >= VG_LOG_LAZY_MIN;
+   int maxErrors = vkCfgProj->value( "valkyrie/load-errors" ).toInt();
+
+   // Could be a very large file: load it in the background, so we
+   // can show how it's going, and the user can Stop it.
+   //  - paged, if [VALKYRIE::LOAD_ERRORS] is set (it's off by default)
+   //    and it has more than that many errors: just the first lot,
+   //    plus the summary at the end, the rest read in on demand.
+   //    This takes precedence over the rest.
+   //  - lazy mode, for a huge log: keeps memory flat, however many
+   //    errors it has. Errors keep just their summary & byte range
+   //    in the log, re-reading the details from the log when needed.
+   //  - otherwise from its index, or mmap'd & decoded on all cores.
+   vgworker = startLogWorker( viewLogFname, toolView->createVgLogView() );
+   QMetaObject::invokeMethod( vgworker, "load", Qt::QueuedConnection,
+                              Q_ARG( bool, lazy ),
+                              Q_ARG( int, maxErrors ) );
+   return true;
+}
 
-   // Could be a very large file, so at least get ui up-to-date now
-   qApp->processEvents( QEventLoop::AllEvents, 1000/*max msecs*/ );
 
-   // Parse the log
-   VgLogReader vgLogFileReader( toolView->createVgLogView() );
-   bool success = vgLogFileReader.parse( log_file );
+/*!
+  Follow the log file given by [VALKYRIE::VIEW_LOG] entry, as it's
+  written by some other process (e.g. valgrind run by a test harness).
+   - like 'tail -f': reads what's there now, then whatever's appended,
+     until the log's complete.
+   - if the log's truncated or replaced (a new run), starts over
+     with the new log.
+  ToolView::followLogFile() if gui follow-log selected.
+*/
+bool ToolObject::followLogFile()
+{
+   vk_assert( toolView != 0 );
+   // any vg run should have been cleaned up:
+   vk_assert( vgRunSaved );
+   vk_assert( tmplogFname.isEmpty() );
+
+   setProcessId( VGTOOL::PROC_FOLLOW_LOG );
 
-   if ( success ) {
-      statusMsg( "Loaded Logfile '" + log_file + "'" );
-   }
-   else {
-      statusMsg( "Error Parsing Logfile '" + log_file + "'" );
+   QString log_file = vkCfgProj->value( "valkyrie/view-log" ).toString();
 
-      VgLogHandler* hnd = vgLogFileReader.handler();
-      vkError( toolView, "XML Parse Error",
-               "<p>%s</p>", qPrintable( str2html( escapeEntities( hnd->fatalMsg() ) ) ) );
+   // check this is a valid file, and has at least read perms
+   int errval = PARSED_OK;
+   QString ret_file = fileCheck( &errval, log_file, true );
+
+   if ( errval != PARSED_OK ) {
+      vkError( toolView, "File Error", "%s: \n\"%s\"",
+               parseErrString( errval ),
+               qPrintable( escapeEntities( log_file ) ) );
+      setProcessId( VGTOOL::PROC_NONE );
+      return false;
    }
+   // log file ok
+   viewLogFname = ret_file;
+   vkCfgProj->setValue( "valkyrie/view-log", viewLogFname );
 
-   setProcessId( VGTOOL::PROC_NONE );
-   return success;
+   statusMsg( "Following '" + viewLogFname + "'" );
+
+   // an unfinished log is no error here: the worker waits for more.
+   vgworker = startLogWorker( viewLogFname, toolView->createVgLogView() );
+
+   // reads what's there already, then wakes us as the log grows
+   logpoller->start( 250, viewLogFname );
+   return true;
 }
 
 
@@ -332,9 +454,58 @@ bool ToolObject::runValgrind( QStringList flags )
 
 #endif
 
-   // new vgreader - view may have been recreated, so need up-to-date ptr
-   vk_assert( vgreader == 0 );
-   vgreader = new VgLogReader( toolView->createVgLogView() );
+   // how the log gets to us:
+   //  - file:   valgrind writes tmplogFname, which we poll.
+   //  - pipe:   valgrind writes to our pipe, we tee it to tmplogFname.
+   //  - socket: valgrind connects to us, we keep each log in memory
+   //            (a big one's spilled to a temp file).
+   QString transport = vkCfgProj->value( "valkyrie/log-transport" ).toString();
+   bool piped    = ( transport == "pipe" );
+   bool streamed = ( transport == "socket" );
+
+   vk_assert( vglogviews.isEmpty() );
+   QString startErr;
+   if ( streamed ) {
+      // a log worker (and view) per connection, as they're made
+      if ( logserver->listen( VkCfg::tmpDir() + objectName() + "_log" ) ) {
+         args.insert( 1, "--xml-socket=" + logserver->address() );  // after --xml=yes
+      }
+      else {
+         startErr = logserver->errorString();
+      }
+   }
+   else if ( piped ) {
+      if ( logpipe->open( tmplogFname ) ) {
+         args.insert( 1, "--xml-fd=" + QString::number( logpipe->writeFd() ) );
+      }
+      else {
+         startErr = logpipe->errorString();
+      }
+   }
+   else {
+      args.insert( 1, "--xml-file=" + tmplogFname );
+   }
+
+   flags = QStringList( program ) + args;   // as run: for error reports
+
+   if ( !startErr.isEmpty() ) {
+      vgRunSaved = true;  // nothing to save
+      statusMsg( "Error: Failed to start Valgrind" );
+      vkError( toolView, "Process Startup Error",
+               "<p>Failed to set up the Valgrind log:<br>%s</p>",
+               qPrintable( startErr ) );
+      setProcessId( VGTOOL::PROC_NONE );
+      return false;
+   }
+
+   if ( !streamed ) {
+      // new log worker - view may have been recreated, so need up-to-date ptr
+      //  - no logfile to read from a pipe: the data's passed in.
+      vgworker = startLogWorker( piped ? QString() : tmplogFname,
+                                 toolView->createVgLogView() );
+      parsePending = false;
+      parseAgain   = false;
+   }
 
    // start a new process, listening on exit signal to call processDone().
    //  - once Vg is done, we can read the remainder of the log in one last go.
@@ -354,24 +525,37 @@ bool ToolObject::runValgrind( QStringList flags )
    //VK_DEBUG( "Started VgProcess" );
 
    // Make sure Vg started ok before moving further.
-   // Don't bother using QProcess::start():
-   //  1) Vg may have finished already(!)
-   //  2) QXmlSimpleReader won't start on an empty log: seems to need at least "<?x"
-   // So just wait for a while until we find the valgrind output log...
-   int nLoops=0;
-   for (;nLoops < WAIT_VG_START_LOOPS; nLoops++) {
-      if ( QFile::exists( tmplogFname ) ) { break; }
-      usleep( WAIT_VG_START_SLEEP * 1000 );
+   bool vg_ok = false;
+   if ( streamed || piped ) {
+      // Vg sends us the log when it's ready: nothing to wait for.
+      vg_ok = vgproc->waitForStarted( WAIT_VG_START_MAX );
+
+      // Vg has its own copy of the pipe: so we'll see it close.
+      logpipe->closeWriteEnd();
+   }
+   else {
+      // Don't bother using QProcess::start():
+      //  1) Vg may have finished already(!)
+      //  2) VgLogReader can't start until it can open the log
+      // So just wait for a while until we find the valgrind output log...
+      int nLoops=0;
+      for (;nLoops < WAIT_VG_START_LOOPS; nLoops++) {
+         if ( QFile::exists( tmplogFname ) ) { break; }
+         usleep( WAIT_VG_START_SLEEP * 1000 );
+      }
+      vg_ok = (nLoops < WAIT_VG_START_LOOPS);
    }
-   bool vg_ok = (nLoops < WAIT_VG_START_LOOPS);
 
    if ( vg_ok ) {
       //VK_DEBUG( "Started Valgrind" );
       statusMsg( "Started Valgrind ..." );
 
-      // poll log regularly to trigger parsing of the latest data via readVgLog()
+      // watch the log to trigger parsing of the latest data via readVgLog()
+      //  - falls back to polling every 250ms if the log can't be watched.
       // doesn't matter if processDone() or readVgLog() gets called first.
-      logpoller->start( 250 );  // msec
+      if ( !streamed && !piped ) {
+         logpoller->start( 250, tmplogFname );  // msec
+      }
    }
    else {
       vgRunSaved = true;  // nothing to save
@@ -415,11 +599,10 @@ void ToolObject::stopProcess()
    if ( logpoller != 0 && logpoller->isActive() ) {
       logpoller->stop();
    }
+   logserver->close();
+   logpipe->close();
 
-   if ( vgreader != 0 ) {
-      delete vgreader;
-      vgreader = 0;
-   }
+   stopLogWorkers();
 
    switch ( getProcessId() ) {
    case VGTOOL::PROC_VALGRIND: {
@@ -469,8 +652,15 @@ void ToolObject::stopProcess()
    break;
 
    case VGTOOL::PROC_PARSE_LOG: {   // parse log
-      // TODO
-      VK_DEBUG( "TODO: ToolObject::stop(parse log)" );
+      // worker already stopped: the view keeps what it's been given.
+      statusMsg( "Stopped loading '" + viewLogFname + "'" );
+      setProcessId( VGTOOL::PROC_NONE );
+   }
+   break;
+
+   case VGTOOL::PROC_FOLLOW_LOG: {  // follow log
+      // poller & worker already stopped: leave the writer to it.
+      statusMsg( "Stopped following '" + viewLogFname + "'" );
       setProcessId( VGTOOL::PROC_NONE );
    }
    break;
@@ -529,6 +719,7 @@ bool ToolObject::queryDone()
          QFile::remove( tmplogFname );
       }
       tmplogFname = QString();
+      logserver->clear();
       vgRunSaved = true; // nothing more to save
 
       // TODO: clear View
@@ -659,14 +850,18 @@ void ToolObject::processDone( int exitCode, QProcess::ExitStatus exitStatus )
                exitCode );
    }
 
-   // if log reader not active anymore, we're done
-   if ( vgreader == 0 ) {
+   // a streamed log may be in, but not yet picked up.
+   logserver->acceptPending();
+
+   // if log readers not active anymore, we're done
+   if ( vglogviews.isEmpty() ) {
       //VK_DEBUG( "All done." );
       statusMsg( "Finished running Valgrind successfully!" );
+      logserver->close();
       setProcessId( VGTOOL::PROC_NONE );
    }
    else {
-      // For a number of reasons, vgreader may continue on a while after
+      // For a number of reasons, vgworkers may continue on a while after
       // vgproc has gone (e.g. Vg dies, leaving incomplete xml)
       if ( !ok ) {
          // process error: stop reader now.
@@ -690,60 +885,377 @@ void ToolObject::processDone( int exitCode, QProcess::ExitStatus exitStatus )
 
 
 
+/*!
+  Start a log worker, parsing into the given VgLogView
+   - all workers share the one parser thread, started as needed.
+   - no logfile: the log is streamed to the worker (parseStream()).
+*/
+VgLogWorker* ToolObject::startLogWorker( QString logfile, VgLogView* logview )
+{
+   if ( parserThread == 0 ) {
+      parserThread = new QThread( this );
+      parserThread->start();
+   }
+
+   VgLogWorker* worker = new VgLogWorker( logfile );
+   worker->moveToThread( parserThread );
+
+   // worker thread --> gui thread: queued, in order of emission.
+   connect( worker, SIGNAL( logStarted( QString ) ),
+            this,     SLOT( initVgLog( QString ) ) );
+   connect( worker, SIGNAL( recordsReady( VgLogRecordList ) ),
+            this,     SLOT( appendVgLogRecords( VgLogRecordList ) ) );
+   connect( worker, SIGNAL( streamParsed( qint64 ) ),
+            this,     SLOT( vgLogStreamParsed( qint64 ) ) );
+   connect( worker, SIGNAL( parsed( bool, bool, QString ) ),
+            this,     SLOT( vgLogParsed( bool, bool, QString ) ) );
+   connect( worker, SIGNAL( progress( qint64, qint64, int, int ) ),
+            this,     SLOT( vgLogProgress( qint64, qint64, int, int ) ) );
+   connect( worker, SIGNAL( lazyRangesFound( QString, VgLogRanges ) ),
+            this,     SLOT( vgLogLazyRanges( QString, VgLogRanges ) ) );
+   connect( worker, SIGNAL( pagedRestFound( QString, qint64, qint64 ) ),
+            this,     SLOT( vgLogPagedRest( QString, qint64, qint64 ) ) );
+
+   vglogviews.insert( worker, logview );
+   return worker;
+}
+
+
+/*!
+  A log worker is done: the others carry on.
+   - deleted in its own thread, once it's dealt with any calls
+     still queued for it (which it'll ignore).
+*/
+void ToolObject::stopLogWorker( VgLogWorker* worker )
+{
+   vk_assert( vglogviews.contains( worker ) );
+
+   // nothing more for this worker: let its source go again
+   if ( streamPaused.contains( worker ) ) {
+      pauseLogSource( worker, false );
+   }
+   streamQueued.remove( worker );
+
+   worker->abort();
+   vglogviews.remove( worker );
+   connWorkers.remove( connWorkers.key( worker, -1 ) );
+   pendingRecs.remove( worker );
+
+   if ( worker == vgworker ) {
+      vgworker = 0;
+      parsePending = false;
+      parseAgain   = false;
+   }
+
+   worker->deleteLater();
+}
+
+
+/*!
+  Abort & cleanup all the log workers, and the parser thread
+   - workers check the abort flag between records, so this
+     doesn't wait long, even in the middle of a large parse.
+   - any batches still queued for us are ignored (see sender() checks)
+*/
+void ToolObject::stopLogWorkers()
+{
+   if ( parserThread == 0 ) {
+      return;
+   }
+
+   foreach( VgLogWorker* worker, vglogviews.keys() ) {
+      worker->abort();
+   }
+   // the thread deletes any workers already done as it finishes
+   parserThread->quit();
+   parserThread->wait();
+
+   foreach( VgLogWorker* worker, streamPaused ) {
+      pauseLogSource( worker, false );
+   }
+   streamQueued.clear();
+
+   qDeleteAll( vglogviews.keys() );
+   vglogviews.clear();
+   connWorkers.clear();
+   pendingRecs.clear();
+   flushTimer->stop();
+   vgworker = 0;
+
+   delete parserThread;
+   parserThread = 0;
+
+   parsePending = false;
+   parseAgain   = false;
+}
+
+
 /*!
   Read Valgrind XML
-   - Called by logpoller signals only.
+   - Called by logpoller signals, and when re-reading a replaced log.
 
-  Don't worry about Valgrind process state: just read the log.
-   - unless we have a parser error & valgrind is still runnning,
-     in which case, stop the process too, via stopProcess().
+  Don't worry about Valgrind process state: just ask the worker
+  to read the log. If it's still busy with the last lot, ask again
+  once it's done: the logpoller only tells us about new data once.
 */
 void ToolObject::readVgLog()
 {
    vk_assert( toolView != 0 );
-   vk_assert( vgreader != 0 );
+   vk_assert( vgworker != 0 );
    vk_assert( logpoller != 0 );
-   vk_assert( !tmplogFname.isEmpty() );
+   vk_assert( !tmplogFname.isEmpty() ||
+              getProcessId() == VGTOOL::PROC_FOLLOW_LOG );
 
-   // Note: not calling qApp->processEvents(), since parser only
-   // reads in a limited amount in one go anyway.
+   if ( parsePending ) {
+      parseAgain = true;
+      return;
+   }
 
-   // try parsing vg xml log ----------------------------------------
-   bool ok = true;
-   QString errHeader;
+   parsePending = true;
+   parseAgain   = false;
    statusMsg( "Parsing Valgrind XML log..." );
+   QMetaObject::invokeMethod( vgworker, "parse", Qt::QueuedConnection );
+}
 
-   if ( !vgreader->handler()->started() ) {
-      // first time around...
-      //VK_DEBUG( "Start parsing Valgrind XML log" );
 
-      ok = vgreader->parse( tmplogFname, true/*incremental*/ );
+/*!
+  The followed log's been truncated, or replaced by a newer one:
+  what we have is out of date, so start over with a clean view.
+   - only a followed log: valgrind doesn't replace its own logs.
+*/
+void ToolObject::vgLogReplaced()
+{
+   if ( getProcessId() != VGTOOL::PROC_FOLLOW_LOG || vgworker == 0 ) {
+      return;
+   }
 
-      if ( !ok ) {
-         VK_DEBUG( "Error: parse() failed" );
-         errHeader = "XML Parse-Startup Error";
+   VK_DEBUG( "Followed log replaced: re-reading" );
+   statusMsg( "Log replaced: re-reading '" + viewLogFname + "'" );
+
+   stopLogWorker( vgworker );
+   vgworker = startLogWorker( viewLogFname, toolView->createVgLogView() );
+   readVgLog();
+}
+
+
+/*!
+  Worker found the document element: (re)initialise its log
+*/
+void ToolObject::initVgLog( QString doc_tag )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   if ( !vglogviews.value( worker )->init( doc_tag ) ) {
+      finishVgLog( worker, false, "XML Parse-Startup Error",
+                   "Failed log initialisation" );
+   }
+}
+
+
+/*!
+  A batch of top-level records from a worker: shown with any others
+  that come in by the next frame (see flushVgLogRecords()).
+   - a busy log sends many batches a frame: showing each as it came
+     would repaint the tree, and the top status, every time.
+*/
+void ToolObject::appendVgLogRecords( VgLogRecordList recs )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   QList<VgLogRecordList>& batches = pendingRecs[worker];
+   batches.append( recs );
+
+   if ( batches.count() >= VG_LOG_FLUSH_BATCHES ) {
+      flushVgLogRecords( worker );
+   }
+   else if ( !flushTimer->isActive() ) {
+      flushTimer->start();
+   }
+}
+
+
+/*!
+  Time for the next frame: show the records from every worker
+*/
+void ToolObject::flushVgLogRecords()
+{
+   foreach( VgLogWorker* worker, pendingRecs.keys() ) {
+      // a failure stops all the workers
+      if ( pendingRecs.contains( worker ) && !flushVgLogRecords( worker ) ) {
+         break;
       }
    }
-   else {
-      // we've started, so we'll continue...
-      //VK_DEBUG( "Continue parsing Valgrind XML log" );
+}
 
-      ok = vgreader->parseContinue();
 
-      if ( !ok ) {
-         VK_DEBUG( "Error: parseContinue() failed" );
-         errHeader = "XML Parse-Continue Error";
+/*!
+  Show the records waiting from a worker: update the model & view,
+  as one batched update (see VgLogView::beginUpdate()).
+   - unless the logview isn't happy with a record,
+     in which case, stop everything: returns false.
+   - call before anything that expects the view to be up to date
+     with the worker, e.g. once it's done.
+*/
+bool ToolObject::flushVgLogRecords( VgLogWorker* worker )
+{
+   QList<VgLogRecordList> batches = pendingRecs.take( worker );
+   if ( batches.isEmpty() ) {
+      return true;
+   }
+
+   VgLogView* logview = vglogviews.value( worker );
+   logview->beginUpdate();
+
+   foreach( const VgLogRecordList& recs, batches ) {
+      foreach( const VgLogRecord& rec, recs ) {
+         QString errMsg;
+         if ( !logview->appendNode( rec, errMsg ) ) {
+            VK_DEBUG( "Error: appendNode() failed" );
+            logview->endUpdate();
+            finishVgLog( worker, false, "XML Parse Error", errMsg );
+            return false;
+         }
       }
    }
 
-   if ( !vgreader->handler()->fatalMsg().isEmpty() ) {
-      ok = false;
+   logview->endUpdate();
+
+   // ready for more
+   for ( int i = 0; i < batches.count(); i++ ) {
+      worker->recordsTaken();
+   }
+   return true;
+}
+
+
+/*!
+  How a log load's going: bytes done, errors so far, time left
+*/
+void ToolObject::vgLogProgress( qint64 bytesDone, qint64 bytesTotal,
+                                int nErrors, int secsLeft )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   double mbDone  = bytesDone  / ( 1024.0 * 1024.0 );
+   double mbTotal = bytesTotal / ( 1024.0 * 1024.0 );
+   int percent = ( bytesTotal > 0 ) ? ( int )( bytesDone * 100 / bytesTotal ) : 0;
+
+   QString msg = QString( "Loading '%1': %2 of %3 MB (%4%), %5 errors" )
+                 .arg( viewLogFname )
+                 .arg( mbDone, 0, 'f', 1 ).arg( mbTotal, 0, 'f', 1 )
+                 .arg( percent ).arg( nErrors );
+   if ( secsLeft >= 0 ) {
+      msg += QString( ", about %1 s to go" ).arg( secsLeft );
+   }
+   statusMsg( msg );
+}
+
+
+/*!
+  Lazy mode: the worker's found where each error is in the log
+   - before it sends us any records: the view drops the details
+     of each error as it's added, re-reading them from the log.
+*/
+void ToolObject::vgLogLazyRanges( QString logfile, VgLogRanges ranges )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   QSharedPointer<VgLogSource> src( new VgLogSource( logfile ) );
+   vglogviews.value( worker )->setLazySource( src, ranges );
+}
+
+
+/*!
+  Paged load: the worker's sent us the first page of errors, and the
+  rest are at byte range [from, to) of the log
+   - before the summary records: see VgLogView::setPagedSource().
+*/
+void ToolObject::vgLogPagedRest( QString logfile, qint64 from, qint64 to )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
    }
 
-   if ( vgreader->handler()->finished() ) {
+   // the first page goes in first
+   if ( !flushVgLogRecords( worker ) ) {
+      return;
+   }
+
+   QSharedPointer<VgLogSource> src( new VgLogSource( logfile ) );
+   vglogviews.value( worker )->setPagedSource( src, from, to );
+}
+
+
+/*!
+  Worker has read all the log data available (so far)
+*/
+void ToolObject::vgLogParsed( bool ok, bool finished, QString fatalMsg )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !vglogviews.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   // done, one way or another: show all we've had first
+   if ( ( !ok || finished ) && !flushVgLogRecords( worker ) ) {
+      return;
+   }
+
+   if ( worker == vgworker ) {
+      parsePending = false;
+   }
+
+   if ( !ok ) {
+      VK_DEBUG( "Error: parse failed" );
+      finishVgLog( worker, false, "XML Parse Error", fatalMsg );
+   }
+   else if ( finished ) {
       //VK_DEBUG( "Reached end of XML log" );
+      finishVgLog( worker, true, QString(), QString() );
+   }
+   else if ( worker == vgworker && parseAgain ) {
+      readVgLog();
+   }
+}
+
+
+/*!
+  A log's been parsed, for better or worse: cleanup.
+   - once all logs are done, so is the parser.
+   - unless we have a parser error & valgrind is still runnning,
+     in which case, stop the process too, via stopProcess().
+*/
+void ToolObject::finishVgLog( VgLogWorker* worker, bool ok,
+                              QString errHeader, QString errMsg )
+{
+   vk_assert( vglogviews.contains( worker ) );
+   vk_assert( logpoller != 0 );
+
+   if ( ok ) {
+      stopLogWorker( worker );
+      if ( !vglogviews.isEmpty() ) {
+         return;   // other logs still going
+      }
    }
 
+   // cleanup first: no more records once we start popping up dialogs
+   //VK_DEBUG( "Cleaning up logpoller & workers" );
+   logpoller->stop();
+   logpipe->close();
+   stopLogWorkers();
 
    // deal with failures --------------------------------------------
    if ( !ok ) {
@@ -752,43 +1264,36 @@ void ToolObject::readVgLog()
       statusMsg( "Error parsing Valgrind log" );
 
       // Failed: print error & stop everything.
-      QString errMsg = vgreader->handler()->fatalMsg();
       vkError( toolView, errHeader,
                "<p>Failed to parse Valgrind XML output:<br>%s</p>",
                qPrintable( str2html( errMsg ) ) );
    }
 
-   // cleanup -------------------------------------------------------
-   // if parsing failed, or this was a last call, then cleanup
-   if ( !ok || vgreader->handler()->finished() ) {
-      //VK_DEBUG( "Cleaning up logpoller & reader" );
-      vk_assert( vgreader != 0 );
-      vk_assert( logpoller != 0 );
-      vk_assert( logpoller->isActive() );
-
-      // cleanup.
-      logpoller->stop();
-      delete vgreader;
-      vgreader = 0;
-
-      // if vgproc not active anymore, we're done!
-      if ( vgproc == 0 ) {
-         //VK_DEBUG( "All done." );
+   // if vgproc not active anymore, we're done!
+   if ( vgproc == 0 ) {
+      //VK_DEBUG( "All done." );
+      if ( ok && ( getProcessId() == VGTOOL::PROC_PARSE_LOG ||
+                   getProcessId() == VGTOOL::PROC_FOLLOW_LOG ) ) {
+         statusMsg( "Loaded Logfile '" + viewLogFname + "'" );
+      }
+      else if ( ok ) {
          statusMsg( "Finished running Valgrind successfully!" );
-         setProcessId( VGTOOL::PROC_NONE );
       }
-      else {
-         // vgproc is still alive...
-         if ( !ok ) {
-            // parse error: stop vgproc now
-            VK_DEBUG( "VgReader finished with error: stop VgProcess" );
-            stopProcess();
-         }
-
-         // else: parser finished happily. Allow Vg to stop when it's also happy.
-         // TODO: Any reason why Vg might need stopping from this state?
-         //  - if any good reason, then dup checkParserFinished() functionality.
+      logserver->close();
+      setProcessId( VGTOOL::PROC_NONE );
+   }
+   else {
+      // vgproc is still alive...
+      if ( !ok ) {
+         // parse error: stop vgproc now
+         VK_DEBUG( "VgReader finished with error: stop VgProcess" );
+         stopProcess();
       }
+
+      // else: parser finished happily. Allow Vg to stop when it's also happy.
+      //  - a streamed run keeps listening: a child may yet connect.
+      // TODO: Any reason why Vg might need stopping from this state?
+      //  - if any good reason, then dup checkParserFinished() functionality.
    }
 }
 
@@ -798,16 +1303,15 @@ void ToolObject::readVgLog()
   inform the user and remind of option to stopping by hand.
 
   Notes:
-  * vgreader->parse() and parseContinue() call QXmlInputSource::fetchData(),
-    which reads in only a limited amount (512B for Qt3.3.6) from the logfile.
-    Valgrind, after finishing up, can write a whole bunch of data in one go
-    to the logfile, which takes some iterations of parserContinue() to read in.
+  * Valgrind, after finishing up, can write a whole bunch of data in one go
+    to the logfile. The reader drains the lot on the next wakeup, with
+    its read size growing to match, so this should be rare.
   * If Valgrind doesn't write a complete XMLfile (!), this would leave the
     parser with incomplete XML, trying to parse it indefinitely.
 */
 void ToolObject::checkParserFinished()
 {
-   if ( vgproc == 0 && vgreader != 0 ) {
+   if ( vgproc == 0 && !vglogviews.isEmpty() ) {
       VK_DEBUG( "Timeout waiting for parser to finish: Parser _still_ alive." );
       vkInfo( toolView, "Valgrind finished, but log-reader alive",
               "<p>The Valgrind process finished some time ago,<br>"
@@ -823,6 +1327,155 @@ void ToolObject::checkParserFinished()
 }
 
 
+/*!
+  Streamed run: valgrind (or a traced child) has connected with its log
+   - the first log of the run gets a clean view, later ones get
+     their own view alongside.
+*/
+void ToolObject::logConnOpened( int id )
+{
+   if ( getProcessId() != VGTOOL::PROC_VALGRIND ) {
+      return;
+   }
+
+   VgLogView* logview = ( id == 0 ) ? toolView->createVgLogView()
+                                    : toolView->addVgLogView();
+   connWorkers.insert( id, startLogWorker( QString(), logview ) );
+   statusMsg( "Parsing Valgrind XML log..." );
+}
+
+
+/*!
+  Streamed run: more of a log: straight to its worker
+*/
+void ToolObject::logConnData( int id, QByteArray data )
+{
+   VgLogWorker* worker = connWorkers.value( id, 0 );
+   if ( worker == 0 ) {
+      return;   // already done with this log
+   }
+
+   queueLogData( worker, data, false );
+}
+
+
+/*!
+  Streamed run: valgrind closed the connection: that's all of that log
+*/
+void ToolObject::logConnClosed( int id )
+{
+   VgLogWorker* worker = connWorkers.value( id, 0 );
+   if ( worker == 0 ) {
+      return;
+   }
+
+   queueLogData( worker, QByteArray(), true );
+}
+
+
+/*!
+  Piped run: more of the log: straight to the worker
+*/
+void ToolObject::logPipeData( QByteArray data )
+{
+   if ( vgworker == 0 ) {
+      return;
+   }
+
+   queueLogData( vgworker, data, false );
+}
+
+
+/*!
+  Piped run: valgrind (and any children) closed the pipe: that's the lot
+*/
+void ToolObject::logPipeClosed()
+{
+   if ( vgworker == 0 ) {
+      return;
+   }
+
+   queueLogData( vgworker, QByteArray(), true );
+}
+
+
+/*!
+  Streamed data for a worker: queued to its parseStream()
+   - past VG_LOG_QUEUED_MAX not yet parsed, the data's source is held
+     back: the worker's own queue mustn't grow without bound.
+*/
+void ToolObject::queueLogData( VgLogWorker* worker, QByteArray data, bool atEnd )
+{
+   QMetaObject::invokeMethod( worker, "parseStream", Qt::QueuedConnection,
+                              Q_ARG( QByteArray, data ),
+                              Q_ARG( bool, atEnd ) );
+
+   qint64& queued = streamQueued[worker];
+   queued += data.size();
+   if ( queued > VG_LOG_QUEUED_MAX && !streamPaused.contains( worker ) ) {
+      pauseLogSource( worker, true );
+   }
+}
+
+
+/*!
+  A worker's parsed a lot of streamed data: carry on reading its
+  source, once it's caught up enough.
+*/
+void ToolObject::vgLogStreamParsed( qint64 nbytes )
+{
+   VgLogWorker* worker = ( VgLogWorker* )sender();
+   if ( !streamQueued.contains( worker ) ) {
+      return;   // stale: worker already stopped
+   }
+
+   qint64& queued = streamQueued[worker];
+   queued -= nbytes;
+   if ( queued <= VG_LOG_QUEUED_MAX / 2 && streamPaused.contains( worker ) ) {
+      pauseLogSource( worker, false );
+   }
+}
+
+
+/*!
+  Stop (or start again) reading the log a worker's streamed
+*/
+void ToolObject::pauseLogSource( VgLogWorker* worker, bool pause )
+{
+   if ( pause ) {
+      streamPaused.insert( worker );
+   }
+   else {
+      streamPaused.remove( worker );
+   }
+
+   if ( worker == vgworker ) {
+      logpipe->setPaused( pause );
+   }
+   else if ( connWorkers.key( worker, -1 ) != -1 ) {
+      logserver->setPaused( connWorkers.key( worker ), pause );
+   }
+}
+
+
+/*!
+  A streamed log has been written to disk (or not)
+*/
+void ToolObject::vgLogSaved( QString fname, QString errMsg )
+{
+   if ( errMsg.isEmpty() ) {
+      statusMsg( "Saved: " + fname );
+      return;
+   }
+
+   vgRunSaved = false;
+   vkInfo( toolView, "Save Failed",
+           "<p>Failed to save file to '%s':<br>%s</p>",
+           qPrintable( fname ), qPrintable( errMsg ) );
+   statusMsg( "Failed Save: " + fname );
+}
+
+
 /*!
   1. Brings up a Save File Dialog to choose a filename to save to
   2. Gets log to read from
@@ -842,6 +1495,27 @@ bool ToolObject::fileSaveDialog()
       return false;
    }
 
+   // --- Streamed run: the logs are only in memory (or spilled).
+   //  - written out in the background: vgLogSaved() reports back.
+   //  - a log per process: the children's get numbered names.
+   if ( logserver->count() > 0 ) {
+      QFileInfo fi( fname );
+      for ( int id = 0; id < logserver->count(); id++ ) {
+         QString logName = fname;
+         if ( id > 0 ) {
+            logName = fi.path() + "/" + fi.completeBaseName() + "." +
+                      QString::number( id );
+            if ( !fi.suffix().isEmpty() ) {
+               logName += "." + fi.suffix();
+            }
+         }
+         logserver->saveLog( id, logName );
+      }
+      vgRunSaved = true;
+      statusMsg( "Saving: " + fname );
+      return true;
+   }
+
    // --- Get appropriate source log
    // TODO: this is horrible, but good enough for now.
    //  - relies on empty tmplogFname to indicate not a vg run but a loaded log
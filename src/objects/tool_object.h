@@ -31,11 +31,18 @@
 #include "objects/vk_objects.h"
 #include "toolview/toolview.h"
 #include "utils/vglogreader.h"
+#include "utils/vglogworker.h"
+#include "utils/vk_logpipe.h"
 #include "utils/vk_logpoller.h"
+#include "utils/vk_logserver.h"
 
+#include <QHash>
 #include <QList>
 #include <QProcess>
+#include <QSet>
 #include <QStringList>
+#include <QThread>
+#include <QTimer>
 
 
 
@@ -87,14 +94,39 @@ private:
    virtual void statusMsg( QString msg ) = 0;
    bool runValgrind( QStringList vgflags );
    bool parseLogFile();
+   bool followLogFile();
    bool queryFileSave();
+   VgLogWorker* startLogWorker( QString logfile, VgLogView* logview );
+   void stopLogWorker( VgLogWorker* worker );
+   void stopLogWorkers();
+   void finishVgLog( VgLogWorker* worker, bool ok,
+                     QString errHeader, QString errMsg );
+   bool flushVgLogRecords( VgLogWorker* worker );
+   void queueLogData( VgLogWorker* worker, QByteArray data, bool atEnd );
+   void pauseLogSource( VgLogWorker* worker, bool pause );
 
 private slots:
    void stopProcess();
    void killProcess();
    void processDone( int exitCode, QProcess::ExitStatus exitStatus );
    void readVgLog();
+   void vgLogReplaced();
+   void initVgLog( QString doc_tag );
+   void appendVgLogRecords( VgLogRecordList recs );
+   void vgLogStreamParsed( qint64 nbytes );
+   void flushVgLogRecords();
+   void vgLogParsed( bool ok, bool finished, QString fatalMsg );
+   void vgLogProgress( qint64 bytesDone, qint64 bytesTotal,
+                       int nErrors, int secsLeft );
+   void vgLogLazyRanges( QString logfile, VgLogRanges ranges );
+   void vgLogPagedRest( QString logfile, qint64 from, qint64 to );
    void checkParserFinished();
+   void logConnOpened( int id );
+   void logConnData( int id, QByteArray data );
+   void logConnClosed( int id );
+   void logPipeData( QByteArray data );
+   void logPipeClosed();
+   void vgLogSaved( QString fname, QString errMsg );
 
 public slots:
    bool fileSaveDialog();
@@ -109,6 +141,7 @@ protected:
 
 private:
    QString    tmplogFname;
+   QString    viewLogFname; // log being loaded or followed
    bool       vgRunSaved;
 
    // tools need to add own processId's: classic enum extend problem :-(
@@ -116,9 +149,23 @@ private:
 
    VGTOOL::ToolID toolId;  // which tool are we.
 
-   VgLogReader* vgreader;
+   // one worker per log being read, all in the one parser thread
+   QHash<VgLogWorker*, VgLogView*> vglogviews;  // views owned by toolView
+   QHash<int, VgLogWorker*> connWorkers;  // by logserver connection id
+   // record batches taken from the workers, but not yet shown
+   QHash<VgLogWorker*, QList<VgLogRecordList> > pendingRecs;
+   // streamed data sent to the workers, but not yet parsed
+   QHash<VgLogWorker*, qint64> streamQueued;
+   QSet<VgLogWorker*> streamPaused;   // their log source held back
+   QTimer*      flushTimer;   // shows pendingRecs, a frame at a time
+   VgLogWorker* vgworker;     // reading tmplogFname, or logpipe
+   QThread*     parserThread;
+   bool         parsePending; // vgworker busy with a parse() call
+   bool         parseAgain;   // log updated during that parse() call
    QProcess*    vgproc;
    VkLogPoller* logpoller;
+   VkLogServer* logserver;    // valgrind's --xml-socket connects here
+   VkLogPipe*   logpipe;      // valgrind's --xml-fd writes here
 };
 
 
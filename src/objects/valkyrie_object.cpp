@@ -357,6 +357,66 @@ void Valkyrie::setupOptions()
       VkOPT::NOT_POPT,
       VkOPT::WDG_LEDIT
    );
+
+   options.addOpt(
+      VALKYRIE::LOG_TRANSPORT,
+      this->objectName(),
+      "log-transport",
+      '\0',
+      "",
+      "file|socket|pipe",
+      "file",
+      "Log transport:",
+      "",
+      "",
+      VkOPT::NOT_POPT,
+      VkOPT::WDG_COMBO
+   );
+
+   options.addOpt(
+      VALKYRIE::LOAD_ERRORS,
+      this->objectName(),
+      "load-errors",
+      '\0',
+      "",
+      "0|1000000",
+      "0",
+      "Saved logs: Errors loaded at a time (0: all):",
+      "",
+      "",
+      VkOPT::NOT_POPT,
+      VkOPT::WDG_SPINBOX
+   );
+
+   options.addOpt(
+      VALKYRIE::GROUP_FRAMES,
+      this->objectName(),
+      "group-frames",
+      '\0',
+      "",
+      "1|50",
+      "4",
+      "Grouped errors: Top stack frames compared:",
+      "",
+      "",
+      VkOPT::NOT_POPT,
+      VkOPT::WDG_SPINBOX
+   );
+
+   options.addOpt(
+      VALKYRIE::ERROR_BUDGET,
+      this->objectName(),
+      "error-budget",
+      '\0',
+      "",
+      "0|65536",
+      "512",
+      "Error details kept in memory (MB, 0: no limit):",
+      "",
+      "",
+      VkOPT::NOT_POPT,
+      VkOPT::WDG_SPINBOX
+   );
 }
 
 
@@ -447,7 +507,11 @@ int Valkyrie::checkOptArg( int optid, QString& argval )
    case VALKYRIE::FNT_GEN_SYS:
    case VALKYRIE::FNT_GEN_USR:
    case VALKYRIE::FNT_TOOL_USR:
-   case VALKYRIE::SRC_LINES: {
+   case VALKYRIE::SRC_LINES:
+   case VALKYRIE::LOG_TRANSPORT:
+   case VALKYRIE::LOAD_ERRORS:
+   case VALKYRIE::GROUP_FRAMES:
+   case VALKYRIE::ERROR_BUDGET: {
          vk_assert( opt->argType == VkOPT::NOT_POPT );
          return errval;
       } break;
@@ -706,11 +770,12 @@ bool Valkyrie::runTool( VGTOOL::ToolID tId, VGTOOL::ToolProcessId procId )
    QStringList vg_flags = getVgFlags( tId );
 
    // update the flags with the necessary options: xml etc.
+   //  - the tool adds the flag for where the xml goes (--xml-file etc),
+   //    as per valkyrie/log-transport.
    QString log_basename = activeTool->objectName() + "_log";
    QString logfile = vk_mkstemp( VkCfg::tmpDir() + log_basename, "xml" );
    vk_assert( !logfile.isEmpty() );
 
-   vg_flags.insert( ++( vg_flags.begin() ), ( "--xml-file=" + logfile ) );
    vg_flags.insert( ++( vg_flags.begin() ), "--xml=yes" );
 
    return activeTool->start( procId, vg_flags, logfile );
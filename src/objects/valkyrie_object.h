@@ -60,6 +60,10 @@ enum vkOptId {
    BIN_FLAGS,     // flags for user-binary
    VIEW_LOG,      // parse and view a valgrind logfile
    DFLT_LOGDIR,   // where to put our temporary logs
+   LOG_TRANSPORT, // how valgrind's log gets to us: file|socket|pipe
+   LOAD_ERRORS,   // errors read from a saved log at a time (0: all)
+   GROUP_FRAMES,  // top stack frames compared when grouping errors
+   ERROR_BUDGET,  // MB of error details kept in memory per log (0: no limit)
 
    NUM_OPTS
 };
@@ -113,6 +113,11 @@ void ValkyrieOptionsPage::setupOptions()
    LeWidget* vgbinLedit = (( LeWidget* )m_itemList[VALKYRIE::VG_EXEC] );
    vgbinLedit->addButton( group1, this, SLOT( getVgExec() ) );
 
+   insertOptionWidget( VALKYRIE::LOG_TRANSPORT, group1, true );  // combobox
+   insertOptionWidget( VALKYRIE::LOAD_ERRORS, group1, true );    // intspin
+   insertOptionWidget( VALKYRIE::GROUP_FRAMES, group1, true );   // intspin
+   insertOptionWidget( VALKYRIE::ERROR_BUDGET, group1, true );   // intspin
+
    // general prefs - layout
    grid->addWidget( editLedit->button(), i, 0 );
    grid->addWidget( editLedit->widget(), i++, 1, 1, 3 );
@@ -124,6 +129,10 @@ void ValkyrieOptionsPage::setupOptions()
    grid->addWidget( dirLogSave->widget(), i++, 1, 1, 3 );
    grid->addWidget( vgbinLedit->button(), i, 0 );
    grid->addWidget( vgbinLedit->widget(), i++, 1, 1, 3 );
+   grid->addLayout( m_itemList[VALKYRIE::LOG_TRANSPORT]->hlayout(), i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::LOAD_ERRORS]->hlayout(), i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::GROUP_FRAMES]->hlayout(), i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::ERROR_BUDGET]->hlayout(), i++, 0, 1, 4 );
 
    grid->addWidget( sep( group1 ), i++, 0, 1, 4 );
 
@@ -180,6 +189,35 @@ void ValkyrieOptionsPage::setupOptions()
                             "Don't save your own files here!" );
    dirLogSave->button()->setToolTip( tip_logdir );
    dirLogSave->widget()->setToolTip( tip_logdir );
+
+   QString tip_transport = tr( "Tip: file: Valgrind writes a log, which Valkyrie reads as it grows.<br>"
+                               "pipe: Valgrind sends its log straight to Valkyrie, "
+                               "which keeps a copy in the temporary directory.<br>"
+                               "socket: as pipe, but each log is kept in memory until saved "
+                               "(any log over 64 MB is moved to the temporary directory), "
+                               "and each traced child process gets a log of its own." );
+   m_itemList[VALKYRIE::LOG_TRANSPORT]->widget()->setToolTip( tip_transport );
+
+   QString tip_load = tr( "Tip: Only this many errors are read when a big log is opened, "
+                          "along with the run's summary.<br>"
+                          "Use 'Load More Errors' to read the next lot.<br>"
+                          "When set, this comes first: such logs are then not loaded "
+                          "from their index, on all cores, or (if huge) lazily.<br>"
+                          "0 (the default) loads all the errors." );
+   m_itemList[VALKYRIE::LOAD_ERRORS]->widget()->setToolTip( tip_load );
+
+   QString tip_group = tr( "Tip: 'Group Errors' puts errors of the same kind together "
+                           "when the top this-many frames of their stacks match.<br>"
+                           "Takes effect from the next log." );
+   m_itemList[VALKYRIE::GROUP_FRAMES]->widget()->setToolTip( tip_group );
+
+   QString tip_budget = tr( "Tip: past this, the details of the oldest errors are moved "
+                            "out to a file in the temporary directory, and read back "
+                            "when needed.<br>"
+                            "Error counts and leak totals are not affected.<br>"
+                            "Some 50 bytes per error always stay in memory: a log "
+                            "with very many errors may go over, as its status says." );
+   m_itemList[VALKYRIE::ERROR_BUDGET]->widget()->setToolTip( tip_budget );
 }
 
 
@@ -0,0 +1,140 @@
+######################################################################
+# Valkyrie qmake include file: the application's sources
+#
+# Shared by src.pro and the benchmarks (bench/): everything but main().
+# Paths are relative to this file, wherever it's included from.
+######################################################################
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/mainwindow.cpp \
+    $$PWD/help/help_about.cpp \
+    $$PWD/help/help_context.cpp \
+    $$PWD/help/help_handbook.cpp \
+    $$PWD/help/help_urls.cpp \
+    $$PWD/objects/helgrind_object.cpp \
+    $$PWD/objects/memcheck_object.cpp \
+    $$PWD/objects/tool_object.cpp \
+    $$PWD/objects/valkyrie_object.cpp \
+    $$PWD/objects/valgrind_object.cpp \
+    $$PWD/objects/vk_objects.cpp \
+    $$PWD/options/helgrind_options_page.cpp \
+    $$PWD/options/memcheck_options_page.cpp \
+    $$PWD/options/suppressions.cpp \
+    $$PWD/options/vk_option.cpp \
+    $$PWD/options/vk_options_dialog.cpp \
+    $$PWD/options/vk_options_page.cpp \
+    $$PWD/options/vk_parse_cmdline.cpp \
+    $$PWD/options/vk_popt.cpp \
+    $$PWD/options/vk_suppressions_dialog.cpp \
+    $$PWD/options/valgrind_options_page.cpp \
+    $$PWD/options/valkyrie_options_page.cpp \
+    $$PWD/options/widgets/opt_base_widget.cpp \
+    $$PWD/options/widgets/opt_cb_widget.cpp \
+    $$PWD/options/widgets/opt_ck_widget.cpp \
+    $$PWD/options/widgets/opt_le_widget.cpp \
+    $$PWD/options/widgets/opt_sp_widget.cpp \
+    $$PWD/options/widgets/opt_lb_widget.cpp \
+    $$PWD/toolview/helgrindview.cpp \
+    $$PWD/toolview/helgrind_logview.cpp \
+    $$PWD/toolview/logviewfilter_mc.cpp \
+    $$PWD/toolview/memcheckview.cpp \
+    $$PWD/toolview/memcheck_logview.cpp \
+    $$PWD/toolview/toolview.cpp \
+    $$PWD/toolview/vggroupmodel.cpp \
+    $$PWD/toolview/vgleakmodel.cpp \
+    $$PWD/toolview/vglogmodel.cpp \
+    $$PWD/toolview/vglogview.cpp \
+    $$PWD/utils/vgerrorgroups.cpp \
+    $$PWD/utils/vgerrorspill.cpp \
+    $$PWD/utils/vgerrorstore.cpp \
+    $$PWD/utils/vglogindex.cpp \
+    $$PWD/utils/vgloginput.cpp \
+    $$PWD/utils/vglogloader.cpp \
+    $$PWD/utils/vglogreader.cpp \
+    $$PWD/utils/vglogrecord.cpp \
+    $$PWD/utils/vglogsource.cpp \
+    $$PWD/utils/vglogtokenizer.cpp \
+    $$PWD/utils/vglogworker.cpp \
+    $$PWD/utils/vk_atoms.cpp \
+    $$PWD/utils/vk_config.cpp \
+    $$PWD/utils/vk_logpipe.cpp \
+    $$PWD/utils/vk_logpoller.cpp \
+    $$PWD/utils/vk_logserver.cpp \
+    $$PWD/utils/vk_messages.cpp \
+    $$PWD/utils/vk_utils.cpp \
+    $$PWD/utils/vknewprojectdialog.cpp
+
+HEADERS += \
+    $$PWD/mainwindow.h \
+    $$PWD/help/help_about.h \
+    $$PWD/help/help_context.h \
+    $$PWD/help/help_handbook.h \
+    $$PWD/help/help_urls.h \
+    $$PWD/objects/helgrind_object.h \
+    $$PWD/objects/memcheck_object.h \
+    $$PWD/objects/tool_object.h \
+    $$PWD/objects/valkyrie_object.h \
+    $$PWD/objects/valgrind_object.h \
+    $$PWD/objects/vk_objects.h \
+    $$PWD/options/helgrind_options_page.h \
+    $$PWD/options/memcheck_options_page.h \
+    $$PWD/options/suppressions.h \
+    $$PWD/options/vk_option.h \
+    $$PWD/options/vk_options_dialog.h \
+    $$PWD/options/vk_options_page.h \
+    $$PWD/options/vk_parse_cmdline.h \
+    $$PWD/options/vk_popt.h \
+    $$PWD/options/valgrind_options_page.h \
+    $$PWD/options/valkyrie_options_page.h \
+    $$PWD/options/vk_suppressions_dialog.h \
+    $$PWD/options/widgets/opt_base_widget.h \
+    $$PWD/options/widgets/opt_cb_widget.h \
+    $$PWD/options/widgets/opt_ck_widget.h \
+    $$PWD/options/widgets/opt_le_widget.h \
+    $$PWD/options/widgets/opt_sp_widget.h \
+    $$PWD/options/widgets/opt_lb_widget.h \
+    $$PWD/toolview/helgrindview.h \
+    $$PWD/toolview/helgrind_logview.h \
+    $$PWD/toolview/logviewfilter_mc.h \
+    $$PWD/toolview/memcheckview.h \
+    $$PWD/toolview/memcheck_logview.h \
+    $$PWD/toolview/toolview.h \
+    $$PWD/toolview/vggroupmodel.h \
+    $$PWD/toolview/vgleakmodel.h \
+    $$PWD/toolview/vglogmodel.h \
+    $$PWD/toolview/vglogview.h \
+    $$PWD/utils/vgerrorgroups.h \
+    $$PWD/utils/vgerrorspill.h \
+    $$PWD/utils/vgerrorstore.h \
+    $$PWD/utils/vglogindex.h \
+    $$PWD/utils/vgloginput.h \
+    $$PWD/utils/vglogloader.h \
+    $$PWD/utils/vglogreader.h \
+    $$PWD/utils/vglogrecord.h \
+    $$PWD/utils/vglogsource.h \
+    $$PWD/utils/vglogtokenizer.h \
+    $$PWD/utils/vglogworker.h \
+    $$PWD/utils/vk_atoms.h \
+    $$PWD/utils/vk_config.h \
+    $$PWD/utils/vk_defines.h \
+    $$PWD/utils/vk_logpipe.h \
+    $$PWD/utils/vk_logpoller.h \
+    $$PWD/utils/vk_logserver.h \
+    $$PWD/utils/vk_messages.h \
+    $$PWD/utils/vk_utils.h \
+    $$PWD/utils/vknewprojectdialog.h
+
+RESOURCES += $$PWD/../icons.qrc
+
+
+######################################################################
+# Compressed logs: gzip always, zstd if available
+LIBS += -lz
+
+CONFIG += link_pkgconfig
+packagesExist( libzstd ) {
+  PKGCONFIG += libzstd
+  DEFINES   += VK_HAVE_ZSTD
+}
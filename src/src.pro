@@ -7,6 +7,7 @@
 
 QT += widgets
 QT += printsupport
+QT += network
 VK_ROOT = ..
 
 include( $${VK_ROOT}/vk_config.pri )
@@ -38,97 +39,9 @@ INSTALLS  = target doc doc_imgs
 
 
 ######################################################################
-SOURCES += \
-    main.cpp \
-    mainwindow.cpp \
-    help/help_about.cpp \
-    help/help_context.cpp \
-    help/help_handbook.cpp \
-    help/help_urls.cpp \
-    objects/helgrind_object.cpp \
-    objects/memcheck_object.cpp \
-    objects/tool_object.cpp \
-    objects/valkyrie_object.cpp \
-    objects/valgrind_object.cpp \
-    objects/vk_objects.cpp \
-    options/helgrind_options_page.cpp \
-    options/memcheck_options_page.cpp \
-    options/suppressions.cpp \
-    options/vk_option.cpp \
-    options/vk_options_dialog.cpp \
-    options/vk_options_page.cpp \
-    options/vk_parse_cmdline.cpp \
-    options/vk_popt.cpp \
-    options/vk_suppressions_dialog.cpp \
-    options/valgrind_options_page.cpp \
-    options/valkyrie_options_page.cpp \
-    options/widgets/opt_base_widget.cpp \
-    options/widgets/opt_cb_widget.cpp \
-    options/widgets/opt_ck_widget.cpp \
-    options/widgets/opt_le_widget.cpp \
-    options/widgets/opt_sp_widget.cpp \
-    options/widgets/opt_lb_widget.cpp \
-    toolview/helgrindview.cpp \
-    toolview/helgrind_logview.cpp \
-    toolview/logviewfilter_mc.cpp \
-    toolview/memcheckview.cpp \
-    toolview/memcheck_logview.cpp \
-    toolview/toolview.cpp \
-    toolview/vglogview.cpp \
-    utils/vglogreader.cpp \
-    utils/vk_config.cpp \
-    utils/vk_logpoller.cpp \
-    utils/vk_messages.cpp \
-    utils/vk_utils.cpp \
-    utils/vknewprojectdialog.cpp
-
-HEADERS += \
-    mainwindow.h \
-    help/help_about.h \
-    help/help_context.h \
-    help/help_handbook.h \
-    help/help_urls.h \
-    objects/helgrind_object.h \
-    objects/memcheck_object.h \
-    objects/tool_object.h \
-    objects/valkyrie_object.h \
-    objects/valgrind_object.h \
-    objects/vk_objects.h \
-    options/helgrind_options_page.h \
-    options/memcheck_options_page.h \
-    options/suppressions.h \
-    options/vk_option.h \
-    options/vk_options_dialog.h \
-    options/vk_options_page.h \
-    options/vk_parse_cmdline.h \
-    options/vk_popt.h \
-    options/valgrind_options_page.h \
-    options/valkyrie_options_page.h \
-    options/vk_suppressions_dialog.h \
-    options/widgets/opt_base_widget.h \
-    options/widgets/opt_cb_widget.h \
-    options/widgets/opt_ck_widget.h \
-    options/widgets/opt_le_widget.h \
-    options/widgets/opt_sp_widget.h \
-    options/widgets/opt_lb_widget.h \
-    toolview/helgrindview.h \
-    toolview/helgrind_logview.h \
-    toolview/logviewfilter_mc.h \
-    toolview/memcheckview.h \
-    toolview/memcheck_logview.h \
-    toolview/toolview.h \
-    toolview/vglogview.h \
-    utils/vglogreader.h \
-    utils/vk_config.h \
-    utils/vk_defines.h \
-    utils/vk_logpoller.h \
-    utils/vk_messages.h \
-    utils/vk_utils.h \
-    utils/vknewprojectdialog.h
-
-RESOURCES += $${VK_ROOT}/icons.qrc
-
+SOURCES += main.cpp
 
+include( src.pri )
 
 
 ######################################################################
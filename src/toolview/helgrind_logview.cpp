@@ -1,6 +1,6 @@
 /****************************************************************************
 ** HelgrindLogView implementation
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -45,26 +45,34 @@ ErrorItem::AcronymMap ErrorItemHG::acnymMap = setupErrAcronymMap();
 /*!
   ErrorItem for Helgrind
 */
-ErrorItemHG::ErrorItemHG( VgOutputItem* parent, QTreeWidgetItem* after,
-                          QDomElement err )
+ErrorItemHG::ErrorItemHG( VgOutputItem* parent, VgOutputItem* after,
+                          const VgError& err )
       : ErrorItem( parent, after, err, acnymMap )
 {
 }
 
+/*!
+  details re-read from the log (lazy mode): as done by the logview
+*/
+void ErrorItemHG::fixupError( VgError& err )
+{
+   HelgrindLogView::updateThreadId( err );
+}
+
 
 
 // ============================================================
 /*!
   TopStatus: first item in listview
 */
-TopStatusItemHG::TopStatusItemHG( QTreeWidget* parent, QDomElement exe,
-                                  QDomElement status, QString _protocol )
-   : TopStatusItem( parent, exe, status, "", _protocol )
+TopStatusItemHG::TopStatusItemHG( VgLogModel* model, QString exe,
+                                  const VgStatus& status, QString _protocol )
+   : TopStatusItem( model, exe, status, "", _protocol )
 {
 }
 
 
-void TopStatusItemHG::updateToolStatus( QDomElement /*err*/ )
+void TopStatusItemHG::updateToolStatus( const VgError& /*err*/ )
 {
    // Update general error count
    // Note: this may be _way_ off, 'cos we don't see repeated errors
@@ -86,19 +94,22 @@ void TopStatusItemHG::updateToolStatus( QDomElement /*err*/ )
   TODO: put that in a tooltip, or sthng.
 */
 AnnounceThreadItem::AnnounceThreadItem( VgOutputItem* parent,
-                                        QTreeWidgetItem* after,
-                                        QDomElement err )
-: VgOutputItem( parent, after, err )
+                                        VgOutputItem* after,
+                                        const VgError& err )
+: VgOutputItem( parent, after, VG_ELEM::ANNOUNCETHREAD ), announce( err )
 {
-
-   QDomElement hthreadid = elem.firstChildElement();
+   QString hthreadid_str;
+   foreach( const VgErrorPart& part, announce.parts ) {
+      if ( part.type == VG_ELEM::HTHREADID ) {
+         hthreadid_str = part.text;
+         break;
+      }
+   }
 #ifdef DEBUG_ON
-   if ( hthreadid.tagName() != "hthreadid" ) {
-      vkPrintErr( "AnnounceThreadItem::AnnounceThreadItem(): unexpected tagName: %s",
-                  qPrintable( hthreadid.tagName() ) );
+   if ( hthreadid_str.isEmpty() ) {
+      vkPrintErr( "AnnounceThreadItem::AnnounceThreadItem(): missing hthreadid" );
    }
 #endif
-   QString hthreadid_str = hthreadid.text();
    setText( "Thread Announce: #HG_" + hthreadid_str );
 
    isExpandable = true;
@@ -108,27 +119,37 @@ AnnounceThreadItem::AnnounceThreadItem( VgOutputItem* parent,
 void AnnounceThreadItem::setupChildren()
 {
    if ( childCount() == 0 ) {
-      QDomElement e = elem.firstChildElement();
-      e = e.nextSiblingElement();
 #ifdef DEBUG_ON
-      if ( e.tagName() != "stack" ) {
-         vkPrintErr( "AnnounceThreadItem::setupChildren(): unexpected tagName: %s",
-                     qPrintable( e.tagName() ) );
+      if ( announce.stacks.isEmpty() ) {
+         vkPrintErr( "AnnounceThreadItem::setupChildren(): missing stack" );
       }
 #endif
-      VgOutputItem* stack = new StackItem( this, this, e );
+      if ( announce.stacks.isEmpty() ) {
+         return;
+      }
+      VgOutputItem* stack = new StackItem( this, this, announce.stacks.first() );
       stack->openChildren();
    }
 }
 
+QString AnnounceThreadItem::toText()
+{
+   return text() + "\n" + announce.toText();
+}
+
+QString AnnounceThreadItem::toXml()
+{
+   return announce.toXml( elemName( etype ) );
+}
+
 
 
 // ============================================================
 /*!
   HelgrindLogView
 */
-HelgrindLogView::HelgrindLogView( QTreeWidget* view )
-   : VgLogView( view )
+HelgrindLogView::HelgrindLogView( VgLogModel* model )
+   : VgLogView( model )
 {}
 
 HelgrindLogView::~HelgrindLogView()
@@ -143,31 +164,36 @@ QString HelgrindLogView::toolName()
 /*!
   replace "#" with "#HG_", to distinguish from real thread id's.
 */
-void HelgrindLogView::updateThreadId( QDomElement elem )
+void HelgrindLogView::updateThreadId( VgError& err )
 {
-   if ( elem.isNull() ) {
-      return;
-   }
-   QDomNode n = elem.firstChild();
-   if ( !n.isText() ) {
-      VK_DEBUG( "Node not of type QDomText: %s", qPrintable( n.nodeName() ) );
-      return;
+   for ( int i=0; i<err.parts.count(); ++i ) {
+      VgErrorPart& part = err.parts[i];
+      switch ( part.type ) {
+      case VG_ELEM::WHAT:
+      case VG_ELEM::AUXWHAT:
+      case VG_ELEM::XWHAT:
+      case VG_ELEM::XAUXWHAT:
+         part.text.replace( "hread #", "hread #HG_" );
+         break;
+      default:
+         break;
+      }
    }
-   n.setNodeValue( n.nodeValue().replace( "hread #", "hread #HG_" ) );
+   err.what.replace( "hread #", "hread #HG_" );
 }
 
 
 /*!
-  Populate our model (QDomDocument) and the view (QListWidget)
-   - top-level xml elements are pushed to us from the parser
-   - node is reparented to the QDomDocument log
+  Populate our model and the view (QListWidget)
+   - top-level xml elements are pushed to us from the parser,
+     already decoded into typed records
 */
-bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
+bool HelgrindLogView::appendNodeTool( const VgLogRecord& rec, QString& errMsg )
 {
-   switch ( VgOutputItem::elemType( elem.tagName() ) ) {
+   switch ( rec.type ) {
    case VG_ELEM::PROTOCOL_VERSION : {
-      if ( elem.text() != "4" ) {
-         errMsg = "Helgrind tool doesn't support XML protocol version: (" + elem.text() + ")";
+      if ( rec.text != "4" ) {
+         errMsg = "Helgrind tool doesn't support XML protocol version: (" + rec.text + ")";
          vkPrintErr( "%s", qPrintable( "HelgrindLogView::appendNodeTool(): " + errMsg ) );
          return false;
       }
@@ -175,15 +201,12 @@ bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
    }
 
    case VG_ELEM::ERROR: {
-      QDomElement err = elem;
+      VgError err = rec.error;
 
       // update thread id description, to distinguish from real thread id's.
-      updateThreadId( err.firstChildElement( "xwhat" ).firstChildElement( "text" ) );
-      updateThreadId( err.firstChildElement( "xauxwhat" ).firstChildElement( "text" ) );
-      updateThreadId( err.firstChildElement( "what" ) );
-      updateThreadId( err.firstChildElement( "auxwhat" ) );
+      updateThreadId( err );
 
-      lastItem = new ErrorItemHG( topStatus, lastItem, err );
+      lastItem = new ErrorItemHG( errorParent(), lastItem, err );
 
       // update topStatus
       topStatus->updateToolStatus( err );
@@ -191,8 +214,7 @@ bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
    }
 
    case VG_ELEM::ANNOUNCETHREAD: {
-      QDomElement announcethread = elem;
-      lastItem = new AnnounceThreadItem( topStatus, lastItem, announcethread );
+      lastItem = new AnnounceThreadItem( topStatus, lastItem, rec.error );
       break;
    }
 
@@ -204,11 +226,11 @@ bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
 }
 
 
-TopStatusItem* HelgrindLogView::createTopStatus( QTreeWidget* view,
-                                                 QDomElement exe,
-                                                 QDomElement status,
+TopStatusItem* HelgrindLogView::createTopStatus( VgLogModel* model,
+                                                 QString exe,
+                                                 const VgStatus& status,
                                                  QString _protocol )
 {
-   return new TopStatusItemHG( view, exe, status, _protocol );
+   return new TopStatusItemHG( model, exe, status, _protocol );
 }
 
@@ -1,6 +1,6 @@
 /****************************************************************************
 ** MemcheckLogView definition
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -28,17 +28,18 @@
 class HelgrindLogView : public VgLogView
 {
 public:
-   HelgrindLogView( QTreeWidget* );
+   HelgrindLogView( VgLogModel* );
    ~HelgrindLogView();
 
+   static void updateThreadId( VgError& err );
+
 private:
-   void updateThreadId( QDomElement elem );
 
    // Template method functions:
-   TopStatusItem* createTopStatus( QTreeWidget* view, QDomElement exe,
-                                   QDomElement status, QString _protocol );
+   TopStatusItem* createTopStatus( VgLogModel* model, QString exe,
+                                   const VgStatus& status, QString _protocol );
    QString toolName();
-   bool appendNodeTool( QDomElement elem, QString& errMsg );
+   bool appendNodeTool( const VgLogRecord& rec, QString& errMsg );
 };
 
 
@@ -49,8 +50,10 @@ private:
 class ErrorItemHG : public ErrorItem
 {
 public:
-   ErrorItemHG( VgOutputItem* parent, QTreeWidgetItem* after,
-                QDomElement err );
+   ErrorItemHG( VgOutputItem* parent, VgOutputItem* after,
+                const VgError& err );
+protected:
+   void fixupError( VgError& err );
 private:
    static ErrorItem::AcronymMap acnymMap;
 };
@@ -62,10 +65,10 @@ private:
 class TopStatusItemHG : public TopStatusItem
 {
 public:
-   TopStatusItemHG( QTreeWidget* parent, QDomElement exe,
-                    QDomElement status, QString _protocol );
+   TopStatusItemHG( VgLogModel* model, QString exe,
+                    const VgStatus& status, QString _protocol );
 
-   void updateToolStatus( QDomElement err );
+   void updateToolStatus( const VgError& err );
 };
 
 
@@ -74,11 +77,17 @@ public:
 class AnnounceThreadItem : public VgOutputItem
 {
 public:
-   AnnounceThreadItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                       QDomElement err );
+   AnnounceThreadItem( VgOutputItem* parent, VgOutputItem* after,
+                       const VgError& err );
+
+   QString toText();
+   QString toXml();
 
 private:
    void setupChildren(); // called by base class
+
+private:
+   VgError announce;
 };
 
 
@@ -32,6 +32,8 @@
 #include <QToolBar>
 #include <QVBoxLayout>
 
+#include <limits.h>
+
 
 //TODO
 //This is all simply a duplicate of MemcheckView.
@@ -61,7 +63,7 @@
     Constructs a HelgrindView with the given \a parent.
 */
 HelgrindView::HelgrindView( QWidget* parent )
-   : ToolView( parent, VGTOOL::ID_HELGRIND ), logview(0)
+   : ToolView( parent, VGTOOL::ID_HELGRIND )
 {
    setObjectName( QString::fromUtf8( "HelgrindView" ) );
 
@@ -70,20 +72,29 @@ HelgrindView::HelgrindView( QWidget* parent )
    setupToolBar();
 
    // enable | disable show*Item buttons
-   connect( treeView, SIGNAL( itemSelectionChanged() ),
-            this,       SLOT( updateItemActions() ) );
+   connect( treeView->selectionModel(),
+            SIGNAL( currentChanged( const QModelIndex&, const QModelIndex& ) ),
+            this, SLOT( updateItemActions() ) );
 
    // on collapsing a branch, reset currentItem to branch head.
-   connect( treeView, SIGNAL( itemCollapsed( QTreeWidgetItem* ) ),
-            this,       SLOT( itemCollapsed( QTreeWidgetItem* ) ) );
+   connect( treeView, SIGNAL( collapsed( const QModelIndex& ) ),
+            this,       SLOT( itemCollapsed( const QModelIndex& ) ) );
 
    // load items on-demand
-   connect( treeView, SIGNAL( itemExpanded( QTreeWidgetItem* ) ),
-            this,       SLOT( itemExpanded( QTreeWidgetItem* ) ) );
+   connect( treeView, SIGNAL( expanded( const QModelIndex& ) ),
+            this,       SLOT( itemExpanded( const QModelIndex& ) ) );
+
+   // items opened along with their parent (stacks etc)
+   connect( logModel, SIGNAL( itemOpened( const QModelIndex& ) ),
+            treeView,   SLOT( expand( const QModelIndex& ) ) );
 
    // launch editor with src file loaded
-   connect( treeView, SIGNAL( itemDoubleClicked( QTreeWidgetItem*, int ) ),
-            this,       SLOT( launchEditor( QTreeWidgetItem* ) ) );
+   connect( treeView, SIGNAL( doubleClicked( const QModelIndex& ) ),
+            this,       SLOT( launchEditor( const QModelIndex& ) ) );
+
+   // grouped errors: show the error in the log
+   connect( groupView, SIGNAL( doubleClicked( const QModelIndex& ) ),
+            this,       SLOT( showGroupedError( const QModelIndex& ) ) );
 }
 
 
@@ -92,10 +103,8 @@ HelgrindView::HelgrindView( QWidget* parent )
 */
 HelgrindView::~HelgrindView()
 {
-   if ( logview != 0 ) {
-      delete logview;
-      logview = 0;
-   }
+   qDeleteAll( logviews );
+   logviews.clear();
 }
 
 
@@ -103,17 +112,32 @@ HelgrindView::~HelgrindView()
    Provide the tool-object access to our model, to fill it,
    but keep ownership ourselves: we know when we're done with it.
 
-   Creates a clean log on each call.
+   Creates a clean log on each call: any logs we had go, items and all
+   (e.g. a followed log that's been replaced).
    This should be called by the tool-object just before it intends
    to fill the log.
 */
 VgLogView* HelgrindView::createVgLogView()
 {
-   if ( logview != 0 ) {
-      delete logview;
-   }
+   qDeleteAll( logviews );
+   logviews.clear();
+   groupModel->clear();   // before the items it points to go
+   logModel->clear();
+
+   return addVgLogView();
+}
 
-   logview = new HelgrindLogView( treeView );
+
+/*!
+   Another log, alongside those we have: e.g. from a traced child process.
+    - each has its own top-level status item in the tree.
+*/
+VgLogView* HelgrindView::addVgLogView()
+{
+   VgLogView* logview = new HelgrindLogView( logModel );
+   logview->setGroupModel( groupModel );
+
+   logviews.append( logview );
    return logview;
 }
 
@@ -127,11 +151,25 @@ void HelgrindView::setupLayout()
    QVBoxLayout* vLayout = new QVBoxLayout( this );
    vLayout->setMargin(0);
 
-   treeView = new QTreeWidget( this );
+   // rows are all one line high: only those on screen are ever laid out
+   logModel = new VgLogModel( this );
+   treeView = new QTreeView( this );
    treeView->setObjectName( QString::fromUtf8( "treeview_Helgrind" ) );
    treeView->setHeaderHidden( true );
    treeView->setRootIsDecorated( false );
+   treeView->setUniformRowHeights( true );
+   treeView->setModel( logModel );
+
+   // the same errors, grouped by where they happen: see groupErrors()
+   groupModel = new VgGroupModel( this );
+   groupView = new QTreeView( this );
+   groupView->setObjectName( QString::fromUtf8( "groupview_Helgrind" ) );
+   groupView->setHeaderHidden( true );
+   groupView->setUniformRowHeights( true );
+   groupView->setModel( groupModel );
+   groupView->hide();
    vLayout->addWidget( treeView );
+   vLayout->addWidget( groupView );
 }
 
 
@@ -176,6 +214,22 @@ void HelgrindView::setupActions()
    act_OpenLog->setIconVisibleInMenu( true );
    connect( act_OpenLog, SIGNAL( triggered() ), this, SLOT( openLogFile() ) );
 
+   act_FollowLog = new QAction( this );
+   act_FollowLog->setObjectName( QString::fromUtf8( "act_FollowLog" ) );
+   act_FollowLog->setIcon( icon_openlog );
+   act_FollowLog->setIconVisibleInMenu( true );
+   connect( act_FollowLog, SIGNAL( triggered() ), this, SLOT( followLogFile() ) );
+
+   act_LoadMore = new QAction( this );
+   act_LoadMore->setObjectName( QString::fromUtf8( "act_LoadMore" ) );
+   connect( act_LoadMore, SIGNAL( triggered() ), this, SLOT( loadMoreErrors() ) );
+
+   act_GroupErrors = new QAction( this );
+   act_GroupErrors->setObjectName( QString::fromUtf8( "act_GroupErrors" ) );
+   act_GroupErrors->setCheckable( true );
+   act_GroupErrors->setChecked( false );
+   connect( act_GroupErrors, SIGNAL( toggled( bool ) ), this, SLOT( groupErrors( bool ) ) );
+
    act_SaveLog = new QAction( this );
    act_SaveLog->setObjectName( QString::fromUtf8( "act_SaveLog" ) );
    QIcon icon_savelog;
@@ -199,6 +253,12 @@ void HelgrindView::setupActions()
 
    act_OpenLog->setText(    tr( "Open Log" ) );
    act_OpenLog->setToolTip( tr( "Open XML log" ) );
+   act_FollowLog->setText(    tr( "Follow Log" ) );
+   act_FollowLog->setToolTip( tr( "Open an XML log that is still being written, and follow it" ) );
+   act_LoadMore->setText(    tr( "Load More Errors" ) );
+   act_LoadMore->setToolTip( tr( "Read the next lot of errors from the log" ) );
+   act_GroupErrors->setText(    tr( "Group Errors" ) );
+   act_GroupErrors->setToolTip( tr( "Show errors of the same kind, from the same place, together" ) );
    act_SaveLog->setText(    tr( "Save Log" ) );
    act_SaveLog->setToolTip( tr( "Save Valgrind output to an XML log" ) );
 }
@@ -229,6 +289,9 @@ void HelgrindView::setupToolBar()
    toolMenu->addAction( act_OpenClose_all );
    toolMenu->addAction( act_ShowSrcPaths );
    toolMenu->addAction( act_OpenLog );
+   toolMenu->addAction( act_FollowLog );
+   toolMenu->addAction( act_LoadMore );
+   toolMenu->addAction( act_GroupErrors );
    toolMenu->addAction( act_SaveLog );
 }
 
@@ -240,6 +303,7 @@ void HelgrindView::setupToolBar()
 void HelgrindView::setState( bool run )
 {
    act_OpenLog->setEnabled( !run );  // just turn off while running
+   act_FollowLog->setEnabled( !run );
 
    if ( run ) {
       // turn off while running...
@@ -247,19 +311,60 @@ void HelgrindView::setState( bool run )
       act_OpenClose_all->setEnabled( false );
       act_ShowSrcPaths->setEnabled( false );
       act_SaveLog->setEnabled( false );
+      act_LoadMore->setEnabled( false );
 
       this->setCursor( QCursor( Qt::WaitCursor ) );
-      treeView->clear();
+      groupModel->clear();   // before the items it points to go
+      logModel->clear();
    }
    else {
       unsetCursor();
 
       // ... turn on again only if they can be used
-      bool tree_empty = ( treeView->topLevelItemCount() == 0 );
+      bool tree_empty = ( logModel->rowCount() == 0 );
       act_OpenClose_item->setEnabled( false );       // can't enable before item clicked
       act_OpenClose_all->setEnabled( !tree_empty );  // enable only if sthng in tree
       act_ShowSrcPaths->setEnabled( !tree_empty );   // enable only if sthng in tree
       act_SaveLog->setEnabled( !tree_empty );
+
+      bool more_errors = false;
+      foreach( VgLogView* logview, logviews ) {
+         more_errors = more_errors || logview->hasMoreErrors();
+      }
+      act_LoadMore->setEnabled( more_errors );
+   }
+}
+
+
+/*!
+  Paged log: read in the next lot of errors
+   - [VALKYRIE::LOAD_ERRORS] at a time: or all the rest, if 0.
+*/
+void HelgrindView::loadMoreErrors()
+{
+   int maxErrors = vkCfgProj->value( "valkyrie/load-errors" ).toInt();
+   if ( maxErrors <= 0 ) {
+      maxErrors = INT_MAX;
+   }
+
+   QString errMsg;
+   bool more_errors = false;
+   this->setCursor( QCursor( Qt::WaitCursor ) );
+
+   foreach( VgLogView* logview, logviews ) {
+      QString msg;
+      if ( !logview->loadMoreErrors( maxErrors, msg ) && errMsg.isEmpty() ) {
+         errMsg = msg;
+      }
+      more_errors = more_errors || logview->hasMoreErrors();
+   }
+
+   unsetCursor();
+   act_LoadMore->setEnabled( more_errors );
+
+   if ( !errMsg.isEmpty() ) {
+      vkError( this, "Load More Errors", "<p>%s</p>",
+               qPrintable( escapeEntities( errMsg ) ) );
    }
 }
 
@@ -274,11 +379,10 @@ void HelgrindView::setState( bool run )
 
     TODO: what if fails tests: user message?
 */
-void HelgrindView::launchEditor( QTreeWidgetItem* item )
+void HelgrindView::launchEditor( const QModelIndex& index )
 {
-   //vkDebug( "HelgrindView::launchEditor( %s )", qPrintable( item->text( 0 ) ) );
-
-   VgOutputItem* vgItemCurr = (VgOutputItem*)item;
+   VgOutputItem* vgItemCurr = index.isValid() ? logModel->item( index ) : 0;
+   //vkDebug( "HelgrindView::launchEditor( %s )", qPrintable( vgItemCurr->text() ) );
    if ( !vgItemCurr ||
         !vgItemCurr->parent() ) {
       return;
@@ -310,19 +414,15 @@ void HelgrindView::launchEditor( QTreeWidgetItem* item )
    // get path,line for this frame
    FrameItem* frame = (FrameItem*)vgItemCurr->parent();
 
-   QDomNodeList frame_details = frame->getElement().childNodes();
-   vk_assert( frame_details.count() >= 1 );   // only ip guaranteed
-   QDomElement dir    = frame_details.item( 3 ).toElement();
-   QDomElement srcloc = frame_details.item( 4 ).toElement();
-   QDomElement line   = frame_details.item( 5 ).toElement();
+   const VgFrame& frm = frame->getFrame();
 
-   if ( dir.isNull() || srcloc.isNull() ) {
+   if ( frm.dir.isEmpty() || frm.file.isEmpty() ) {
       VK_DEBUG( "HelgrindView::launchEditor(): Not enough path information." );
       vkError( this, "Editor Launch", "<p>Not enough path information.</p>" );
       return;
    }
 
-   QString path( dir.text() + '/' + srcloc.text() );
+   QString path( frm.srcPath() );
    vk_assert( !path.isEmpty() );
 
    // setup args to editor
@@ -330,7 +430,7 @@ void HelgrindView::launchEditor( QTreeWidgetItem* item )
    QString  program = args.at( 0 );
    args = args.mid( 1 );
 
-   if ( line.isNull() ) {
+   if ( frm.line < 0 ) {
       // remove any arg with "%n" in it
       QStringList lineargs = args.filter(".*%n.*");
       QStringList::iterator it = lineargs.begin();
@@ -338,7 +438,7 @@ void HelgrindView::launchEditor( QTreeWidgetItem* item )
          args.removeAll( *it );
       }
    } else {
-      args.replaceInStrings( "%n", line.text() );
+      args.replaceInStrings( "%n", QString::number( frm.line ) );
    }
    args << path;
 
@@ -362,24 +462,22 @@ void HelgrindView::showSrcPath()
 {
    //vkDebug( "HelgrindView::showSrcPath()" );
 
-   if ( treeView->topLevelItemCount() == 0 ) {
+   VgOutputItem* vgItemTop = logModel->rootItem()->firstChild();
+   if ( !vgItemTop ) {
       return;
    }
-   VgOutputItem* vgItemTop = (VgOutputItem*)treeView->topLevelItem( 0 );
 
-   VgOutputItem* vgItem = (VgOutputItem*)treeView->currentItem();
-   if ( !vgItem ) {
-      vgItem = vgItemTop;
-   }
+   QModelIndex current = treeView->currentIndex();
+   VgOutputItem* vgItem = current.isValid() ? logModel->item( current ) : vgItemTop;
 
    // if we're top dog, show full src path for all _open_ error items.
    // Note: not supporting UNshow for all. Don't think worth the effort.
    if ( vgItem == vgItemTop ) {
       for ( int i=0; i<vgItem->childCount(); ++i ) {
-         VgOutputItem* child = (VgOutputItem*)vgItem->child( i );
-         if ( child->isExpanded() &&
-              child->elemType() == VG_ELEM::ERROR ) {
-            ErrorItem* error = (ErrorItem*)vgItem->child( i );
+         VgOutputItem* child = vgItem->child( i );
+         if ( child->elemType() == VG_ELEM::ERROR &&
+              treeView->isExpanded( logModel->indexOf( child ) ) ) {
+            ErrorItem* error = (ErrorItem*)child;
             error->showFullSrcPath( true );
          }
       }
@@ -397,8 +495,8 @@ void HelgrindView::showSrcPath()
 
    // if we're an _open_ ERROR-item, then show src path for this item only.
    // Toggling of show-full-src-paths supported for this case.
-   if ( vgItem->isExpanded() &&
-        vgItem->elemType() == VG_ELEM::ERROR ) {
+   if ( vgItem->elemType() == VG_ELEM::ERROR &&
+        treeView->isExpanded( logModel->indexOf( vgItem ) ) ) {
       ErrorItem* error = (ErrorItem*)vgItem;
       error->showFullSrcPath( !error->isFullSrcPathShown() );
    }
@@ -413,12 +511,12 @@ void HelgrindView::opencloseAllItems()
 {
    //vkDebug( "HelgrindView::opencloseAllItems()" );
 
-   if ( treeView->topLevelItemCount() == 0 ) {
+   if ( logModel->rowCount() == 0 ) {
       // empty tree.
       return;
    }
 
-   VgOutputItem* vgItemTop = (VgOutputItem*)treeView->topLevelItem( 0 );
+   VgOutputItem* vgItemTop = logModel->rootItem()->firstChild();
    if ( !vgItemTop || vgItemTop->childCount() == 0 ) {
       vkPrintErr( "Error: listview not populated. This shouldn't happen!" );
       return;
@@ -429,7 +527,7 @@ void HelgrindView::opencloseAllItems()
    bool anItemIsOpen = false;
    int idxItemERR = -1;
    for ( int i=0; i<vgItemTop->childCount(); ++i ) {
-      VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
+      VgOutputItem* child = vgItemTop->child( i );
 
       // find the first ERROR element
       if ( (idxItemERR == -1) &&
@@ -443,7 +541,7 @@ void HelgrindView::opencloseAllItems()
          if ( child->elemType() == VG_ELEM::SUPPCOUNTS ) {
             continue;
          }
-         if ( child->isExpanded() ) {
+         if ( treeView->isExpanded( logModel->indexOf( child ) ) ) {
             anItemIsOpen = true;
             break;
          }
@@ -457,13 +555,17 @@ void HelgrindView::opencloseAllItems()
 
    // iterate over the same items, opening or collapsing all.
    // note: only opening/collapsing first-child level, not all levels.
+   //  - only those that change: each is a search of the view's rows.
    for ( int i=idxItemERR; i<vgItemTop->childCount(); ++i ) {
-      VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
+      VgOutputItem* child = vgItemTop->child( i );
       // skip suppressions
       if ( child->elemType() == VG_ELEM::SUPPCOUNTS ) {
          continue;
       }
-      child->setExpanded( !anItemIsOpen );
+      QModelIndex idx = logModel->indexOf( child );
+      if ( treeView->isExpanded( idx ) == anItemIsOpen ) {
+         treeView->setExpanded( idx, !anItemIsOpen );
+      }
    }
 
 
@@ -473,7 +575,7 @@ void HelgrindView::opencloseAllItems()
       // - giving currentItem == last branch to be collapsed.
       // Too much work to figure out if we were previously
       // inside a now collapsed branch. Just reset to top.
-      treeView->setCurrentItem( vgItemTop );
+      treeView->setCurrentIndex( logModel->indexOf( vgItemTop ) );
    }
 }
 
@@ -488,41 +590,38 @@ void HelgrindView::opencloseOneItem()
 {
    //vkDebug( "HelgrindView::opencloseOneItem():" );
 
-   QTreeWidgetItem* item = treeView->currentItem();
-   if ( item == 0 )
+   QModelIndex index = treeView->currentIndex();
+   if ( !index.isValid() )
       return;
 
-   item->setExpanded( !item->isExpanded() );
+   treeView->setExpanded( index, !treeView->isExpanded( index ) );
 }
 
 
 /*!
-  void HelgrindView::itemExpanded( QTreeWidgetItem* item )
+  void HelgrindView::itemExpanded( const QModelIndex& index )
 
-  Supports on-demand loading our VgOutputItems from our underlying model (VgElements)
-  Have to catch the treeView::itemExpanded() signal and pass it on to our
-  implementation of QTreeWidgetItem (VgOutputItem).
-
-  This should be in VgOutputItem class, but QTreeWidgetItem no longer
-  provides a virtual setExpanded() method :-(
+  Supports on-demand loading our VgOutputItems from their record data.
+  The view fetches the children of an item it opens (see
+  VgLogModel::fetchMore()): this is for any way it can open one without.
 */
-void HelgrindView::itemExpanded( QTreeWidgetItem* item )
+void HelgrindView::itemExpanded( const QModelIndex& index )
 {
    //vkDebug( "HelgrindView::itemExpanded():" );
-   ((VgOutputItem*)item)->openChildren();
+   logModel->item( index )->fetchChildren();
 }
 
 
 /*!
   if we collapse a branch, set current item to branch head
 */
-void HelgrindView::itemCollapsed( QTreeWidgetItem* item )
+void HelgrindView::itemCollapsed( const QModelIndex& index )
 {
    //vkDebug( "HelgrindView::itemCollapsed():" );
 
-   if ( item != treeView->currentItem() ) {
+   if ( index != treeView->currentIndex() ) {
       // this should be a slot. grr!
-      treeView->setCurrentItem( item );
+      treeView->setCurrentIndex( index );
    }
 }
 
@@ -534,13 +633,42 @@ void HelgrindView::updateItemActions()
 {
    //vkDebug( "HelgrindView::updateItemActions():" );
 
-   QTreeWidgetItem* item = treeView->currentItem();
-   if ( !item ) {
+   QModelIndex index = treeView->currentIndex();
+   if ( !index.isValid() ) {
       act_OpenClose_item->setEnabled( false );
    }
    else {
       // item ok: contract / expand it
-      VgOutputItem* vgItem = (VgOutputItem*)item;
+      VgOutputItem* vgItem = logModel->item( index );
       act_OpenClose_item->setEnabled( vgItem->getIsExpandable() );
    }
 }
+
+
+/*!
+  Grouped view on/off
+   - the groups are kept up to date either way: this just swaps views.
+*/
+void HelgrindView::groupErrors( bool on )
+{
+   treeView->setVisible( !on );
+   groupView->setVisible( on );
+}
+
+
+/*!
+  Grouped view: show the (double-clicked) error in the log
+*/
+void HelgrindView::showGroupedError( const QModelIndex& index )
+{
+   ErrorItem* item = groupModel->errorItem( index );
+   if ( !item ) {
+      return;
+   }
+
+   act_GroupErrors->setChecked( false );
+
+   QModelIndex idx = logModel->indexOf( item );
+   treeView->setCurrentIndex( idx );
+   treeView->scrollTo( idx );
+}
@@ -22,10 +22,11 @@
 #define __HELGRINDVIEW_H
 
 #include "toolview/toolview.h"
+#include "toolview/vggroupmodel.h"
 #include "toolview/vglogview.h"
 
 #include <QMenu>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QToolButton>
 
 
@@ -38,6 +39,7 @@ public:
    ~HelgrindView();
 
    VgLogView* createVgLogView();
+   VgLogView* addVgLogView();
 
 public slots:
    virtual void setState( bool run );
@@ -51,20 +53,29 @@ private slots:
    void opencloseAllItems();
    void opencloseOneItem();
    void showSrcPath();
-   void launchEditor( QTreeWidgetItem* item );
-   void itemExpanded( QTreeWidgetItem* item );
-   void itemCollapsed( QTreeWidgetItem* item );
+   void launchEditor( const QModelIndex& index );
+   void loadMoreErrors();
+   void itemExpanded( const QModelIndex& index );
+   void itemCollapsed( const QModelIndex& index );
    void updateItemActions();
+   void groupErrors( bool on );
+   void showGroupedError( const QModelIndex& index );
 
 private:
    QAction* act_OpenClose_all;
    QAction* act_OpenClose_item;
    QAction* act_ShowSrcPaths;
    QAction* act_OpenLog;
+   QAction* act_FollowLog;
+   QAction* act_LoadMore;
+   QAction* act_GroupErrors;
    QAction* act_SaveLog;
 
-   QTreeWidget* treeView;
-   VgLogView*   logview;
+   QTreeView* treeView;
+   VgLogModel* logModel;    // all our logs
+   QTreeView* groupView;
+   VgGroupModel* groupModel;  // the same errors, grouped
+   QList<VgLogView*> logviews;
 };
 
 #endif // __HELGRINDVIEW_H
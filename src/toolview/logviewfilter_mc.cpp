@@ -28,8 +28,10 @@
 
 
 
-LogViewFilterMC::LogViewFilterMC( QWidget *parent, QTreeWidget* view )
-   : QWidget(parent), m_view( view )
+LogViewFilterMC::LogViewFilterMC( QWidget *parent, QTreeView* view,
+                                  VgLogModel* model )
+   : QWidget(parent), m_view( view ), m_model( model ),
+     m_atomCmpFun( FUN_EQL )
 {
    setObjectName( QString::fromUtf8( "LogViewFilterMC" ) );
 
@@ -198,24 +200,25 @@ void LogViewFilterMC::updateView()
       return;
    }
 
-   VgOutputItem* vgItemTop = (VgOutputItem*)m_view->topLevelItem( 0 );
+   VgOutputItem* vgItemTop = m_model->rootItem()->firstChild();
    if ( vgItemTop == NULL ) {
 //      vkDebug( "No items in treeview." );
       return;
    }
 
+   // the whole log in one scan of its error store
+   //  - show all items if filter is inactive
+   VgErrorStore* store = ((TopStatusItem*)vgItemTop)->errorStore();
+   QBitArray shown;
+   bool showAll = this->isHidden() || !matchRows( store, 0, -1, shown );
+
    // iterate over all the first-child items
    for ( int i=0; i<vgItemTop->childCount(); ++i ) {
-      VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
+      VgOutputItem* child = vgItemTop->child( i );
 
       if ( child->elemType() == VG_ELEM::ERROR ) {
-
-         if ( this->isHidden() ) {     // show all items if filter is inactive
-            child->setHidden( false );
-         }
-         else {                        // filter active: go filter!
-            showHideItem( child );
-         }
+         int row = ((ErrorItem*)child)->storeRow();
+         setItemHidden( child, !showAll && row >= 0 && !shown.testBit( row ) );
       }
    }
 }
@@ -223,7 +226,7 @@ void LogViewFilterMC::updateView()
 
 void LogViewFilterMC::showHideItem( VgOutputItem* item )
 {
-//   vkDebug( "LogViewFilterMC::showHideItem: %s", qPrintable( item->text(0) ) );
+//   vkDebug( "LogViewFilterMC::showHideItem: %s", qPrintable( item->text() ) );
 
    // sanity checks
    if ( !item ) {
@@ -236,77 +239,31 @@ void LogViewFilterMC::showHideItem( VgOutputItem* item )
       return;
    }
 
-   // get filter from widgets
-   // - first get and test the filter value: if empty -> no filter.
-   QString str_flt;
-   if ( filterWidgStack->currentIndex() == CMP_KND ) { // => combobox
-      QComboBox* combo = (QComboBox*)filterWidgStack->currentWidget();
-      str_flt = combo->itemData( combo->currentIndex() ).toString();
+   // just this error's row of the store
+   //  - a positive match means the error item remains.
+   //  - a negative match means the error item is hidden.
+   ErrorItem* err = (ErrorItem*)item;
+   int row = err->storeRow();
+   QBitArray shown;
+   if ( row < 0 || !matchRows( err->getStore(), row, row + 1, shown ) ) {
+      setItemHidden( item, false );
    }
-   else {                                           // => lineedit
-      QLineEdit* le = (QLineEdit*)filterWidgStack->currentWidget();
-      str_flt = le->text();
+   else {
+      setItemHidden( item, !shown.testBit( row ) );
    }
+}
 
-   if ( str_flt.isEmpty() ) {
-//      vkDebug( "Filter value empty -> empty filter" );
-      item->setHidden( false );
-   }
-   else {
-      QStringList xml_list;
-
-      // get the compare function
-      QComboBox* comboCmpFun = (QComboBox*)cmpWidgStack->currentWidget();
-      int idx = comboCmpFun->currentIndex();
-      CmpFunType cmpFun = (CmpFunType)comboCmpFun->itemData( idx ).toInt();
-
-      // get the type to compare
-      idx = combo_xmltag->currentIndex();
-      XmlTagType xmltag = (XmlTagType)combo_xmltag->itemData( idx ).toInt();
-      CmpType cmp_type = map_xmltag_cmptype[ xmltag ];
-
-      // get the appropriate xml tag, and compare it with our filter
-      //  - a positive match means the error item remains.
-      //  - a negative match means the error item is hidden.
-      bool res_cmp = false;
-      switch ( xmltag ) {
-      case XML_KND: // Kind
-         vk_assert( cmp_type == CMP_KND );
-         res_cmp = xmlCompare( item, "kind", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_LBY: // Leaked Bytes
-         vk_assert( cmp_type == CMP_INT );
-         res_cmp = xmlCompare( item, "leakedbytes", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_LBL: // Leaked Blocks
-         vk_assert( cmp_type == CMP_INT );
-         res_cmp = xmlCompare( item, "leakedblocks", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_OBJ: // Object
-         vk_assert( cmp_type == CMP_STR );
-         res_cmp = xmlCompare( item, "obj", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_FUN: // Function
-         vk_assert( cmp_type == CMP_STR );
-         res_cmp = xmlCompare( item, "fn", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_DIR: // Directory
-         vk_assert( cmp_type == CMP_STR );
-         res_cmp = xmlCompare( item, "dir", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_FIL: // File
-         vk_assert( cmp_type == CMP_STR );
-         res_cmp = xmlCompare( item, "file", str_flt, cmpFun, cmp_type );
-         break;
-      case XML_LIN: // Line
-         vk_assert( cmp_type == CMP_INT );
-         res_cmp = xmlCompare( item, "line", str_flt, cmpFun, cmp_type );
-         break;
-      default:
-         vk_assert_never_reached();
-      }
 
-      item->setHidden( !res_cmp );
+/*!
+  Hide / show the item's row
+   - only if that's a change: most rows are never hidden, and the view
+     keeps just the hidden ones.
+*/
+void LogViewFilterMC::setItemHidden( VgOutputItem* item, bool hide )
+{
+   QModelIndex parent = m_model->indexOf( item->parent() );
+   if ( m_view->isRowHidden( item->row(), parent ) != hide ) {
+      m_view->setRowHidden( item->row(), parent, hide );
    }
 }
 
@@ -325,120 +282,144 @@ void LogViewFilterMC::enableFilter( bool enable )
 
 
 
-bool LogViewFilterMC::xmlCompare( VgOutputItem* errItem, const QString& tag,
-                                 const QString& str_flt, CmpFunType cmpFun, CmpType cmp_type )
+/*!
+  Match store rows [from, to) against the filter, as set in the widgets
+   - returns false if there's no filter (empty filter value).
+   - string compares are done once per distinct string (atom),
+     not per frame: see atomMatches().
+*/
+bool LogViewFilterMC::matchRows( VgErrorStore* store, int from, int to,
+                                 QBitArray& res )
 {
-   // extract the relevant XML data
-   // no idea if this is good enough... sometimes maybe better to get first tag only?
-   QStringList list_xml;
-   QDomNodeList nodelist = errItem->getElement().elementsByTagName( tag );
-   for (int i=0; i<nodelist.count(); ++i ) {
-      list_xml << nodelist.at(i).toElement().text();
+   // get filter from widgets
+   // - first get and test the filter value: if empty -> no filter.
+   QString str_flt;
+   if ( filterWidgStack->currentIndex() == CMP_KND ) { // => combobox
+      QComboBox* combo = (QComboBox*)filterWidgStack->currentWidget();
+      str_flt = combo->itemData( combo->currentIndex() ).toString();
+   }
+   else {                                           // => lineedit
+      QLineEdit* le = (QLineEdit*)filterWidgStack->currentWidget();
+      str_flt = le->text();
+   }
+
+   if ( str_flt.isEmpty() ) {
+//      vkDebug( "Filter value empty -> empty filter" );
+      return false;
+   }
+
+   // get the compare function
+   QComboBox* comboCmpFun = (QComboBox*)cmpWidgStack->currentWidget();
+   int idx = comboCmpFun->currentIndex();
+   CmpFunType cmpFun = (CmpFunType)comboCmpFun->itemData( idx ).toInt();
+
+   // get the type to compare
+   idx = combo_xmltag->currentIndex();
+   XmlTagType xmltag = (XmlTagType)combo_xmltag->itemData( idx ).toInt();
+   CmpType cmp_type = map_xmltag_cmptype[ xmltag ];
+
+   // get the appropriate field
+   VG_ELEM::ElemType field = VG_ELEM::NUM_ELEMS;
+   switch ( xmltag ) {
+   case XML_KND: field = VG_ELEM::KIND;         break;  // Kind
+   case XML_LBY: field = VG_ELEM::LEAKEDBYTES;  break;  // Leaked Bytes
+   case XML_LBL: field = VG_ELEM::LEAKEDBLOCKS; break;  // Leaked Blocks
+   case XML_OBJ: field = VG_ELEM::OBJ;          break;  // Object
+   case XML_FUN: field = VG_ELEM::FN;           break;  // Function
+   case XML_DIR: field = VG_ELEM::SRCDIR;       break;  // Directory
+   case XML_FIL: field = VG_ELEM::SRCFILE;      break;  // File
+   case XML_LIN: field = VG_ELEM::LINE;         break;  // Line
+   default:
+      vk_assert_never_reached();
    }
 
    // compare strings or integers?
-   bool res_cmp = false;
-   switch (cmp_type) {
+   switch ( cmp_type ) {
    case CMP_KND:
    case CMP_STR:
-      res_cmp = compare_strings( list_xml, str_flt, cmpFun );
+      res = store->matchAtoms( field, atomMatches( str_flt, cmpFun ), from, to );
       break;
-   case CMP_INT:
-      res_cmp = compare_integers( list_xml, str_flt, cmpFun );
+
+   case CMP_INT: {
+      bool ok = true;
+      qint64 int_flt = str_flt.toLongLong( &ok );
+      if ( !ok ) {
+//         vkDebug( "Failed conversion (str_flt) to integer: '%s'", qPrintable(str_flt) );
+         res = QBitArray( store->count() );   // no match: hide
+         break;
+      }
+
+      VgErrorStore::IntCmp cmp = VgErrorStore::CMP_EQ;
+      switch ( cmpFun ) {
+      case FUN_EQL:   cmp = VgErrorStore::CMP_EQ; break;
+      case FUN_NEQL:  cmp = VgErrorStore::CMP_NE; break;
+      case FUN_LSTHN: cmp = VgErrorStore::CMP_LT; break;
+      case FUN_GRTHN: cmp = VgErrorStore::CMP_GT; break;
+      default:
+         vk_assert_never_reached();
+      }
+      res = store->matchInts( field, cmp, int_flt, from, to );
       break;
+   }
+
    default:
       vk_assert_never_reached();
    }
 
-//   vkDebug( "LogViewFilterMC::xmlCompare: res_cmp: '%d'", res_cmp );
-
-   return res_cmp;
+   return true;
 }
 
 
-
 /*!
-  Compare strings.
-  If _any_ of the strings in lst_xml match str_flt, return true (don't hide)
-  If no match, return false (hide)
-  Any problems, just return true (i.e. don't hide)
+  A byte per atom: does its string match str_flt?
+   - kept while the filter stays the same: atoms interned since are
+     compared as they turn up, so a streaming log costs just those.
 */
-bool LogViewFilterMC::compare_strings( const QStringList& lst_xml,
-                                        const QString& str_flt,
-                                        CmpFunType cmpfuntype )
+const QByteArray& LogViewFilterMC::atomMatches( const QString& str_flt,
+                                                CmpFunType cmpFun )
 {
+   if ( str_flt != m_atomFilter || cmpFun != m_atomCmpFun ) {
+      m_atomMatches.clear();
+      m_atomFilter = str_flt;
+      m_atomCmpFun = cmpFun;
+   }
 
-   bool res_cmp = false;
-   foreach ( QString str_xml, lst_xml ) {
-//      vkDebug( "LogViewFilterMC::compare_strings(%d): '%s'' - '%s'", cmpfuntype, qPrintable( str_xml ), qPrintable( str_flt ) );
-
-      switch ( cmpfuntype ) {
-      case FUN_EQL:   res_cmp = ( str_xml ==          str_flt  ); break;
-      case FUN_NEQL:  res_cmp = ( str_xml !=          str_flt  ); break;
-      case FUN_CONT:  res_cmp = ( str_xml.contains(   str_flt )); break;
-      case FUN_NCONT: res_cmp = (!str_xml.contains(   str_flt )); break;
-      case FUN_STRT:  res_cmp = ( str_xml.startsWith( str_flt )); break;
-      case FUN_NSTRT: res_cmp = (!str_xml.startsWith( str_flt )); break;
-      case FUN_END:   res_cmp = ( str_xml.endsWith(   str_flt )); break;
-      case FUN_NEND:  res_cmp = (!str_xml.endsWith(   str_flt )); break;
-         break;
-      default:
-         vk_assert_never_reached();
+   int nAtoms = VkAtom::tableCount() + 1;   // + the empty atom
+   int old = m_atomMatches.size();
+   if ( old < nAtoms ) {
+      m_atomMatches.resize( nAtoms );
+      for ( int id=old; id<nAtoms; ++id ) {
+         m_atomMatches[id] = ( id != 0 &&
+                               compare_string( VkAtom::fromId( id ).str(),
+                                               str_flt, cmpFun ) ) ? 1 : 0;
       }
-
-      // match found - don't filter out this item!
-      if ( res_cmp )
-         return true;
    }
-
-   // no match: filter out (hide) this item
-   return false;
+   return m_atomMatches;
 }
 
 
 /*!
-  Compare integers.
-  First convert from strings to integers.
-  If _any_ of the strings in lst_xml match str_flt, return true (don't hide)
-  If no match, return false (hide)
-  Any problems, just return true (i.e. don't hide)
+  Compare strings.
+  If str_xml matches str_flt, return true (don't hide)
 */
-bool LogViewFilterMC::compare_integers( const QStringList& lst_xml,
-                                        const QString& str_flt,
-                                        CmpFunType cmpfuntype )
+bool LogViewFilterMC::compare_string( const QString& str_xml,
+                                      const QString& str_flt,
+                                      CmpFunType cmpfuntype )
 {
-   bool res_cmp = false;
-   foreach ( QString str_xml, lst_xml ) {
-
-      bool ok = true;
-      int int_flt = str_flt.toInt( &ok );
-      if ( !ok ) {
-//         vkDebug( "Failed conversion (str_flt) to integer: '%s'", qPrintable(str_flt) );
-         continue;
-      }
-
-      int int_xml = str_xml.toInt( &ok );
-      if ( !ok ) {
-//         vkDebug( "Failed conversion (str_xml) to integer: '%s'", qPrintable(str_xml) );
-         continue;
-      }
-
-//      vkDebug( "LogViewFilterMC::compare_integers: '%d'' - '%d'", int_xml, int_flt );
-
-      switch ( cmpfuntype ) {
-      case FUN_EQL:   res_cmp = (int_xml == int_flt); break;
-      case FUN_NEQL:  res_cmp = (int_xml != int_flt); break;
-      case FUN_LSTHN: res_cmp = (int_xml  < int_flt); break;
-      case FUN_GRTHN: res_cmp = (int_xml  > int_flt); break;
-      default:
-         vk_assert_never_reached();
-      }
+//   vkDebug( "LogViewFilterMC::compare_string(%d): '%s'' - '%s'", cmpfuntype, qPrintable( str_xml ), qPrintable( str_flt ) );
 
-      // match found - don't filter out this item!
-      if ( res_cmp )
-         return true;
+   bool res_cmp = false;
+   switch ( cmpfuntype ) {
+   case FUN_EQL:   res_cmp = ( str_xml ==          str_flt  ); break;
+   case FUN_NEQL:  res_cmp = ( str_xml !=          str_flt  ); break;
+   case FUN_CONT:  res_cmp = ( str_xml.contains(   str_flt )); break;
+   case FUN_NCONT: res_cmp = (!str_xml.contains(   str_flt )); break;
+   case FUN_STRT:  res_cmp = ( str_xml.startsWith( str_flt )); break;
+   case FUN_NSTRT: res_cmp = (!str_xml.startsWith( str_flt )); break;
+   case FUN_END:   res_cmp = ( str_xml.endsWith(   str_flt )); break;
+   case FUN_NEND:  res_cmp = (!str_xml.endsWith(   str_flt )); break;
+   default:
+      vk_assert_never_reached();
    }
-
-   // no match: filter out (hide) this item
-   return false;
+   return res_cmp;
 }
@@ -22,10 +22,12 @@
 
 #include "toolview/vglogview.h"
 
+#include <QBitArray>
+#include <QByteArray>
 #include <QComboBox>
 #include <QPushButton>
 #include <QStackedWidget>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QWidget>
 
 
@@ -33,7 +35,7 @@ class LogViewFilterMC : public QWidget
 {
     Q_OBJECT
 public:
-    LogViewFilterMC(QWidget *parent, QTreeWidget* view );
+    LogViewFilterMC(QWidget *parent, QTreeView* view, VgLogModel* model );
 
 public slots:
     void showHideItem( VgOutputItem* item );
@@ -46,7 +48,8 @@ private slots:
     void refresh();
 
 private:
-    QTreeWidget* m_view;        // hold on to this to rescan entire tree.
+    QTreeView* m_view;          // hold on to this to rescan entire tree.
+    VgLogModel* m_model;
 
     QPushButton* butt_refresh;  // refresh the filter after editing
     QComboBox* combo_xmltag;    // combobox of xmltags to filter on
@@ -59,10 +62,15 @@ private:
                       FUN_NCONT, FUN_STRT, FUN_NSTRT, FUN_END, FUN_NEND };
     QMap<XmlTagType, CmpType> map_xmltag_cmptype;
 
-    bool xmlCompare( VgOutputItem* errItem, const QString& tag,
-                     const QString& str_flt, CmpFunType cmpFun, CmpType cmp_type );
-    bool compare_strings( const QStringList& list_xml, const QString& str_flt, CmpFunType cmpfuntype );
-    bool compare_integers( const QStringList& list_xml, const QString& str_flt, CmpFunType cmpfuntype );
+    void setItemHidden( VgOutputItem* item, bool hide );
+    bool matchRows( VgErrorStore* store, int from, int to, QBitArray& res );
+    const QByteArray& atomMatches( const QString& str_flt, CmpFunType cmpFun );
+    bool compare_string( const QString& str_xml, const QString& str_flt, CmpFunType cmpfuntype );
+
+    // atomMatches(), for this filter
+    QByteArray m_atomMatches;
+    QString m_atomFilter;
+    CmpFunType m_atomCmpFun;
 };
 
 #endif // LOGVIEWFILTER_MC_H
@@ -1,6 +1,6 @@
 /****************************************************************************
 ** MemcheckLogView implementation
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -55,8 +55,8 @@ ErrorItem::AcronymMap ErrorItemMC::acnymMap = setupErrAcronymMap();
 /*!
   ErrorItem for Memcheck
 */
-ErrorItemMC::ErrorItemMC( VgOutputItem* parent, QTreeWidgetItem* after,
-                          QDomElement err )
+ErrorItemMC::ErrorItemMC( VgOutputItem* parent, VgOutputItem* after,
+                          const VgError& err )
       : ErrorItem( parent, after, err, acnymMap )
 {
 }
@@ -71,9 +71,9 @@ ErrorItemMC::ErrorItemMC( VgOutputItem* parent, QTreeWidgetItem* after,
   status, client exe
   errcounts(num_errs), leak_errors(num_bytes++, num_blocks++)
 */
-TopStatusItemMC::TopStatusItemMC( QTreeWidget* parent, QDomElement exe,
-                                  QDomElement status, QString _protocol )
-   : TopStatusItem( parent, exe, status, ",   Leaked Bytes: 0", _protocol ),
+TopStatusItemMC::TopStatusItemMC( VgLogModel* model, QString exe,
+                                  const VgStatus& status, QString _protocol )
+   : TopStatusItem( model, exe, status, ",   Leaked Bytes: 0", _protocol ),
    num_bytes( 0 ), num_blocks( 0 )
 {
    // leaks, in addition to the basic errorcounts.
@@ -81,10 +81,9 @@ TopStatusItemMC::TopStatusItemMC( QTreeWidget* parent, QDomElement exe,
 }
 
 
-void TopStatusItemMC::updateToolStatus( QDomElement err )
+void TopStatusItemMC::updateToolStatus( const VgError& err )
 {
-   QString kind = err.firstChildElement( "kind" ).text();
-   if ( !kind.startsWith( "Leak_" ) ) {
+   if ( !err.isLeak() ) {
       // Update general error count
       // Note: this may be _way_ off, 'cos we don't see repeated errors
       // until we get an ERRORCOUNTS element
@@ -94,52 +93,29 @@ void TopStatusItemMC::updateToolStatus( QDomElement err )
    }
    else {
       // Update Leak_* error counts
-      QDomElement xwhat = err.firstChildElement( "xwhat" );
-      if ( xwhat.isNull() ) {
+      if ( !err.hasLeak ) {
          vkPrintErr( "TopStatusItemMC::updateToolStatus(): missing xwhat element for leak error" );
       }
       else {
-#if 1  //TODO: still needed?
-
-         /* HACK ALERT!
-            VALGRIND_DO_LEAK_CHECK gives repeated leaks...
-            taking apart error::what to get record number
-            - if this is 'record 1' then reset counters
+         /* VALGRIND_DO_LEAK_CHECK gives repeated leaks...
+            if this is 'record 1' then reset counters
          */
-         QDomElement text = xwhat.firstChildElement( "text" );
-         if ( ! text.isNull() ) {
-            QString text_str = text.text();
-            QString lossrec_str = text_str.mid( text_str.indexOf( "in loss record " ) );
-
-            if ( !lossrec_str.isEmpty() ) {
-               QString record = lossrec_str.split( " ", QString::SkipEmptyParts )[3];
-
-               if ( record == "1" ) {
-                  num_bytes = num_blocks = 0;
-               }
-            }
-            else {
-               VK_DEBUG( "Unexpected string value for 'text' element: %s",
-                         qPrintable( text_str ) );
-            }
+         int record = err.lossRecord();
+         if ( record == 1 ) {
+            num_bytes = num_blocks = 0;
          }
-         else {
-            VK_DEBUG( "No 'text' child for 'xwhat' element" );
+         else if ( record == 0 ) {
+            VK_DEBUG( "Unexpected string value for 'text' element: %s",
+                      qPrintable( err.what ) );
          }
-#endif
-
-         QDomElement leakedbytes  = xwhat.firstChildElement( "leakedbytes" );
-         QDomElement leakedblocks = xwhat.firstChildElement( "leakedblocks" );
 
-         if ( !leakedbytes.isNull() && !leakedblocks.isNull() ) {
-            num_bytes  += leakedbytes.text().toUInt();
-            num_blocks += leakedblocks.text().toUInt();
+         num_bytes  += err.leakedBytes;
+         num_blocks += err.leakedBlocks;
 
-            toolstatus_str = errcounts_tmplt
-                             .arg( num_bytes )
-                             .arg( num_blocks );
-            updateText();
-         }
+         toolstatus_str = errcounts_tmplt
+                          .arg( num_bytes )
+                          .arg( num_blocks );
+         updateText();
       }
    }
 }
@@ -151,29 +127,34 @@ void TopStatusItemMC::updateToolStatus( QDomElement err )
 /*!
   MemcheckLogView
 */
-MemcheckLogView::MemcheckLogView( QTreeWidget* view )
-   : VgLogView( view )
+MemcheckLogView::MemcheckLogView( VgLogModel* model )
+   : VgLogView( model ), leakModel( 0 )
 {}
 
 MemcheckLogView::~MemcheckLogView()
 {}
 
+void MemcheckLogView::setLeakModel( VgLeakModel* leaks )
+{
+   leakModel = leaks;
+}
+
 QString MemcheckLogView::toolName()
 {
    return "memcheck";
 }
 
 /*!
-  Populate our model (QDomDocument) and the view (QListWidget)
-   - top-level xml elements are pushed to us from the parser
-   - node is reparented to the QDomDocument log
+  Populate our model and the view (QListWidget)
+   - top-level xml elements are pushed to us from the parser,
+     already decoded into typed records
 */
-bool MemcheckLogView::appendNodeTool( QDomElement elem, QString& errMsg )
+bool MemcheckLogView::appendNodeTool( const VgLogRecord& rec, QString& errMsg )
 {
-   switch ( VgOutputItem::elemType( elem.tagName() ) ) {
+   switch ( rec.type ) {
    case VG_ELEM::PROTOCOL_VERSION : {
-      if ( elem.text() != "4" ) {
-         errMsg = "Memcheck tool doesn't support XML protocol version: (" + elem.text() + ")";
+      if ( rec.text != "4" ) {
+         errMsg = "Memcheck tool doesn't support XML protocol version: (" + rec.text + ")";
          vkPrintErr( "%s", qPrintable( "MemcheckLogView::appendNodeTool(): " + errMsg ) );
          return false;
       }
@@ -181,12 +162,13 @@ bool MemcheckLogView::appendNodeTool( QDomElement elem, QString& errMsg )
    }
 
    case VG_ELEM::ERROR: {
-      QDomElement err = elem;
-      lastItem = new ErrorItemMC( topStatus, lastItem, err );
+      const VgError& err = rec.error;
+      lastItem = new ErrorItemMC( errorParent(), lastItem, err );
 
-// TODO:
-//      flicker a problem?
-      emit this->errorItemAdded( lastItem );
+      // leaks: into the table too, while we have the alloc stack
+      if ( leakModel && err.isLeak() && err.hasLeak ) {
+         leakModel->addLeak( this, ( ErrorItem* )lastItem, err );
+      }
 
       // update topStatus
       topStatus->updateToolStatus( err );
@@ -201,11 +183,11 @@ bool MemcheckLogView::appendNodeTool( QDomElement elem, QString& errMsg )
 }
 
 
-TopStatusItem* MemcheckLogView::createTopStatus( QTreeWidget* view,
-                                                 QDomElement exe,
-                                                 QDomElement status,
+TopStatusItem* MemcheckLogView::createTopStatus( VgLogModel* model,
+                                                 QString exe,
+                                                 const VgStatus& status,
                                                  QString _protocol )
 {
-   return new TopStatusItemMC( view, exe, status, _protocol );
+   return new TopStatusItemMC( model, exe, status, _protocol );
 }
 
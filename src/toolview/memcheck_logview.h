@@ -1,6 +1,6 @@
 /****************************************************************************
 ** MemcheckLogView definition
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -22,6 +22,7 @@
 #define __VK_MEMCHECKLOGVIEW_H
 
 #include "toolview/vglogview.h"
+#include "toolview/vgleakmodel.h"
 
 
 // ============================================================
@@ -29,18 +30,21 @@ class MemcheckLogView : public VgLogView
 {
    Q_OBJECT
 public:
-   MemcheckLogView( QTreeWidget* );
+   MemcheckLogView( VgLogModel* );
    ~MemcheckLogView();
 
-signals:
-   void errorItemAdded( VgOutputItem* item );
+   // leak errors also go into the leak table
+   void setLeakModel( VgLeakModel* leaks );
 
 private:
    // Template method functions:
-   TopStatusItem* createTopStatus( QTreeWidget* view, QDomElement exe,
-                                   QDomElement status, QString _protocol );
+   TopStatusItem* createTopStatus( VgLogModel* model, QString exe,
+                                   const VgStatus& status, QString _protocol );
    QString toolName();
-   bool appendNodeTool( QDomElement elem, QString& errMsg );
+   bool appendNodeTool( const VgLogRecord& rec, QString& errMsg );
+
+private:
+   VgLeakModel* leakModel;   // we don't own this
 };
 
 
@@ -51,8 +55,8 @@ private:
 class ErrorItemMC : public ErrorItem
 {
 public:
-   ErrorItemMC( VgOutputItem* parent, QTreeWidgetItem* after,
-                QDomElement err );
+   ErrorItemMC( VgOutputItem* parent, VgOutputItem* after,
+                const VgError& err );
 private:
    static ErrorItem::AcronymMap acnymMap;
 };
@@ -64,13 +68,13 @@ private:
 class TopStatusItemMC : public TopStatusItem
 {
 public:
-   TopStatusItemMC( QTreeWidget* parent, QDomElement exe,
-                    QDomElement status, QString _protocol );
+   TopStatusItemMC( VgLogModel* model, QString exe,
+                    const VgStatus& status, QString _protocol );
 
-   void updateToolStatus( QDomElement err );
+   void updateToolStatus( const VgError& err );
 
 private:
-   int num_bytes, num_blocks;
+   qulonglong num_bytes, num_blocks;
    QString errcounts_tmplt;
 };
 
@@ -22,11 +22,13 @@
 #define __MEMCHECKVIEW_H
 
 #include "toolview/toolview.h"
+#include "toolview/vggroupmodel.h"
+#include "toolview/vgleakmodel.h"
 #include "toolview/vglogview.h"
 #include "toolview/logviewfilter_mc.h"
 
 #include <QMenu>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QToolButton>
 
 
@@ -39,6 +41,7 @@ public:
    ~MemcheckView();
 
    VgLogView* createVgLogView();
+   VgLogView* addVgLogView();
 
 public slots:
    virtual void setState( bool run );
@@ -47,27 +50,43 @@ private:
    void setupLayout();
    void setupActions();
    void setupToolBar();
+   void showView( QTreeView* view );
+   void showErrorItem( ErrorItem* item );
 
 private slots:
    void opencloseAllItems();
    void opencloseOneItem();
    void showSrcPath();
-   void launchEditor( QTreeWidgetItem* item );
-   void itemExpanded( QTreeWidgetItem* item );
-   void itemCollapsed( QTreeWidgetItem* item );
+   void launchEditor( const QModelIndex& index );
+   void loadMoreErrors();
+   void itemExpanded( const QModelIndex& index );
+   void itemCollapsed( const QModelIndex& index );
    void popupMenu( const QPoint& pos );
    void updateItemActions();
+   void groupErrors( bool on );
+   void showGroupedError( const QModelIndex& index );
+   void showLeaks( bool on );
+   void showLeakError( const QModelIndex& index );
 
 private:
    QAction* act_OpenClose_all;
    QAction* act_OpenClose_item;
    QAction* act_ShowSrcPaths;
    QAction* act_OpenLog;
+   QAction* act_FollowLog;
+   QAction* act_LoadMore;
+   QAction* act_GroupErrors;
+   QAction* act_ShowLeaks;
    QAction* act_SaveLog;
    QAction* act_enableFilter;
 
-   QTreeWidget* treeView;
-   VgLogView*   logview;
+   QTreeView* treeView;
+   VgLogModel* logModel;    // all our logs
+   QTreeView* groupView;
+   VgGroupModel* groupModel;  // the same errors, grouped
+   QTreeView* leakView;
+   VgLeakModel* leakModel;    // the leak errors, as a table
+   QList<VgLogView*> logviews;
 
    LogViewFilterMC* logviewFilter;
 };
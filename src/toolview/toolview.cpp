@@ -145,18 +145,45 @@ void ToolView::openLogFile()
 {
    //vkDebug( "ToolView::openLogFile()" );
 
+   if ( !chooseLogFile() ) {
+      return;
+   }
+
+   // informs tool_object to load the log_file given in config
+   emit run( VGTOOL::PROC_PARSE_LOG );
+}
+
+
+/*!
+  Open a log another process is still writing, e.g. valgrind run
+  from a test harness: tool_object keeps reading the log as it
+  grows, until it's complete.
+*/
+void ToolView::followLogFile()
+{
+   if ( !chooseLogFile() ) {
+      return;
+   }
+
+   emit run( VGTOOL::PROC_FOLLOW_LOG );
+}
+
+
+/*!
+  Ask the user for a log: false if they didn't pick one.
+*/
+bool ToolView::chooseLogFile()
+{
    QString log_file = vkDlgCfgGetFile( this, "valkyrie/view-log" );
 
    // user might have clicked Cancel
    if ( log_file.isEmpty() ) {
-      return;
+      return false;
    }
 
    // updates config (as does cmd line --view-cfg...)
    emit logFileChosen( log_file );
-
-   // informs tool_object to load the log_file given in config
-   emit run( VGTOOL::PROC_PARSE_LOG );
+   return true;
 }
 
 
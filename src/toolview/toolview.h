@@ -51,12 +51,13 @@ enum ToolProcessId {
    PROC_NONE = -1,    // no process running
    PROC_VALGRIND = 0, // run valgrind for given tool
    PROC_PARSE_LOG = 1,
+   PROC_FOLLOW_LOG = 2, // parse a log as it's written, till it's complete
 
    // If Tools need their own processes, extend this enum as follows:
    // Add PROC_TOOL_FIRST here: tool defined proc-id's start here, and run to < PROC_MAX
    // Within tool: enum toolProcess { PROC_TOOL1 = VGTOOL::PROC_TOOL_FIRST, ... }
 
-   PROC_MAX = 2       // to a reasonable max number of processes per tool
+   PROC_MAX = 3       // to a reasonable max number of processes per tool
 };
 }
 
@@ -71,7 +72,8 @@ public:
    ToolView( QWidget* parent, VGTOOL::ToolID toolId );
    ~ToolView();
 
-   virtual VgLogView* createVgLogView() = 0;
+   virtual VgLogView* createVgLogView() = 0;  // clears any others
+   virtual VgLogView* addVgLogView() = 0;     // one more, alongside
 
    void setToolFont( QFont font );
 
@@ -92,6 +94,10 @@ protected:
 
 protected slots:
    void openLogFile();
+   void followLogFile();
+
+private:
+   bool chooseLogFile();
 
 public slots:
    // called by the view's object
@@ -0,0 +1,258 @@
+/****************************************************************************
+** VgGroupModel implementation
+**  - item model over the errors of the tool-logviews, grouped
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vggroupmodel.h"
+#include "toolview/vglogview.h"
+#include "utils/vk_config.h"
+#include "utils/vk_utils.h"
+
+#include <QFont>
+
+
+/*
+  Model indexes: a group's row has internal id 0,
+  an error's row has its group + 1.
+*/
+
+
+// ============================================================
+/*!
+  VgGroupModel
+*/
+VgGroupModel::VgGroupModel( QObject* parent )
+   : QAbstractItemModel( parent ), shownGroups( 0 )
+{
+   clear();
+}
+
+
+/*!
+  Drop all the groups
+   - the frames compared are as configured now: see [VALKYRIE::GROUP_FRAMES]
+*/
+void VgGroupModel::clear()
+{
+   int nFrames = vkCfgProj->value( "valkyrie/group-frames" ).toInt();
+   if ( nFrames <= 0 ) {
+      nFrames = 4;
+   }
+
+   beginResetModel();
+   groups.clear( nFrames );
+   members.clear();
+   groupOf.clear();
+   shownGroups = 0;
+   shownMembers.clear();
+   changed.clear();
+   endResetModel();
+}
+
+
+/*!
+  A new error, with its details: into its group
+   - the views are told on updateRows()
+*/
+void VgGroupModel::addError( ErrorItem* item, const VgError& err )
+{
+   int grp = groups.addError( err, item->getCount() );
+   if ( grp == members.count() ) {
+      members.append( QList<ErrorItem*>() );
+      shownMembers.append( 0 );
+   }
+   members[grp].append( item );
+   groupOf.insert( item, grp );
+   changed.append( grp );
+}
+
+
+/*!
+  An error's count has changed by delta
+   - errors we don't know (e.g. fatal signals) are ignored
+*/
+void VgGroupModel::updateCount( ErrorItem* item, int delta )
+{
+   QHash<ErrorItem*, int>::const_iterator it = groupOf.constFind( item );
+   if ( it == groupOf.constEnd() || delta == 0 ) {
+      return;
+   }
+   groups.addCount( it.value(), delta );
+   changed.append( it.value() );
+}
+
+
+/*!
+  Tell the views what's changed since last time
+   - new errors in known groups, new groups, and changed group rows.
+   - a signal per changed group, not per error: so a batch of
+     errors costs the views about the same, however big it is.
+*/
+void VgGroupModel::updateRows()
+{
+   if ( changed.isEmpty() ) {
+      return;
+   }
+
+   int firstChanged = shownGroups, lastChanged = -1;
+   foreach( int grp, changed ) {
+      if ( grp >= shownGroups ) {
+         continue;    // new group: goes in with its errors
+      }
+      int n = members.at( grp ).count();
+      if ( n > shownMembers.at( grp ) ) {
+         beginInsertRows( index( grp, 0 ), shownMembers.at( grp ), n - 1 );
+         shownMembers[grp] = n;
+         endInsertRows();
+      }
+      firstChanged = qMin( firstChanged, grp );
+      lastChanged  = qMax( lastChanged, grp );
+   }
+   changed.clear();
+
+   if ( lastChanged >= 0 ) {
+      emit dataChanged( index( firstChanged, 0 ), index( lastChanged, 0 ) );
+   }
+
+   int nGroups = members.count();
+   if ( nGroups > shownGroups ) {
+      beginInsertRows( QModelIndex(), shownGroups, nGroups - 1 );
+      for ( int grp=shownGroups; grp<nGroups; ++grp ) {
+         shownMembers[grp] = members.at( grp ).count();
+      }
+      shownGroups = nGroups;
+      endInsertRows();
+   }
+}
+
+
+ErrorItem* VgGroupModel::errorItem( const QModelIndex& index ) const
+{
+   if ( !index.isValid() || index.internalId() == 0 ) {
+      return 0;
+   }
+   int grp = int( index.internalId() ) - 1;
+   return members.at( grp ).at( index.row() );
+}
+
+
+QString VgGroupModel::groupText( int grp ) const
+{
+   const VgErrorGroup& group = groups.group( grp );
+
+   QString str = group.kind.str() + " [" +
+                 QString::number( group.errors ) + " errors, " +
+                 QString::number( group.count ) + " times";
+   if ( group.leakedBytes > 0 ) {
+      str += ", " + QString::number( group.leakedBytes ) + " bytes in " +
+             QString::number( group.leakedBlocks ) + " blocks";
+   }
+   return str + "]: " + group.describe();
+}
+
+
+QModelIndex VgGroupModel::index( int row, int column,
+                                 const QModelIndex& parent ) const
+{
+   if ( column != 0 || row < 0 ) {
+      return QModelIndex();
+   }
+
+   if ( !parent.isValid() ) {
+      if ( row >= shownGroups ) {
+         return QModelIndex();
+      }
+      return createIndex( row, 0, quint32( 0 ) );
+   }
+
+   if ( parent.internalId() != 0 ) {
+      return QModelIndex();   // errors have no children here
+   }
+   int grp = parent.row();
+   if ( row >= shownMembers.at( grp ) ) {
+      return QModelIndex();
+   }
+   return createIndex( row, 0, quint32( grp + 1 ) );
+}
+
+
+QModelIndex VgGroupModel::parent( const QModelIndex& index ) const
+{
+   if ( !index.isValid() || index.internalId() == 0 ) {
+      return QModelIndex();
+   }
+   int grp = int( index.internalId() ) - 1;
+   return createIndex( grp, 0, quint32( 0 ) );
+}
+
+
+int VgGroupModel::rowCount( const QModelIndex& parent ) const
+{
+   if ( !parent.isValid() ) {
+      return shownGroups;
+   }
+   if ( parent.column() > 0 || parent.internalId() != 0 ) {
+      return 0;
+   }
+   return shownMembers.at( parent.row() );
+}
+
+
+int VgGroupModel::columnCount( const QModelIndex& /*parent*/ ) const
+{
+   return 1;
+}
+
+
+/*!
+  Group rows: made up as shown. Error rows: the error item's own text.
+*/
+QVariant VgGroupModel::data( const QModelIndex& index, int role ) const
+{
+   if ( !index.isValid() ) {
+      return QVariant();
+   }
+
+   ErrorItem* item = errorItem( index );
+   if ( item != 0 ) {
+      return item->data( role );
+   }
+
+   switch ( role ) {
+   case Qt::DisplayRole:
+      return groupText( index.row() );
+
+   case Qt::FontRole: {
+      QFont fnt;
+      fnt.setWeight( QFont::DemiBold );
+      return fnt;
+   }
+
+   default:
+      return QVariant();
+   }
+}
+
+
+Qt::ItemFlags VgGroupModel::flags( const QModelIndex& index ) const
+{
+   if ( !index.isValid() ) {
+      return Qt::NoItemFlags;
+   }
+   return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+** VgGroupModel definition
+**  - item model over the errors of the tool-logviews, grouped
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_VGGROUPMODEL_H
+#define __VK_VGGROUPMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QModelIndex>
+#include <QVariant>
+#include <QVector>
+
+#include "utils/vgerrorgroups.h"
+
+
+// ============================================================
+// Forward decls
+class ErrorItem;
+
+
+// ============================================================
+/*!
+  VgGroupModel: what a tool's 'Group Errors' view shows
+
+   - Top-level rows are the groups of a VgErrorGroups engine: each
+     with its kind, its errors' counts & leaked bytes, and where
+     they happen. Under each group, a row per error: the ErrorItems
+     of the VgLogModel.
+
+   - The VgLogViews add their errors as they come in: the groups
+     are kept up to date as they go, but the views are only told
+     on updateRows(), once per batch of errors.
+
+   - We don't own the ErrorItems: clear() us along with the VgLogModel.
+*/
+class VgGroupModel : public QAbstractItemModel
+{
+   Q_OBJECT
+public:
+   VgGroupModel( QObject* parent );
+
+   void clear();
+
+   // for VgLogView: keep the groups up to date
+   void addError( ErrorItem* item, const VgError& err );
+   void updateCount( ErrorItem* item, int delta );
+   void updateRows();
+
+   ErrorItem* errorItem( const QModelIndex& index ) const;   // 0 for groups
+
+   // QAbstractItemModel
+   QModelIndex index( int row, int column,
+                      const QModelIndex& parent = QModelIndex() ) const;
+   QModelIndex parent( const QModelIndex& index ) const;
+   int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+   int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+   QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+   Qt::ItemFlags flags( const QModelIndex& index ) const;
+
+private:
+   QString groupText( int grp ) const;
+
+private:
+   VgErrorGroups groups;
+   QVector< QList<ErrorItem*> > members;   // errors, by group
+   QHash<ErrorItem*, int> groupOf;
+
+   // what the views know of
+   int shownGroups;
+   QVector<int> shownMembers;              // by group
+   QList<int> changed;                     // groups since updateRows()
+};
+
+#endif // #ifndef __VK_VGGROUPMODEL_H
@@ -0,0 +1,360 @@
+/****************************************************************************
+** VgLeakModel implementation
+**  - table model over memcheck's leak records
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgleakmodel.h"
+#include "utils/vk_utils.h"
+
+#include <QFileInfo>
+#include <QTimer>
+
+#include <algorithm>
+
+
+// ============================================================
+/*
+  Leak ordering, for a column
+   - ties go in log order: so any sort is stable, and merging
+     new leaks in gives the same rows as a full re-sort would.
+*/
+class VgLeakLess
+{
+public:
+   VgLeakLess( const QVector<VgLeakRecord>& l, int col, Qt::SortOrder order )
+      : leaks( l ), column( col ), desc( order == Qt::DescendingOrder ) {}
+
+   bool operator()( int a, int b ) const {
+      const VgLeakRecord& la = leaks.at( a );
+      const VgLeakRecord& lb = leaks.at( b );
+
+      int cmp = 0;
+      switch ( column ) {
+      case VgLeakModel::RECORD: cmp = compare( la.record, lb.record ); break;
+      case VgLeakModel::BYTES:  cmp = compare( la.bytes,  lb.bytes );  break;
+      case VgLeakModel::BLOCKS: cmp = compare( la.blocks, lb.blocks ); break;
+      case VgLeakModel::KIND:
+         if ( la.kind != lb.kind ) {
+            cmp = QString::compare( la.kind.str(), lb.kind.str() );
+         }
+         break;
+      case VgLeakModel::SITE:
+         if ( la.site.fn != lb.site.fn ) {
+            cmp = QString::compare( la.site.fn.str(), lb.site.fn.str() );
+         }
+         else {
+            cmp = compare( la.site.ip, lb.site.ip );
+         }
+         break;
+      default:
+         break;
+      }
+
+      if ( cmp == 0 ) {
+         return a < b;
+      }
+      return desc ? cmp > 0 : cmp < 0;
+   }
+
+private:
+   template <typename T>
+   static int compare( T a, T b ) {
+      return ( a < b ) ? -1 : ( ( b < a ) ? 1 : 0 );
+   }
+
+private:
+   const QVector<VgLeakRecord>& leaks;
+   int column;
+   bool desc;
+};
+
+
+
+// ============================================================
+/*!
+  VgLeakModel
+*/
+VgLeakModel::VgLeakModel( QObject* parent )
+   : QAbstractTableModel( parent ),
+     sortColumn( BYTES ), sortOrder( Qt::DescendingOrder ),
+     insertQueued( false )
+{}
+
+
+void VgLeakModel::clear()
+{
+   beginResetModel();
+   leaks.clear();
+   rows.clear();
+   endResetModel();
+}
+
+
+/*!
+  A new leak error: pending until the event loop comes round again,
+  so a whole batch of leaks goes into the views in one go.
+*/
+void VgLeakModel::addLeak( const void* log, ErrorItem* item, const VgError& err )
+{
+   VgLeakRecord leak;
+   leak.log    = log;
+   leak.item   = item;
+   leak.record = err.lossRecord();
+   leak.kind   = VkAtom( err.kind );
+   leak.bytes  = err.leakedBytes;
+   leak.blocks = err.leakedBlocks;
+
+   // allocation site: the first frame that isn't valgrind's malloc & co
+   if ( !err.stacks.isEmpty() && !err.stacks.at( 0 ).isEmpty() ) {
+      const VgStack& stack = err.stacks.at( 0 );
+      leak.site = stack.at( 0 );
+      foreach( const VgFrame& frame, stack ) {
+         if ( !QFileInfo( frame.obj.str() ).fileName().startsWith( "vgpreload_" ) ) {
+            leak.site = frame;
+            break;
+         }
+      }
+   }
+
+   // a new leak check of this log: replaces the last
+   if ( leak.record == 1 ) {
+      dropLeaks( log );
+   }
+
+   leaks.append( leak );
+   if ( !insertQueued ) {
+      insertQueued = true;
+      QTimer::singleShot( 0, this, SLOT( insertPendingRows() ) );
+   }
+}
+
+
+ErrorItem* VgLeakModel::errorItem( const QModelIndex& index ) const
+{
+   if ( !index.isValid() ) {
+      return 0;
+   }
+   return leaks.at( rows.at( index.row() ) ).item;
+}
+
+
+/*!
+  Put the pending leaks in the views
+   - sorted among themselves, then merged in with the rest.
+*/
+void VgLeakModel::insertPendingRows()
+{
+   insertQueued = false;
+
+   int n = rows.count();
+   int k = leaks.count() - n;
+   if ( k <= 0 ) {
+      return;
+   }
+
+   beginInsertRows( QModelIndex(), n, n + k - 1 );
+   for ( int id=n; id<n + k; ++id ) {
+      rows.append( id );
+   }
+   if ( n == 0 ) {
+      sortRows( 0 );   // nothing to merge with
+   }
+   endInsertRows();
+
+   if ( n > 0 && sortColumn >= 0 ) {
+      emit layoutAboutToBeChanged();
+      QModelIndexList from = persistentIndexList();
+      QVector<int> ids;
+      foreach( const QModelIndex& idx, from ) {
+         ids.append( rows.at( idx.row() ) );
+      }
+      sortRows( n );
+      updatePersistentRows( from, ids );
+      emit layoutChanged();
+   }
+}
+
+
+/*!
+  Drop all leaks from the given log
+*/
+void VgLeakModel::dropLeaks( const void* log )
+{
+   bool found = false;
+   foreach( const VgLeakRecord& leak, leaks ) {
+      if ( leak.log == log ) {
+         found = true;
+         break;
+      }
+   }
+   if ( !found ) {
+      return;
+   }
+
+   beginResetModel();
+   QVector<VgLeakRecord> kept;
+   foreach( const VgLeakRecord& leak, leaks ) {
+      if ( leak.log != log ) {
+         kept.append( leak );
+      }
+   }
+   leaks = kept;
+
+   // all in: any pending too
+   rows.clear();
+   for ( int id=0; id<leaks.count(); ++id ) {
+      rows.append( id );
+   }
+   sortRows( 0 );
+   endResetModel();
+}
+
+
+/*!
+  Sort rows[from..], and merge them in with rows[..from], already sorted
+*/
+void VgLeakModel::sortRows( int from )
+{
+   VgLeakLess less( leaks, sortColumn, sortOrder );
+   std::sort( rows.begin() + from, rows.end(), less );
+   if ( from > 0 ) {
+      std::inplace_merge( rows.begin(), rows.begin() + from, rows.end(), less );
+   }
+}
+
+
+/*!
+  Persistent indexes (selection, current) follow their leaks to their
+  new rows
+*/
+void VgLeakModel::updatePersistentRows( const QModelIndexList& from,
+                                        const QVector<int>& ids )
+{
+   if ( from.isEmpty() ) {
+      return;
+   }
+
+   QVector<int> rowOf( leaks.count(), -1 );
+   for ( int row=0; row<rows.count(); ++row ) {
+      rowOf[rows.at( row )] = row;
+   }
+
+   QModelIndexList to;
+   for ( int i=0; i<from.count(); ++i ) {
+      to.append( index( rowOf.at( ids.at( i ) ), from.at( i ).column() ) );
+   }
+   changePersistentIndexList( from, to );
+}
+
+
+int VgLeakModel::rowCount( const QModelIndex& parent ) const
+{
+   return parent.isValid() ? 0 : rows.count();
+}
+
+
+int VgLeakModel::columnCount( const QModelIndex& parent ) const
+{
+   return parent.isValid() ? 0 : NUM_COLS;
+}
+
+
+QVariant VgLeakModel::data( const QModelIndex& index, int role ) const
+{
+   if ( !index.isValid() ) {
+      return QVariant();
+   }
+   const VgLeakRecord& leak = leaks.at( rows.at( index.row() ) );
+
+   if ( role == Qt::TextAlignmentRole ) {
+      if ( index.column() == KIND || index.column() == SITE ) {
+         return QVariant();
+      }
+      return int( Qt::AlignRight | Qt::AlignVCenter );
+   }
+
+   if ( role == Qt::ToolTipRole && index.column() == SITE ) {
+      return leak.site.describeIP( true );
+   }
+
+   if ( role != Qt::DisplayRole ) {
+      return QVariant();
+   }
+
+   switch ( index.column() ) {
+   case RECORD:
+      return ( leak.record > 0 ) ? QVariant( leak.record ) : QVariant();
+   case KIND: {
+      QString kind = leak.kind.str();
+      return kind.startsWith( "Leak_" ) ? kind.mid( 5 ) : kind;
+   }
+   case BYTES:
+      return leak.bytes;
+   case BLOCKS:
+      return leak.blocks;
+   case SITE:
+      return leak.site.describeIP();
+   default:
+      return QVariant();
+   }
+}
+
+
+QVariant VgLeakModel::headerData( int section, Qt::Orientation orientation,
+                                  int role ) const
+{
+   if ( orientation != Qt::Horizontal || role != Qt::DisplayRole ) {
+      return QVariant();
+   }
+
+   switch ( section ) {
+   case RECORD: return tr( "Record" );
+   case KIND:   return tr( "Kind" );
+   case BYTES:  return tr( "Bytes" );
+   case BLOCKS: return tr( "Blocks" );
+   case SITE:   return tr( "Allocated at" );
+   default:     return QVariant();
+   }
+}
+
+
+/*!
+  Sort by the given column: O(n log n), once
+   - -1: back to log order
+*/
+void VgLeakModel::sort( int column, Qt::SortOrder order )
+{
+   if ( column < 0 || column >= NUM_COLS ) {
+      column = -1;
+   }
+   if ( column == sortColumn && order == sortOrder ) {
+      return;
+   }
+   sortColumn = column;
+   sortOrder  = order;
+
+   emit layoutAboutToBeChanged();
+   QModelIndexList from = persistentIndexList();
+   QVector<int> ids;
+   foreach( const QModelIndex& idx, from ) {
+      ids.append( rows.at( idx.row() ) );
+   }
+   sortRows( 0 );
+   updatePersistentRows( from, ids );
+   emit layoutChanged();
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+** VgLeakModel definition
+**  - table model over memcheck's leak records
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_VGLEAKMODEL_H
+#define __VK_VGLEAKMODEL_H
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QVariant>
+#include <QVector>
+
+#include "utils/vglogrecord.h"
+
+
+// ============================================================
+// Forward decls
+class ErrorItem;
+
+
+// ============================================================
+/*!
+  VgLeakRecord: one leak error, as typed table data
+*/
+class VgLeakRecord
+{
+public:
+   VgLeakRecord() : log( 0 ), item( 0 ), record( 0 ),
+                    bytes( 0 ), blocks( 0 ) {}
+
+   const void* log;        // the VgLogView it came from
+   ErrorItem*  item;       // its item in that log
+   int         record;     // loss record number: 0 if not known
+   VkAtom      kind;
+   qulonglong  bytes;
+   qulonglong  blocks;
+   VgFrame     site;       // where the blocks were allocated
+};
+
+
+
+// ============================================================
+/*!
+  VgLeakModel: what memcheck's 'Show Leaks' view shows
+
+   - A row per leak error: loss record, kind, bytes, blocks and
+     allocation site, as typed (numeric) data.
+
+   - Sorted by any column (by bytes, biggest first, to start with):
+     one O(n log n) sort on sort(). Leaks coming in after that are
+     sorted among themselves and merged in, once per event loop pass:
+     O(n + k log k) for k new leaks, rather than a re-sort.
+
+   - A new leak check of the same log (loss record 1 again, e.g. from
+     VALGRIND_DO_LEAK_CHECK) replaces that log's leaks.
+
+   - We don't own the ErrorItems: clear() us along with the VgLogModel.
+*/
+class VgLeakModel : public QAbstractTableModel
+{
+   Q_OBJECT
+public:
+   enum Column { RECORD, KIND, BYTES, BLOCKS, SITE, NUM_COLS };
+
+   VgLeakModel( QObject* parent );
+
+   void clear();
+
+   // for MemcheckLogView: a new leak error, with its details
+   void addLeak( const void* log, ErrorItem* item, const VgError& err );
+
+   ErrorItem* errorItem( const QModelIndex& index ) const;
+
+   // QAbstractItemModel
+   int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+   int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+   QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+   QVariant headerData( int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole ) const;
+   void sort( int column, Qt::SortOrder order = Qt::AscendingOrder );
+
+private slots:
+   void insertPendingRows();
+
+private:
+   void dropLeaks( const void* log );
+   void sortRows( int from );
+   void updatePersistentRows( const QModelIndexList& from,
+                              const QVector<int>& ids );
+
+private:
+   QVector<VgLeakRecord> leaks;   // in log order: those past rows.count()
+                                  // are pending, not yet in the views
+   QVector<int> rows;             // row -> leak, as sorted
+   int sortColumn;                // -1: log order
+   Qt::SortOrder sortOrder;
+   bool insertQueued;
+};
+
+#endif // #ifndef __VK_VGLEAKMODEL_H
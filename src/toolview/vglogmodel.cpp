@@ -0,0 +1,227 @@
+/****************************************************************************
+** VgLogModel implementation
+**  - item model over the VgOutputItems of the tool-logviews
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vglogmodel.h"
+#include "toolview/vglogview.h"
+#include "utils/vk_utils.h"
+
+
+// ============================================================
+/*!
+  The (hidden) root item: the one item that knows its model
+*/
+class VgRootItem : public VgOutputItem
+{
+public:
+   VgRootItem( VgLogModel* m )
+      : VgOutputItem( 0, VG_ELEM::NUM_ELEMS ), logmodel( m ) { }
+
+   VgLogModel* logModel() {
+      return logmodel;
+   }
+
+private:
+   VgLogModel* logmodel;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogModel
+*/
+VgLogModel::VgLogModel( QObject* parent )
+   : QAbstractItemModel( parent )
+{
+   root = new VgRootItem( this );
+}
+
+VgLogModel::~VgLogModel()
+{
+   delete root;
+}
+
+
+/*!
+  Drop all the logs
+   - any VgLogViews still filling them are done with
+*/
+void VgLogModel::clear()
+{
+   beginResetModel();
+   delete root;
+   root = new VgRootItem( this );
+   endResetModel();
+}
+
+
+VgOutputItem* VgLogModel::rootItem()
+{
+   return root;
+}
+
+
+VgOutputItem* VgLogModel::item( const QModelIndex& index ) const
+{
+   if ( !index.isValid() ) {
+      return root;
+   }
+   return ( VgOutputItem* )index.internalPointer();
+}
+
+
+QModelIndex VgLogModel::indexOf( VgOutputItem* item ) const
+{
+   if ( item == 0 || item == root ) {
+      return QModelIndex();
+   }
+   return createIndex( item->row(), 0, item );
+}
+
+
+QModelIndex VgLogModel::index( int row, int column,
+                               const QModelIndex& parent ) const
+{
+   if ( column != 0 ) {
+      return QModelIndex();
+   }
+
+   VgOutputItem* child = item( parent )->child( row );
+   if ( child == 0 ) {
+      return QModelIndex();
+   }
+   return createIndex( row, 0, child );
+}
+
+
+QModelIndex VgLogModel::parent( const QModelIndex& index ) const
+{
+   if ( !index.isValid() ) {
+      return QModelIndex();
+   }
+   // top-level items have no parent(): their parent is the root
+   return indexOf( item( index )->parent() );
+}
+
+
+int VgLogModel::rowCount( const QModelIndex& parent ) const
+{
+   if ( parent.column() > 0 ) {
+      return 0;
+   }
+   return item( parent )->childCount();
+}
+
+
+int VgLogModel::columnCount( const QModelIndex& /*parent*/ ) const
+{
+   return 1;
+}
+
+
+/*!
+  Children set up, or still to be: see VgOutputItem::canFetchChildren()
+*/
+bool VgLogModel::hasChildren( const QModelIndex& parent ) const
+{
+   VgOutputItem* par = item( parent );
+   return par->childCount() > 0 || par->canFetchChildren();
+}
+
+
+QVariant VgLogModel::data( const QModelIndex& index, int role ) const
+{
+   if ( !index.isValid() ) {
+      return QVariant();
+   }
+   return item( index )->data( role );
+}
+
+
+Qt::ItemFlags VgLogModel::flags( const QModelIndex& index ) const
+{
+   if ( !index.isValid() ) {
+      return Qt::NoItemFlags;
+   }
+   return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+
+bool VgLogModel::canFetchMore( const QModelIndex& parent ) const
+{
+   return parent.isValid() && item( parent )->canFetchChildren();
+}
+
+
+void VgLogModel::fetchMore( const QModelIndex& parent )
+{
+   if ( parent.isValid() ) {
+      item( parent )->fetchChildren();
+   }
+}
+
+
+/*!
+  Items going into the model: see VgOutputItem::insertChildren()
+*/
+void VgLogModel::beginInsertItems( VgOutputItem* parent, int first, int last )
+{
+   beginInsertRows( indexOf( parent ), first, last );
+}
+
+void VgLogModel::endInsertItems()
+{
+   endInsertRows();
+}
+
+
+/*!
+  An item's text etc has changed
+*/
+void VgLogModel::itemChanged( VgOutputItem* item )
+{
+   QModelIndex idx = indexOf( item );
+   emit dataChanged( idx, idx );
+}
+
+
+/*!
+  Any or all of the children have changed: one signal for the lot,
+  so the view repaints once, rather than looking up each row.
+*/
+void VgLogModel::childrenChanged( VgOutputItem* parent )
+{
+   int n = parent->childCount();
+   if ( n == 0 ) {
+      return;
+   }
+   QModelIndex par = indexOf( parent );
+   emit dataChanged( index( 0, 0, par ), index( n - 1, 0, par ) );
+}
+
+
+/*!
+  The item wants to be shown open: see VgOutputItem::openChildren()
+*/
+void VgLogModel::openItem( VgOutputItem* item )
+{
+   vk_assert( item != root );
+   emit itemOpened( indexOf( item ) );
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+** VgLogModel definition
+**  - item model over the VgOutputItems of the tool-logviews
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_VGLOGMODEL_H
+#define __VK_VGLOGMODEL_H
+
+#include <QAbstractItemModel>
+#include <QModelIndex>
+#include <QVariant>
+
+
+// ============================================================
+// Forward decls
+class VgOutputItem;
+
+
+// ============================================================
+/*!
+  VgLogModel: what a tool's QTreeView shows
+
+   - The items are the VgOutputItems built by the VgLogViews: a tree of
+     plain objects, with one top-level TopStatusItem per log.
+
+   - Items keep no view data: text, fonts etc are made up by the
+     item when the view asks for them, and only for the rows on
+     screen. With uniform row heights, the view never has to ask for
+     the rest: a million errors scroll as well as a hundred.
+
+   - Children are set up on demand, when the view fetches them
+     (canFetchMore(), fetchMore()), or an item opens them itself:
+     see VgOutputItem::openChildren().
+*/
+class VgLogModel : public QAbstractItemModel
+{
+   Q_OBJECT
+public:
+   VgLogModel( QObject* parent );
+   ~VgLogModel();
+
+   void clear();
+
+   VgOutputItem* rootItem();     // parent of the top-level items
+   VgOutputItem* item( const QModelIndex& index ) const;
+   QModelIndex indexOf( VgOutputItem* item ) const;
+
+   // QAbstractItemModel
+   QModelIndex index( int row, int column,
+                      const QModelIndex& parent = QModelIndex() ) const;
+   QModelIndex parent( const QModelIndex& index ) const;
+   int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+   int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+   bool hasChildren( const QModelIndex& parent = QModelIndex() ) const;
+   QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+   Qt::ItemFlags flags( const QModelIndex& index ) const;
+   bool canFetchMore( const QModelIndex& parent ) const;
+   void fetchMore( const QModelIndex& parent );
+
+   // for VgOutputItem: keep the views up to date
+   void beginInsertItems( VgOutputItem* parent, int first, int last );
+   void endInsertItems();
+   void itemChanged( VgOutputItem* item );
+   void childrenChanged( VgOutputItem* parent );
+   void openItem( VgOutputItem* item );
+
+signals:
+   void itemOpened( const QModelIndex& index );   // show it expanded
+
+private:
+   VgOutputItem* root;
+};
+
+#endif // #ifndef __VK_VGLOGMODEL_H
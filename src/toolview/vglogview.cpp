@@ -1,6 +1,6 @@
 /****************************************************************************
 ** VgLogView implementation
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -19,12 +19,17 @@
 ****************************************************************************/
 
 #include "toolview/vglogview.h"
+#include "toolview/vggroupmodel.h"
 #include "utils/vk_utils.h"
 #include "utils/vk_config.h"
 
+#include <QBrush>
+#include <QColor>
 #include <QFileInfo>
+#include <QFont>
 #include <QStringList>
 #include <QTextStream>
+#include <QXmlStreamWriter>
 
 #include <QtGlobal>
 #if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
@@ -34,80 +39,25 @@
 
 // ============================================================
 /*!
-  static map (tagname->enum) + access functions
-*/
-static ElemTypeMap setupElemTypeMap()
-{
-   ElemTypeMap etmap;
-   etmap["valgrindoutput"]   = VG_ELEM::ROOT;
-   etmap["protocolversion"]  = VG_ELEM::PROTOCOL_VERSION;
-   etmap["protocoltool"]     = VG_ELEM::PROTOCOL_TOOL;
-   etmap["preamble"]         = VG_ELEM::PREAMBLE;
-   etmap["pid"]              = VG_ELEM::PID;
-   etmap["ppid"]             = VG_ELEM::PPID;
-   etmap["tool"]             = VG_ELEM::TOOL;
-   etmap["logfilequalifier"] = VG_ELEM::LOGQUAL;
-   etmap["var"]              = VG_ELEM::VAR;
-   etmap["value"]            = VG_ELEM::VALUE;
-   etmap["usercomment"]      = VG_ELEM::COMMENT;
-   etmap["args"]             = VG_ELEM::ARGS;
-   etmap["vargv"]            = VG_ELEM::VARGV;
-   etmap["argv"]             = VG_ELEM::ARGV;
-   etmap["exe"]              = VG_ELEM::EXE;
-   etmap["arg"]              = VG_ELEM::ARG;
-   etmap["status"]           = VG_ELEM::STATUS;
-   etmap["state"]            = VG_ELEM::STATE;
-   etmap["time"]             = VG_ELEM::TIME;
-   etmap["error"]            = VG_ELEM::ERROR;
-   etmap["unique"]           = VG_ELEM::UNIQUE;
-   etmap["tid"]              = VG_ELEM::TID;
-   etmap["kind"]             = VG_ELEM::KIND;
-   etmap["what"]             = VG_ELEM::WHAT;
-   etmap["xwhat"]            = VG_ELEM::XWHAT;
-   etmap["text"]             = VG_ELEM::TEXT;
-   etmap["stack"]            = VG_ELEM::STACK;
-   etmap["frame"]            = VG_ELEM::FRAME;
-   etmap["ip"]               = VG_ELEM::IP;
-   etmap["obj"]              = VG_ELEM::OBJ;
-   etmap["fn"]               = VG_ELEM::FN;
-   etmap["dir"]              = VG_ELEM::SRCDIR;
-   etmap["file"]             = VG_ELEM::SRCFILE;
-   etmap["line"]             = VG_ELEM::LINE;
-   etmap["auxwhat"]          = VG_ELEM::AUXWHAT;
-   etmap["xauxwhat"]         = VG_ELEM::XAUXWHAT;
-   etmap["announcethread"]   = VG_ELEM::ANNOUNCETHREAD;
-   etmap["hthreadid"]        = VG_ELEM::HTHREADID;
-   etmap["errorcounts"]      = VG_ELEM::ERRORCOUNTS;
-   etmap["pair"]             = VG_ELEM::PAIR;
-   etmap["count"]            = VG_ELEM::COUNT;
-   etmap["suppcounts"]       = VG_ELEM::SUPPCOUNTS;
-   etmap["name"]             = VG_ELEM::NAME;
-   etmap["leakedbytes"]      = VG_ELEM::LEAKEDBYTES;
-   etmap["leakedblocks"]     = VG_ELEM::LEAKEDBLOCKS;
-   etmap["suppression"]      = VG_ELEM::SUPPRESSION;
-   etmap["sname"]            = VG_ELEM::SNAME;
-   etmap["skind"]            = VG_ELEM::SKIND;
-   etmap["skaux"]            = VG_ELEM::SKAUX;
-   etmap["sframe"]           = VG_ELEM::SFRAME;
-   etmap["rawtext"]          = VG_ELEM::RAWTEXT;
-   etmap["fatal_signal"]     = VG_ELEM::FATAL_SIGNAL;
-   return etmap;
-}
-
-ElemTypeMap VgOutputItem::elemtypeMap = setupElemTypeMap();
-
-/*!
-  static access function to static map data
+  static access function: tagname->enum
 */
 VG_ELEM::ElemType VgOutputItem::elemType( QString tagName )
 {
-   ElemTypeMap::Iterator it = elemtypeMap.find( tagName );
+   VG_ELEM::ElemType type =
+      VG_ELEM::elemType( tagName.unicode(), tagName.size() );
 
-   if ( it == elemtypeMap.end() ) {
+   if ( type == VG_ELEM::NUM_ELEMS ) {
       VK_DEBUG( "Element not found: '%s'", qPrintable( tagName ) );
-      return VG_ELEM::NUM_ELEMS;
    }
-   return it.value();
+   return type;
+}
+
+/*!
+  static access function: enum->tagname
+*/
+QString VgOutputItem::elemName( VG_ELEM::ElemType type )
+{
+   return QString::fromLatin1( VG_ELEM::elemName( type ) );
 }
 
 /*!
@@ -115,7 +65,7 @@ VG_ELEM::ElemType VgOutputItem::elemType( QString tagName )
 */
 VG_ELEM::ElemType VgOutputItem::elemType()
 {
-   return elemType( elem.tagName() );
+   return etype;
 }
 
 
@@ -124,69 +74,190 @@ VG_ELEM::ElemType VgOutputItem::elemType()
 /*!
   base class for SrcItem and OutputItem
 */
-VgOutputItem::VgOutputItem( QTreeWidget* parent, QDomElement el )
-   : QTreeWidgetItem( parent ), elem( el )
+VgOutputItem::VgOutputItem( VgOutputItem* parent, VG_ELEM::ElemType et )
+   : etype( et )
 {
-   initialise();
+   initialise( parent, parent ? parent->child( parent->childCount() - 1 ) : 0 );
 }
 
-VgOutputItem::VgOutputItem( QTreeWidgetItem* parent, QDomElement el )
-   : QTreeWidgetItem( parent ), elem( el )
+VgOutputItem::VgOutputItem( VgOutputItem* parent, VgOutputItem* after,
+                            VG_ELEM::ElemType et )
+   : etype( et )
 {
-   initialise();
+   initialise( parent, after );
 }
 
-VgOutputItem::VgOutputItem( QTreeWidgetItem* parent, QTreeWidgetItem* after,
-                            QDomElement el )
-   : QTreeWidgetItem( parent, after ), elem( el )
+void VgOutputItem::initialise( VgOutputItem* parent, VgOutputItem* after )
 {
-   initialise();
+   isReadable = isWriteable = false;
+   isExpandable = false;
+   parentItem = 0;
+   rowIdx = 0;
+   fetched = false;
+
+   if ( parent != 0 ) {
+      QList<VgOutputItem*> items;
+      items.append( this );
+      parent->insertChildren( parent->indexOfChild( after ) + 1, items );
+   }
 }
 
-void VgOutputItem::initialise()
+VgOutputItem::~VgOutputItem()
 {
-   isReadable = isWriteable = false;
-   isExpandable = false;
+   qDeleteAll( children );
+}
+
+void VgOutputItem::setText( QString s )
+{
+   str = s;
 }
 
-void VgOutputItem::setText( QString str )
+QString VgOutputItem::text()
 {
-   QTreeWidgetItem::setText( 0, str );
+   return str;
+}
+
+/*!
+  data for the view: see VgLogModel::data()
+   - default: just the item text
+*/
+QVariant VgOutputItem::data( int role )
+{
+   if ( role == Qt::DisplayRole ) {
+      return text();
+   }
+   return QVariant();
 }
 
 VgOutputItem* VgOutputItem::firstChild()
 {
-   return ( VgOutputItem* )QTreeWidgetItem::child( 0 );
+   return child( 0 );
 }
 
+/*!
+  top-level items are the root's children: but we keep that to ourselves
+*/
 VgOutputItem* VgOutputItem::parent()
 {
-   return ( VgOutputItem* )QTreeWidgetItem::parent();
+   if ( parentItem == 0 || parentItem->parentItem == 0 ) {
+      return 0;
+   }
+   return parentItem;
 }
 
+VgOutputItem* VgOutputItem::child( int idx )
+{
+   return ( idx >= 0 && idx < children.count() ) ? children.at( idx ) : 0;
+}
 
-/*!
-  Setup children of this item.
-  Derived items use this to load children from the model on demand.
-  Rem to call this base class version at the end of derived methods,
-  in order to finish initialisation of children.
+int VgOutputItem::childCount()
+{
+   return children.count();
+}
+
+int VgOutputItem::indexOfChild( VgOutputItem* item )
+{
+   return ( item != 0 && item->parentItem == this ) ? item->rowIdx : -1;
+}
+
+int VgOutputItem::row()
+{
+   return rowIdx;
+}
 
-  Ideally, we'd have overloaded QWidgetTreeItem::setExpanded(),
-  but it's no longer virtual in Qt4 :-(
+
+/*!
+  Put the (parentless) items in as our children, from idx on
+   - one model update for the lot.
+   - each item keeps its row: only those after idx need renumbering,
+     and new items mostly go in last.
 */
-void VgOutputItem::openChildren()
+void VgOutputItem::insertChildren( int idx, const QList<VgOutputItem*>& items )
 {
-   if ( parent() == 0 ) {
-      // Top-level item: no init needed.
+   if ( items.isEmpty() ) {
       return;
    }
+   vk_assert( idx >= 0 && idx <= children.count() );
+
+   VgLogModel* mdl = model();
+   if ( mdl ) {
+      mdl->beginInsertItems( this, idx, idx + items.count() - 1 );
+   }
+
+   if ( idx == children.count() ) {
+      children += items;
+   }
+   else {
+      for ( int i=0; i<items.count(); ++i ) {
+         children.insert( idx + i, items.at( i ) );
+      }
+   }
+   for ( int i=idx; i<children.count(); ++i ) {
+      children.at( i )->parentItem = this;
+      children.at( i )->rowIdx = i;
+   }
+
+   if ( mdl ) {
+      mdl->endInsertItems();
+   }
+}
+
 
-   // load children (overloaded by each item)
+/*!
+  Setup children of this item, once.
+  Derived items load their children from the record data on demand.
+   - the model calls this when the view first opens the item.
+*/
+void VgOutputItem::fetchChildren()
+{
+   if ( fetched ) {
+      return;
+   }
+   fetched = true;
    setupChildren();
+}
+
+bool VgOutputItem::canFetchChildren()
+{
+   return isExpandable && !fetched;
+}
+
+
+/*!
+  Setup children of this item, and have the view show it open.
+   - e.g. for an error's stack: shown open, along with the error.
+
+  Note: opening is up to the view: see VgLogModel::itemOpened().
+*/
+void VgOutputItem::openChildren()
+{
+   fetchChildren();
+
+   VgLogModel* mdl = model();
+   if ( mdl ) {
+      mdl->openItem( this );
+   }
+}
+
+
+/*!
+  the model, from the root item: 0 if we're not in one (yet)
+*/
+VgLogModel* VgOutputItem::model()
+{
+   VgOutputItem* top = this;
+   while ( top->parentItem != 0 ) {
+      top = top->parentItem;
+   }
+   return top->logModel();
+}
 
-   // now we've loaded any child items from the model,
-   // we can open the item without jitter.
-   this->setExpanded( true );
+void VgOutputItem::changed()
+{
+   VgLogModel* mdl = model();
+   if ( mdl ) {
+      mdl->itemChanged( this );
+   }
 }
 
 
@@ -202,8 +273,27 @@ bool VgOutputItem::getIsReadable()
 bool VgOutputItem::getIsWriteable()
 { return isWriteable; }
 
-QDomElement VgOutputItem::getElement()
-{ return elem; }
+
+/*!
+  plain text of the data represented by this item
+   - default: just the item text
+*/
+QString VgOutputItem::toText()
+{
+   return text();
+}
+
+/*!
+  xml of the data represented by this item
+   - default: item text as a single element
+*/
+QString VgOutputItem::toXml()
+{
+   QString xml;
+   QXmlStreamWriter strm( &xml );
+   strm.writeTextElement( elemName( etype ), toText() );
+   return xml;
+}
 
 
 
@@ -212,21 +302,22 @@ QDomElement VgOutputItem::getElement()
 // ============================================================
 /*!
   TopStatus: first item in listview
-  as two text lines:
-  status, client exe
+  as one text line (rows are all of a height):
+  status, client exe,
   errcounts(num_errs), leak_errors(num_bytes++, num_blocks++)
 */
-TopStatusItem::TopStatusItem( QTreeWidget* parent, QDomElement exe,
-                              QDomElement status, QString toolstatus,
+TopStatusItem::TopStatusItem( VgLogModel* model, QString exe,
+                              const VgStatus& status, QString toolstatus,
                               QString _protocol )
-   : VgOutputItem( parent, exe ),
+   : VgOutputItem( model->rootItem(), VG_ELEM::STATUS ),
      toolstatus_str( toolstatus ), num_errs( 0 ),
-     time_str(), protocol( _protocol )
+     textHeld( false ), textStale( false ),
+     exe_str( exe ), time_str(), protocol( _protocol )
 {
-   state_str  = status.firstChildElement( "state" ).text();
-   start_time = status.firstChildElement( "time" ).text();
+   state_str  = status.state;
+   start_time = status.time;
 
-   status_tmplt = "Valgrind: %1 '%2'  %3\nErrors: %4%5";
+   status_tmplt = "Valgrind: %1 '%2'  %3   Errors: %4%5%6";
    updateText();
 
    isExpandable = true;
@@ -234,21 +325,29 @@ TopStatusItem::TopStatusItem( QTreeWidget* parent, QDomElement exe,
 
 void TopStatusItem::updateText()
 {
+   if ( textHeld ) {
+      textStale = true;
+      return;
+   }
+   textStale = false;
+
    status_str = status_tmplt
                 .arg( state_str )  // STARTED|FINISHED
-                .arg( QFileInfo( elem.text() ).fileName() )       // exe
+                .arg( QFileInfo( exe_str ).fileName() )           // exe
                 .arg( time_str )                                  // time
                 .arg( num_errs )
-                .arg( toolstatus_str );
+                .arg( toolstatus_str )
+                .arg( memory_str );
 
    setText( status_str );
+   changed();
 }
 
 
 // finished
-void TopStatusItem::updateStatus( QDomElement status )
+void TopStatusItem::updateStatus( const VgStatus& status )
 {
-   state_str = status.firstChildElement( "state" ).text();
+   state_str = status.state;
 
    int sday, shours, smins, ssecs, smsecs;
    int eday, ehours, emins, esecs, emsecs;
@@ -269,7 +368,7 @@ void TopStatusItem::updateStatus( QDomElement status )
                  &sday, &shours, &smins, &ssecs, &smsecs );
 
    if ( ret == 5 ) {
-      QString end_time = status.firstChildElement( "time" ).text();
+      QString end_time = status.time;
       ret = sscanf( end_time.toUtf8().constData(), "%d:%d:%d:%d.%4d",
                     &eday, &ehours, &emins, &esecs, &emsecs );
 
@@ -309,22 +408,63 @@ void TopStatusItem::updateStatus( QDomElement status )
    }
 }
 
-void TopStatusItem::updateFromErrorCounts( QDomElement errcnts )
+void TopStatusItem::updateFromErrorCounts( const VgCounts& errcnts )
 {
    // sum all counts in all pairs of errorcounts
    num_errs = 0;
-   QDomNodeList pairs = errcnts.childNodes();
-   QDomElement e = pairs.item( 0 ).toElement();
+   foreach( const VgCountPair& pair, errcnts ) {
+      num_errs += pair.count;
+   }
+
+   updateText();
+}
 
-   for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-      QString count = e.firstChildElement().text();
-      num_errs += count.toInt();
+
+/*!
+  Memory held by the log's errors, against its budget
+   - shown once any have been spilled, or we're over budget.
+*/
+void TopStatusItem::setMemoryUse( qint64 resident, qint64 spilled,
+                                  qint64 budget )
+{
+   if ( spilled <= 0 && resident <= budget ) {
+      return;
    }
 
+   memory_str = "   Memory: " +
+                QString::number( resident / 1048576.0, 'f', 1 ) + " MB resident, " +
+                QString::number( spilled / 1048576.0, 'f', 1 ) + " MB spilled";
+   if ( resident > budget ) {
+      memory_str += " (over the " +
+                    QString::number( budget / 1048576.0, 'f', 0 ) + " MB budget)";
+   }
    updateText();
 }
 
 
+/*!
+  The log's errors, as columns: see VgErrorStore
+   - here, as it lives as long as the error items: not the VgLogView.
+*/
+VgErrorStore* TopStatusItem::errorStore()
+{
+   return &store;
+}
+
+
+/*!
+  Put off text updates till released: e.g. while adding a batch of
+  errors, which would otherwise reformat the text once each.
+*/
+void TopStatusItem::holdText( bool hold )
+{
+   textHeld = hold;
+   if ( !hold && textStale ) {
+      updateText();
+   }
+}
+
+
 
 
 // ============================================================
@@ -339,19 +479,19 @@ void TopStatusItem::updateFromErrorCounts( QDomElement errcnts )
    - args
    - details: as text lines
 */
-InfoItem::InfoItem( VgOutputItem* parent, QDomElement root /*element:ROOT*/ )
-   : VgOutputItem( parent, root )
+InfoItem::InfoItem( VgOutputItem* parent, const VgLogInfo& info )
+   : VgOutputItem( parent, VG_ELEM::ROOT ), loginfo( info )
 {
-   QString tool = elem.firstChildElement( "tool" ).text();
-   tool[0] = tool[0].toUpper();
-   QString pid = elem.firstChildElement( "pid" ).text();
-   QString ppid = elem.firstChildElement( "ppid" ).text();
+   QString tool = loginfo.tool;
+   if ( !tool.isEmpty() ) {
+      tool[0] = tool[0].toUpper();
+   }
 
    QString content =
       QString( "%1 output for process id ==%2== (parent pid ==%3==)" )
       .arg( tool )
-      .arg( pid )
-      .arg( ppid );
+      .arg( loginfo.pid )
+      .arg( loginfo.ppid );
 
    setText( content );
 
@@ -364,23 +504,21 @@ void InfoItem::setupChildren()
       VgOutputItem* last_item = 0;
 
       // handle any number of log-file-qualifiers
-      QDomElement logqual = elem.firstChildElement( "logfilequalifier" );
-      while ( !logqual.isNull() && logqual.tagName() == "logfilequalifier" ) {
-         last_item = new LogQualItem( this, logqual );
+      for ( int i=0; i<loginfo.logQuals.count(); ++i ) {
+         last_item = new LogQualItem( this, last_item,
+                                      loginfo.logQuals.at( i ).first,
+                                      loginfo.logQuals.at( i ).second );
          last_item->openChildren();
-         logqual = logqual.nextSiblingElement();
       }
 
       // may / may not have a user comment
-      QDomElement comment = elem.firstChildElement( "usercomment" );
-      if ( ! comment.isNull() ) {
-         last_item = new VgOutputItem( this, last_item, comment );
-         last_item->setText( comment.text() );
+      if ( ! loginfo.userComment.isEmpty() ) {
+         last_item = new VgOutputItem( this, last_item, VG_ELEM::COMMENT );
+         last_item->setText( loginfo.userComment );
       }
 
       // args
-      QDomElement args = elem.firstChildElement( "args" );
-      last_item = new ArgsItem( this, last_item, args );
+      last_item = new ArgsItem( this, last_item, loginfo.vargv, loginfo.argv );
       last_item->openChildren();
    }
 }
@@ -391,8 +529,10 @@ void InfoItem::setupChildren()
 /*!
   LogQualItem
 */
-LogQualItem::LogQualItem( VgOutputItem* parent, QDomElement logqual )
-   : VgOutputItem( parent, logqual )
+LogQualItem::LogQualItem( VgOutputItem* parent, VgOutputItem* after,
+                          QString var, QString value )
+   : VgOutputItem( parent, after, VG_ELEM::LOGQUAL ),
+     var_str( var ), value_str( value )
 {
    setText( "logfilequalifier" );
 
@@ -403,21 +543,8 @@ void LogQualItem::setupChildren()
 {
    if ( childCount() == 0 ) {
       VgOutputItem* last_item = 0;
-      QDomElement var   = elem.firstChildElement();
-      QDomElement value = var.nextSiblingElement();
-#ifdef DEBUG_ON
-      if ( var.tagName() != "var" ) {
-         vkPrintErr( "LogQualItem::setupChildren(): unexpected tagName: %s",
-                     qPrintable( var.tagName() ) );
-      }
-      if ( value.tagName() != "value" ) {
-         vkPrintErr( "LogQualItem::setupChildren(): unexpected tagName: %s",
-                     qPrintable( value.tagName() ) );
-      }
-#endif
-
-      last_item = new VgOutputItem( this, last_item, var );
-      last_item->setText( var.text() + ": '" + value.text() + "'" );
+      last_item = new VgOutputItem( this, last_item, VG_ELEM::VAR );
+      last_item->setText( var_str + ": '" + value_str + "'" );
    }
 }
 
@@ -427,9 +554,10 @@ void LogQualItem::setupChildren()
 /*!
   ArgsItem
 */
-ArgsItem::ArgsItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                    QDomElement args )
-   : VgOutputItem( parent, after, args )
+ArgsItem::ArgsItem( VgOutputItem* parent, VgOutputItem* after,
+                    QStringList vargv, QStringList argv )
+   : VgOutputItem( parent, after, VG_ELEM::ARGS ),
+     vg_args( vargv ), exe_args( argv )
 {
    setText( "args" );
    isExpandable = true;
@@ -438,32 +566,19 @@ ArgsItem::ArgsItem( VgOutputItem* parent, QTreeWidgetItem* after,
 void ArgsItem::setupChildren()
 {
    if ( childCount() == 0 ) {
-      QDomElement vgInfo = elem.firstChildElement( "vargv" );
-      QDomElement exInfo = elem.firstChildElement( "argv" );
-
       VgOutputItem* last_item = 0;
-      QDomElement e = vgInfo.firstChildElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-#ifdef DEBUG_ON
-         if ( e.tagName() != "exe" && e.tagName() != "arg" ) {
-            vkPrintErr( "ArgsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
-         }
-#endif
-         last_item = new VgOutputItem( this, last_item, e );
-         last_item->setText( e.text() );
+
+      // first of each list is the exe, the rest are args
+      for ( int i=0; i<vg_args.count(); ++i ) {
+         last_item = new VgOutputItem( this, last_item,
+                                       ( i == 0 ) ? VG_ELEM::EXE : VG_ELEM::ARG );
+         last_item->setText( vg_args.at( i ) );
       }
 
-      e = exInfo.firstChildElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-#ifdef DEBUG_ON
-         if ( e.tagName() != "exe" && e.tagName() != "arg" ) {
-            vkPrintErr( "ArgsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
-         }
-#endif
-         last_item = new VgOutputItem( this, last_item, e );
-         last_item->setText( e.text() );
+      for ( int i=0; i<exe_args.count(); ++i ) {
+         last_item = new VgOutputItem( this, last_item,
+                                       ( i == 0 ) ? VG_ELEM::EXE : VG_ELEM::ARG );
+         last_item->setText( exe_args.at( i ) );
       }
    }
 }
@@ -477,9 +592,9 @@ void ArgsItem::setupChildren()
    - lines: as text lines
 */
 PreambleItem::PreambleItem( VgOutputItem* parent,
-                            QTreeWidgetItem* after,
-                            QDomElement preamble )
-   : VgOutputItem( parent, after, preamble )
+                            VgOutputItem* after,
+                            QStringList preamble )
+   : VgOutputItem( parent, after, VG_ELEM::PREAMBLE ), lines( preamble )
 {
    setText( "Preamble" );
    isExpandable = true;
@@ -489,85 +604,97 @@ void PreambleItem::setupChildren()
 {
    if ( childCount() == 0 ) {
       VgOutputItem* last_item = 0;
-      QDomElement e = elem.firstChildElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-#ifdef DEBUG_ON
-         if ( e.tagName() != "line" ) {
-            vkPrintErr( "PreambleItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
-         }
-#endif
-         last_item = new VgOutputItem( this, last_item, e );
-         last_item->setText( e.text() );
+      foreach( const QString& line, lines ) {
+         last_item = new VgOutputItem( this, last_item, VG_ELEM::LINE );
+         last_item->setText( line );
       }
    }
 }
 
 
 
+// ============================================================
+/*!
+  WhatItem
+*/
+WhatItem::WhatItem( VgOutputItem* parent, VgOutputItem* after,
+                    VG_ELEM::ElemType et, QString what )
+   : VgOutputItem( parent, after, et )
+{
+   setText( what );
+}
+
+QVariant WhatItem::data( int role )
+{
+   if ( role == Qt::FontRole ) {
+      // just these: the rest is the view's font
+      QFont fnt;
+      fnt.setWeight( QFont::DemiBold );
+      fnt.setItalic( true );
+      return fnt;
+   }
+   return VgOutputItem::data( role );
+}
+
+
+
 // ============================================================
 /*!
   ErrorItem
 */
-ErrorItem::ErrorItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                      QDomElement err, ErrorItem::AcronymMap acnymMap )//, QString acnym )
-   : VgOutputItem( parent, after, err )
+ErrorItem::ErrorItem( VgOutputItem* parent, VgOutputItem* after,
+                      const VgError& err, ErrorItem::AcronymMap acnymMap )
+   : VgOutputItem( parent, after, VG_ELEM::ERROR ), error( err ),
+     errStore( 0 ), errRow( -1 ), hasDetails( true ), logView( 0 )
 {
    fullSrcPathShown = false;
    isExpandable = true;
 
-   // unclear what we can expect re what/xwhat.
-   //  - give 'what' preference over 'xwhat'.
-   QString description;
-   QDomElement what = elem.firstChildElement( "what" );
-   QDomElement xwhat = elem.firstChildElement( "xwhat" );
-   if ( !what.isNull() ) {
-      description = what.text();
+   acronym = getErrorAcronym( acnymMap, error.kind );
+}
+
+void ErrorItem::updateCount( int count )
+{
+   if ( errStore ) {
+      errStore->setErrorCount( errRow, count );
    }
-   else {
-      QDomElement text = xwhat.firstChildElement( "text" );
-      description = text.text();
-   }
-
-   QString kind = elem.firstChildElement( "kind" ).text();
-   QString acnym = getErrorAcronym( acnymMap, kind );
-
-   err_tmplt  = acnym + " [%1]: " + description;
-   updateCount( "1" );
-
-   // Store suppression for later use
-   QDomElement supp = elem.firstChildElement( "suppression" );
-   if ( !supp.isNull() ) {
-      // Qt has killed the <rawtext> newlines, so convert xml to text
-      QTextStream strm(&str_supp);
-
-      QDomElement snameEl = supp.firstChildElement( "sname" );
-      if ( !snameEl.isNull() )
-         strm << snameEl.text();
-      QDomElement skindEl = supp.firstChildElement( "skind" );
-      if ( !skindEl.isNull() )
-         strm << endl << skindEl.text();
-      QDomElement skauxEl = supp.firstChildElement( "skaux" );
-      if ( !skauxEl.isNull() )
-         strm << endl << skauxEl.text();
-
-      QDomElement sframeEl = supp.firstChildElement( "sframe" );
-      for ( ; !sframeEl.isNull();
-              sframeEl = sframeEl.nextSiblingElement("sframe") ) {
-         QDomElement objEl = sframeEl.firstChildElement( "obj" );
-         if ( !objEl.isNull() )
-            strm << endl << "obj:" << objEl.text();
-         QDomElement funEl = sframeEl.firstChildElement( "fun" );
-         if ( !funEl.isNull() )
-            strm << endl << "fun:" << funEl.text();
-      }
+}
+
+int ErrorItem::getCount()
+{
+   return errStore ? errStore->errorCount( errRow ) : 1;
+}
+
+/*!
+  The store has our stacks from now on: we keep the rest
+*/
+void ErrorItem::setStoreRow( VgErrorStore* store, int row )
+{
+   errStore = store;
+   errRow = row;
+   if ( errStore ) {
+      error.stacks = QVector<VgStack>();
    }
 }
 
-void ErrorItem::updateCount( QString count )
+int ErrorItem::storeRow()
+{
+   return errStore ? errRow : -1;
+}
+
+VgErrorStore* ErrorItem::getStore()
+{
+   return errStore;
+}
+
+/*!
+  made up as shown: no text kept per error
+   - error.what: 'what' given preference over 'xwhat' by the reader.
+*/
+QString ErrorItem::text()
 {
 //TODO: perhaps only print [count] if >1 ?
-   setText( err_tmplt.arg( count ) );
+   return acronym + " [" + QString::number( getCount() ) + "]: " + error.what;
 }
 
 void ErrorItem::setupChildren()
@@ -575,80 +702,54 @@ void ErrorItem::setupChildren()
    if ( childCount() == 0 ) {
       VgOutputItem* last_item = this;  // for listview ordering.
 
-      // iterate over all child dom elements
-      QDomElement e = elem.firstChildElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-         VG_ELEM::ElemType elemtype = VgOutputItem::elemType( e.tagName() );
-
-         switch ( elemtype ) {
-         case VG_ELEM::UNIQUE:
-         case VG_ELEM::KIND:
-            // ignore.
-            break;
+      // shown: keep the details while we have the children
+      //  - unless spilled: they're over budget, and the children
+      //    have copies of their own anyway.
+      //  - kept, they're in the view's budget: may be spilled again.
+      if ( !hasDetails && spill.isNull() && readDetails( error ) ) {
+         hasDetails = true;
+         if ( logView ) {
+            logView->detailsKept( this );
+         }
+      }
+      VgError err = getErrorDetails();
 
+      // iterate over all error parts, in log order
+      foreach( const VgErrorPart& part, err.parts ) {
+         switch ( part.type ) {
          case VG_ELEM::TID: {
-            last_item = new VgOutputItem( this, last_item, e );
-            last_item->setText( "Thread Id: " + e.text() );
+            last_item = new VgOutputItem( this, last_item, VG_ELEM::TID );
+            last_item->setText( "Thread Id: " + part.text );
             break;
          }
 
          case VG_ELEM::WHAT:
-         case VG_ELEM::AUXWHAT: {
-            //Note: (xml-output.txt, 1Mar2008): Some errors may have two <auxwhat>
-            // blocks, rather than just one, resulting from DATASYMS branch merge.
-            VgOutputItem* item = new VgOutputItem( this, last_item, e );
-            item->setText( e.text() );
-
-            QFont fnt = item->font( 0 );
-            fnt.setWeight( QFont::DemiBold );
-            fnt.setItalic( true );
-            item->setFont( 0, fnt );
-
-            last_item = item;
-            break;
-         }
-
+         case VG_ELEM::AUXWHAT:
          case VG_ELEM::XWHAT:
          case VG_ELEM::XAUXWHAT: {
-            QDomElement zwhat = e;
-
-            // All XWHAT/XAUXWHAT's have a text element: print it
-            QDomElement text = zwhat.firstChildElement();
-      #ifdef DEBUG_ON
-            if ( text.tagName() != "text" ) {
-               vkPrintErr( "ErrorItemHG::setupChildrenPerTool(): unexpected"
-                           " tagName within %s: %s", qPrintable( zwhat.tagName() ),
-                           qPrintable( text.tagName() ) );
-            }
-      #endif
-            last_item = new VgOutputItem( this, last_item, text );
-            last_item->setText( text.text() );
-
-            QFont fnt = last_item->font( 0 );
-            fnt.setWeight( QFont::DemiBold );
-            fnt.setItalic( true );
-            last_item->setFont( 0, fnt );
-
-            // Ignore further XWHAT/XAUXWHAT children elements here:
-            // they are used elsewhere, e.g. for updating TopStatus.
+            //Note: (xml-output.txt, 1Mar2008): Some errors may have two <auxwhat>
+            // blocks, rather than just one, resulting from DATASYMS branch merge.
+            // All XWHAT/XAUXWHAT's have a text element: that's what we print.
+            // Further XWHAT/XAUXWHAT children are used elsewhere,
+            // e.g. for updating TopStatus.
+            bool isX = ( part.type == VG_ELEM::XWHAT ||
+                         part.type == VG_ELEM::XAUXWHAT );
+            last_item = new WhatItem( this, last_item,
+                                      isX ? VG_ELEM::TEXT : part.type, part.text );
             break;
          }
 
          case VG_ELEM::STACK: {
-            VgOutputItem* stack = new StackItem( this, last_item, e );
+            VgOutputItem* stack =
+               new StackItem( this, last_item, err.stacks.at( part.stack ) );
             stack->openChildren();
             last_item = stack;
             break;
          }
 
-         case VG_ELEM::SUPPRESSION: {
-            // don't display this here.
-            break;
-         }
-
          default:
-            vkPrintErr( "ErrorItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
+            vkPrintErr( "ErrorItem::setupChildren(): unexpected element: %s",
+                        qPrintable( elemName( part.type ) ) );
             break;
          }
       }
@@ -674,18 +775,22 @@ QString ErrorItem::getErrorAcronym( ErrorItem::AcronymMap map,
 */
 void ErrorItem::showFullSrcPath( bool show )
 {
+   VgLogModel* mdl = model();
+
    // (maybe) multiple stacks
    for ( int i=0; i<childCount(); ++i ) {
-      StackItem* stack = (StackItem*)child( i );
+      VgOutputItem* stack = child( i );
       if ( stack->elemType() == VG_ELEM::STACK ) {
          // multiple frames
          for ( int i=0; i<stack->childCount(); ++i ) {
-            VgOutputItem* item = (VgOutputItem*)stack->child( i );
+            VgOutputItem* item = stack->child( i );
             if ( item->elemType() == VG_ELEM::FRAME ) {
-               QString text = ((FrameItem*)item)->describe_IP( show );
-               item->setText( text );
+               ((FrameItem*)item)->showFullSrcPath( show );
             }
          }
+         if ( mdl ) {
+            mdl->childrenChanged( stack );
+         }
       }
    }
 
@@ -705,7 +810,125 @@ bool ErrorItem::isFullSrcPathShown()
 */
 QString ErrorItem::getSuppressionStr()
 {
-   return str_supp;
+   return getErrorDetails().suppression;
+}
+
+/*!
+  getter: getError()
+   - in lazy mode, or once spilled, only the summary fields are valid
+     (unique, tid, kind, what, leak bytes/blocks): see getErrorDetails()
+   - once in the store, it has no stacks: likewise.
+*/
+const VgError& ErrorItem::getError()
+{
+   return error;
+}
+
+/*!
+  The complete error
+   - in lazy mode, re-read from the log if we don't have it,
+     without keeping it: memory stays flat over filter passes etc.
+*/
+VgError ErrorItem::getErrorDetails()
+{
+   if ( hasDetails ) {
+      return withStacks( error );
+   }
+
+   VgError err;
+   if ( !readDetails( err ) ) {
+      return withStacks( error );
+   }
+   return withStacks( err );
+}
+
+/*!
+  err, with its stacks from the store if it's not got them
+   - re-read from the log, it has: spilled, or kept by us, it hasn't.
+*/
+VgError ErrorItem::withStacks( const VgError& err )
+{
+   if ( !errStore || !err.stacks.isEmpty() ) {
+      return err;
+   }
+
+   VgError res = err;
+   int n = errStore->stackCount( errRow );
+   res.stacks.reserve( n );
+   for ( int i=0; i<n; ++i ) {
+      res.stacks.append( errStore->stack( errRow, i ) );
+   }
+   return res;
+}
+
+/*!
+  Lazy mode: drop the details, we'll re-read them from src if needed
+*/
+void ErrorItem::setLazy( QSharedPointer<VgLogSource> src, const VgLogRange& rng,
+                         VgLogView* view )
+{
+   if ( src.isNull() || !rng.isValid() || childCount() != 0 ) {
+      return;
+   }
+
+   source = src;
+   range = rng;
+   logView = view;
+   error = error.summary();
+   hasDetails = false;
+}
+
+/*!
+  Over budget: move the details out to spl, keeping just the summary
+   - returns the bytes freed: 0 if nothing to spill, or it failed.
+   - spilled errors were fixed up on the way in: no fixupError() on
+     the way back.
+*/
+qint64 ErrorItem::spillDetails( QSharedPointer<VgErrorSpill> spl )
+{
+   if ( spl.isNull() || !hasDetails ) {
+      return 0;
+   }
+
+   VgLogRange rng = spl->writeError( error );
+   if ( !rng.isValid() ) {
+      return 0;
+   }
+
+   qint64 freed = error.detailsBytes();
+   source.clear();
+   spill = spl;
+   range = rng;
+   error = error.summary();
+   hasDetails = false;
+   return freed;
+}
+
+qint64 ErrorItem::detailsBytes()
+{
+   return hasDetails ? error.detailsBytes() : 0;
+}
+
+bool ErrorItem::readDetails( VgError& err )
+{
+   if ( !spill.isNull() ) {
+      return spill->readError( range, err );
+   }
+   if ( source.isNull() || !source->readError( range, err ) ) {
+      return false;
+   }
+   fixupError( err );
+   return true;
+}
+
+QString ErrorItem::toText()
+{
+   return getErrorDetails().toText();
+}
+
+QString ErrorItem::toXml()
+{
+   return getErrorDetails().toXml( elemName( etype ) );
 }
 
 
@@ -714,9 +937,9 @@ QString ErrorItem::getSuppressionStr()
 /*!
   StackItem
 */
-StackItem::StackItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                      QDomElement stck )
-   : VgOutputItem( parent, after, stck )
+StackItem::StackItem( VgOutputItem* parent, VgOutputItem* after,
+                      const VgStack& stck )
+   : VgOutputItem( parent, after, VG_ELEM::STACK ), stack( stck )
 {
    setText( "stack" );
 
@@ -727,17 +950,10 @@ void StackItem::setupChildren()
 {
    if ( childCount() == 0 ) {
       VgOutputItem* last_item = this;
-      QDomElement e = elem.firstChildElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-#ifdef DEBUG_ON
-         if ( e.tagName() != "frame" ) {
-            vkPrintErr( "StackItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
-         }
-#endif
-         last_item = new FrameItem( this, last_item, e );
+      foreach( const VgFrame& frm, stack ) {
+         last_item = new FrameItem( this, last_item, frm );
          // don't open children: just set them up.
-         last_item->setupChildren();
+         last_item->fetchChildren();
       }
    }
 }
@@ -747,24 +963,14 @@ void StackItem::setupChildren()
 /*!
   FrameItem
 */
-FrameItem::FrameItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                      QDomElement frm )
-   : VgOutputItem( parent, after, frm )
+FrameItem::FrameItem( VgOutputItem* parent, VgOutputItem* after,
+                      const VgFrame& frm )
+   : VgOutputItem( parent, after, VG_ELEM::FRAME ), frame( frm ),
+     fullSrcPath( false )
 {
    // check what perms the user has w.r.t. this file
-   QDomElement srcdir  = frm.firstChildElement( "dir" );
-   QDomElement srcfile = frm.firstChildElement( "file" );
-
-   if ( !srcfile.isNull() ) {
-      QString path;
-
-      if ( !srcdir.isNull() ) {
-         path = srcdir.text() + "/";
-      }
-
-      path += srcfile.text();
-
-      QFileInfo fi( path );
+   if ( !frame.file.isEmpty() ) {
+      QFileInfo fi( frame.srcPath() );
 
       if ( fi.exists() && fi.isFile() /* && !fi.isSymLink() */) {
          isReadable  = fi.isReadable();
@@ -772,97 +978,106 @@ FrameItem::FrameItem( VgOutputItem* parent, QTreeWidgetItem* after,
       }
    }
 
-   setText( describe_IP( false ) );
-
    isExpandable = isReadable;
+}
 
-   if ( isExpandable ) {
-      QColor col( "blue" );
-      QBrush brush( col );
-      setForeground( 0, brush );
-   } else {
-      QColor col( "darkred" );
-      QBrush brush( col );
-      setForeground( 0, brush );
+QString FrameItem::text()
+{
+   return frame.describeIP( fullSrcPath );
+}
+
+QVariant FrameItem::data( int role )
+{
+   if ( role == Qt::ForegroundRole ) {
+      QColor col( isExpandable ? "blue" : "darkred" );
+      return QBrush( col );
    }
+   return VgOutputItem::data( role );
 }
 
 
+/*!
+  the src lines around the frame's line, one item each
+*/
 void FrameItem::setupChildren()
 {
    if ( childCount() == 0 && isExpandable ) {
-      QDomElement srcdir  = elem.firstChildElement( "dir" );
-      QDomElement srcfile = elem.firstChildElement( "file" );
-      QDomElement line    = elem.firstChildElement( "line" );
-
-      if ( srcfile.isNull() ) {
+      if ( frame.file.isEmpty() ) {
          return;
       }
 
-      QString path;
-      if ( !srcdir.isNull() ) {
-         path = srcdir.text() + "/";
-      }
-      path += srcfile.text();
+      QString path = frame.srcPath();
       if ( !QFile::exists( path ) ) {
          vkPrintErr( "FrameItem::setupChildren(): can't find source: %s, %s",
-                     qPrintable( srcdir.text() ), qPrintable( srcfile.text() ) );
+                     qPrintable( frame.dir.str() ), qPrintable( frame.file.str() ) );
          return;
       }
 
-      // create the item for the src lines
-      new SrcItem( this, line, path );
-   }
-}
+      int target_line = frame.line;
+      if ( target_line < 0 ) {
+         target_line = 0;
+      }
 
+      // num lines to show above / below the target line
+      bool ok = false;
+      int n_lines = vkCfgProj->value( "valkyrie/src-lines" ).toInt( &ok );
+      if ( !ok ) {
+         vkPrintErr( "FrameItem::setupChildren(): failed to retrieve/convert 'src-lines' from config." );
+      }
 
-/*!
-  ref: coregrind/m_debuginfo/symtab.c :: VG_(describe_IP)
-*/
-QString FrameItem::describe_IP( bool withPath/*=false*/ )
-{
-   QDomNodeList frame_details = elem.childNodes();
-   vk_assert( frame_details.count() >= 1 );  /* only ip guaranteed */
-   QDomElement ip     = elem.firstChildElement( "ip" );
-   QDomElement obj    = elem.firstChildElement( "obj" );
-   QDomElement fn     = elem.firstChildElement( "fn" );
-   QDomElement dir    = elem.firstChildElement( "dir" );
-   QDomElement srcloc = elem.firstChildElement( "file" );
-   QDomElement line   = elem.firstChildElement( "line" );
+      // figure out where to start showing src lines
+      int top_line = 1;
+      if ( target_line > n_lines + 1 ) {
+         top_line = target_line - n_lines;
+      }
+      int bot_line = target_line + n_lines;
+      int current_line = 1;
 
-   bool  know_fnname  = !fn.isNull();
-   bool  know_objname = !obj.isNull();
-   bool  know_srcloc  = !srcloc.isNull() && !line.isNull();
-   bool  know_dirinfo = !dir.isNull();
+      QFile file( path );
+      if ( !file.open( QIODevice::ReadOnly ) ) {
+         return;
+      }
 
-   QString str = ip.text() + ": ";
+      // TODO: faster to set file pos using QFile::at(offset)
+      QTextStream stream( &file );
+      VgOutputItem* last_item = 0;
 
-   if ( know_fnname ) {
-      str += fn.text();
+      while ( !stream.atEnd() && ( current_line <= bot_line ) ) {
+         if ( current_line < top_line ) {
+            stream.readLine();   // skip lines to top_line
+         }
+         else {
+            last_item = new SrcItem( this, last_item, "  " + stream.readLine() );
+         }
 
-      if ( !know_srcloc && know_objname ) {
-         str += " (in " + obj.text() + ")";
+         current_line++;
       }
+
+      file.close();
    }
-   else if ( know_objname && !know_srcloc ) {
-      str += "(within " + obj.text() + ")";
-   }
-   else {
-      str += "???";
-   }
+}
 
-   if ( know_srcloc ) {
-      QString path;
+/*!
+  getter: getFrame()
+*/
+const VgFrame& FrameItem::getFrame()
+{
+   return frame;
+}
 
-      if ( withPath && know_dirinfo ) {
-         path = dir.text() + "/";
-      }
+void FrameItem::showFullSrcPath( bool show )
+{
+   fullSrcPath = show;
+}
 
-      path += srcloc.text();
-      str += " (" + path + ":" + line.text() + ")";
-   }
+QString FrameItem::toText()
+{
+   return frame.describeIP( true );
+}
 
-   return str;
+QString FrameItem::toXml()
+{
+   return frame.toXml();
 }
 
 
@@ -870,78 +1085,42 @@ QString FrameItem::describe_IP( bool withPath/*=false*/ )
 // ============================================================
 /*!
   class SrcItem (error::stack::frame::dir/file/line)
-   - given a valid source file path, display a chunk of the
-     offending file at the given lineno.
+   - given a valid source file path, the frame shows a chunk of the
+     offending file at the given lineno: a line per item.
    - double-click item => source file opened in an editor, at lineno.
 */
-SrcItem::SrcItem( VgOutputItem* parent, QDomElement line, QString path )
-   : VgOutputItem( parent, line )
+SrcItem::SrcItem( VgOutputItem* parent, VgOutputItem* after, QString line )
+   : VgOutputItem( parent, after, VG_ELEM::LINE )
 {
-   // --- setup text ---
-   int target_line = line.text().toInt();
-
-   if ( target_line < 0 ) {
-      target_line = 0;
-   }
-
-   // num lines to show above / below the target line
-   bool ok = false;
-   int n_lines = vkCfgProj->value( "valkyrie/src-lines" ).toInt( &ok );
-   if ( !ok ) {
-      vkPrintErr( "SrcItem::cons: failed to retrieve/convert 'src-lines' from config." );
-   }
-
-   // figure out where to start showing src lines
-   int top_line = 1;
-   if ( target_line > n_lines + 1 ) {
-      top_line = target_line - n_lines;
-   }
-   int bot_line = target_line + n_lines;
-   int current_line = 1;
+   isReadable  = parent->getIsReadable();
+   isWriteable = parent->getIsWriteable();
 
-   QFile file( path );
-   if ( !file.open( QIODevice::ReadOnly ) ) {
-      return;
-   }
+   // if we got this far, the source is at least readable.
+   vk_assert( isReadable == true );
 
-   // TODO: faster to set file pos using QFile::at(offset)
-   QString src_lines;
-   QTextStream stream( &file );
+   setText( line );
+}
 
-   while ( !stream.atEnd() && ( current_line <= bot_line ) ) {
-      if ( current_line < top_line ) {
-         stream.readLine();   // skip lines to top_line
+QVariant SrcItem::data( int role )
+{
+   switch ( role ) {
+   case Qt::DecorationRole:
+      if ( isWriteable ) {  // read & write
+         return QPixmap( QString::fromUtf8( ":/vk_icons/icons/vglogview_readwrite.xpm" ) );
       }
-      else {
-         src_lines += "  " + stream.readLine() + "\n";
+      else {                // readonly
+         return QPixmap( QString::fromUtf8( ":/vk_icons/icons/vglogview_readonly.xpm" ) );
       }
 
-      current_line++;
+   case Qt::BackgroundRole: {
+      // pale gray background colour.
+      QColor col( "lightgrey" );
+      return QBrush( col );
    }
 
-   file.close();
-   src_lines.truncate( src_lines.length() - 1 ); // remove last newline
-
-   // --- setup item ---
-   isReadable  = parent->getIsReadable();
-   isWriteable = parent->getIsWriteable();
-
-   // if we got this far, the source is at least readable.
-   vk_assert( isReadable == true );
-
-   if ( isWriteable ) {  // read & write
-      setIcon( 0, QPixmap( QString::fromUtf8( ":/vk_icons/icons/vglogview_readwrite.xpm" ) ) );
-   }
-   else {                // readonly
-      setIcon( 0, QPixmap( QString::fromUtf8( ":/vk_icons/icons/vglogview_readonly.xpm" ) ) );
+   default:
+      return VgOutputItem::data( role );
    }
-
-   setText( src_lines );
-
-   // pale gray background colour.
-   QColor col( "lightgrey" );
-   QBrush brush( col );
-   setBackground( 0, brush );
 }
 
 
@@ -954,9 +1133,9 @@ SrcItem::SrcItem( VgOutputItem* parent, QDomElement line, QString path )
    - pairs: as text line
 */
 SuppCountsItem::SuppCountsItem( VgOutputItem* parent,
-                                QTreeWidgetItem* after,
-                                QDomElement sc )
-   : VgOutputItem( parent, after, sc )
+                                VgOutputItem* after,
+                                const VgCounts& sc )
+   : VgOutputItem( parent, after, VG_ELEM::SUPPCOUNTS ), counts( sc )
 {
    setText( "Suppressed errors" );
 
@@ -967,39 +1146,10 @@ void SuppCountsItem::setupChildren()
 {
    if ( childCount() == 0 ) {
       VgOutputItem* child_item = 0;
-      QDomNodeList pairs = elem.childNodes();
-
-      QDomElement e = pairs.item( 0 ).toElement();
-      for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
-#ifdef DEBUG_ON
-         if ( e.tagName() != "pair" ) {
-            vkPrintErr( "SuppCountsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( e.tagName() ) );
-         }
-#endif
-         QDomElement pair = e;
-         QDomElement count = pair.firstChildElement();
-         QDomElement name = count.nextSiblingElement();
-#ifdef DEBUG_ON
-         if ( count.tagName() != "count" ) {
-            vkPrintErr( "SuppCountsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( count.tagName() ) );
-         }
-         if ( name.tagName() != "name" ) {
-            vkPrintErr( "SuppCountsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( name.tagName() ) );
-         }
-         QDomElement elem = name.nextSiblingElement();
-         if ( ! elem.isNull() ) {
-            vkPrintErr( "SuppCountsItem::setupChildren(): unexpected tagName: %s",
-                        qPrintable( elem.tagName() ) );
-         }
-#endif
-         QString count_str = count.text();
-         QString name_str  = name.text();
-         QString supp_str = QString( "%1:  " + name_str ).arg( count_str, 4 );
+      foreach( const VgCountPair& pair, counts ) {
+         QString supp_str = QString( "%1:  " + pair.key ).arg( pair.count, 4 );
 
-         child_item = new VgOutputItem( this, child_item, pair );
+         child_item = new VgOutputItem( this, child_item, VG_ELEM::PAIR );
          child_item->setText( supp_str );
       }
    }
@@ -1013,100 +1163,256 @@ void SuppCountsItem::setupChildren()
 /*!
   VgLogView
 */
-VgLogView::VgLogView( QTreeWidget* v )
-   : lastItem( 0 ), view( v )
+VgLogView::VgLogView( VgLogModel* m )
+   : lastItem( 0 ), topStatus( 0 ), initialised( false ), model( m ),
+     nErrors( 0 ), pageNext( 0 ), pageEnd( 0 ), pageLast( 0 ),
+     paging( false ), updateDepth( 0 ), pendingAfter( 0 ), groupModel( 0 ),
+     errorBudget( 0 ), residentBytes( 0 ), spilledDownTo( 0 )
 {}
 
 VgLogView::~VgLogView()
-{ }
+{
+   // any errors held back, that never made it into the model
+   qDeleteAll( pendingItems );
+}
 
 
 /*!
   initialise our log
 */
-bool VgLogView::init( QDomProcessingInstruction xml_insn, QString doc_tag )
+bool VgLogView::init( QString doc_tag )
 {
-   if ( xml_insn.isNull() ) {
-      vkPrintErr( "VgLogView::init(): xml_insn isNull" );
-      return false;
-   }
-
    if ( doc_tag.isEmpty() ) {
       vkPrintErr( "VgLogView::init(): doc_tag isEmpty" );
       return false;
    }
 
-   QString init_str;
-   QTextStream strm( &init_str, QIODevice::WriteOnly );
-   int indent = 2;
-   xml_insn.save( strm, indent );
-   strm << "<" << doc_tag << "/>";
+   if ( paging ) {
+      return true;   // each page is a log of its own: we're well into ours
+   }
 
-   vglog.setContent( init_str );
+   loginfo = VgLogInfo();
+   nErrors = 0;
+   errorItems.clear();
+   pageSource.clear();
+   pageErrCounts.clear();
+   pageCounts.clear();
+   errorBudget = vkCfgProj->value( "valkyrie/error-budget" ).toLongLong() * 1048576;
+   residentBytes = 0;
+   spilledDownTo = 0;
+   residentErrors.clear();
+   spill.clear();
+   if ( !lazySource.isNull() ) {
+      lazySource->setDocTag( doc_tag );
+   }
+   initialised = true;
    return true;
 }
 
 
+/*!
+  Batched updates: until the matching endUpdate(), new error items
+  are held back, and added to the model in one go, and the top status
+  text is only reformatted once.
+   - other items (suppcounts etc) still go in as they come,
+     after any errors held back before them.
+   - may be nested: only the outermost endUpdate() counts.
+*/
+void VgLogView::beginUpdate()
+{
+   if ( updateDepth++ == 0 && topStatus != 0 ) {
+      topStatus->holdText( true );
+   }
+}
+
+void VgLogView::endUpdate()
+{
+   vk_assert( updateDepth > 0 );
+
+   if ( --updateDepth == 0 ) {
+      insertPendingItems();
+      if ( topStatus != 0 ) {
+         topStatus->holdText( false );
+      }
+   }
+}
+
 
 /*!
-  Populate our model (QDomDocument) and the view (QListWidget)
-   - top-level xml elements are pushed to us from the parser
-   - node is reparented to the QDomDocument log
+  Parent for the tools' new error items: none during a batched update,
+  till we add them ourselves (see insertPendingItems()).
+*/
+VgOutputItem* VgLogView::errorParent()
+{
+   return ( updateDepth > 0 ) ? 0 : topStatus;
+}
 
-  Tool-logviews can do stuff with the QDomElement, a-la "Template Method",
-  by implementing appendNodeTool().
-   - rem to set lastItem to created items, so items get added in order
+
+/*!
+  Add the error items held back by a batched update to the model
+   - one insert for the lot: the view lays out its rows once.
+*/
+void VgLogView::insertPendingItems()
+{
+   if ( pendingItems.isEmpty() ) {
+      return;
+   }
+   vk_assert( topStatus != 0 );
+
+   int idx = topStatus->indexOfChild( pendingAfter ) + 1;
+   topStatus->insertChildren( idx, pendingItems );
+
+   foreach( VgOutputItem* item, pendingItems ) {
+      emit errorItemAdded( item );
+   }
+   pendingItems.clear();
+
+   if ( groupModel ) {
+      groupModel->updateRows();
+   }
+}
+
+
+/*!
+  Grouped errors: as each error comes in, it's added to its group,
+  while we have its details (see VgGroupModel).
 */
-bool VgLogView::appendNode( QDomNode node, QString& errMsg )
+void VgLogView::setGroupModel( VgGroupModel* groups )
+{
+   groupModel = groups;
+}
+
+
+/*!
+  Lazy mode: given the byte range of each <error> in the log,
+  error items drop their details (stacks etc) once created,
+  and re-read them from src when needed.
+*/
+void VgLogView::setLazySource( QSharedPointer<VgLogSource> src,
+                               const VgLogRanges& ranges )
+{
+   lazySource = src;
+   lazyRanges = ranges;
+}
+
+
+/*!
+  Paged mode: we've been given the log's first page of errors, and
+  the errors in byte range [from, to) of src are yet to be read.
+   - called before the run's summary (errorcounts etc) is appended:
+     so new pages go after the last error so far, not after that.
+*/
+void VgLogView::setPagedSource( QSharedPointer<VgLogSource> src,
+                                qint64 from, qint64 to )
+{
+   pageSource = src;
+   pageNext   = from;
+   pageEnd    = to;
+   pageLast   = lastItem;
+}
+
+
+bool VgLogView::hasMoreErrors()
+{
+   return !pageSource.isNull() && pageNext < pageEnd;
+}
+
+
+/*!
+  Paged mode: read in the next maxErrors errors from the log
+   - each new error gets its count from the run's errorcounts,
+     which we've had already.
+*/
+bool VgLogView::loadMoreErrors( int maxErrors, QString& errMsg )
 {
    errMsg = "";
+   if ( !hasMoreErrors() || !topStatus ) {
+      return true;
+   }
 
-   // Test node validity, and attempt to populate QDomDocument model first
-   if ( vglog.isNull() ) {
-      errMsg = "Program error: VgLog not initialised";
-      vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
-      return false;
+   VgOutputItem* tailItem = lastItem;
+   lastItem = pageLast;
+
+   beginUpdate();
+   paging = true;
+   qint64 next;
+   bool ok = pageSource->readPage( pageNext, pageEnd, maxErrors, this, next );
+   paging = false;
+
+   if ( ok ) {
+      pageNext = next;
+   }
+   else {
+      errMsg = "Failed to read more errors from the log";
+      pageNext = pageEnd;   // no point trying again
    }
 
-   if ( logRoot().isNull() ) {
-      errMsg = "XML document root is null";
-      vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
-      return false;
+   // the tools count errors as they're added: put that right
+   if ( !pageErrCounts.isEmpty() ) {
+      topStatus->updateFromErrorCounts( pageErrCounts );
    }
+   endUpdate();
 
-   QDomElement elem = node.toElement();
-   if ( elem.isNull() ) {
-      errMsg = "XML Node not an element (" + node.firstChild().nodeValue() + ")";
-      vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
-      return false;
+   // any tail items (suppcounts etc) stay last
+   if ( tailItem != pageLast ) {
+      pageLast = lastItem;
+      lastItem = tailItem;
+   }
+   else {
+      pageLast = lastItem;
    }
+   return ok;
+}
+
+
+
+/*!
+  Populate our model (VgLogInfo + item data), and so the view
+   - top-level xml elements are pushed to us from the parser,
+     already decoded into typed records
 
-   // reparent node
-   QDomNode n = logRoot().appendChild( node );
-   if ( n.isNull() ) {
-      errMsg = "Program error: Failed to reparent node: (" + elem.tagName() + ")";
+  Tool-logviews can do stuff with the record, a-la "Template Method",
+  by implementing appendNodeTool().
+   - rem to set lastItem to created items, so items get added in order
+*/
+bool VgLogView::appendNode( const VgLogRecord& rec, QString& errMsg )
+{
+   errMsg = "";
+
+   // Test record validity first
+   if ( !initialised ) {
+      errMsg = "Program error: VgLog not initialised";
       vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
       return false;
    }
 
-   // check elem is a top-level xml chunk
-   VG_ELEM::ElemType elemtype = VgOutputItem::elemType( elem.tagName() );
-   if ( elemtype == VG_ELEM::NUM_ELEMS ) {
-      errMsg = "Unrecognised tagname: (" + elem.tagName() + ")";
+   // check rec is a top-level xml chunk
+   if ( rec.type == VG_ELEM::NUM_ELEMS ) {
+      errMsg = "Unrecognised tagname";
       vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
       return false;
    }
 
+   // batched update: held-back errors go in before anything else
+   if ( rec.type != VG_ELEM::ERROR ) {
+      insertPendingItems();
+   }
+   else if ( updateDepth > 0 && pendingItems.isEmpty() ) {
+      pendingAfter = lastItem;
+   }
+   VgOutputItem* prevItem = lastItem;
+
 
    // --------------------
    // ok so far...
-   // now populate view with top-level items, from our model (QDomElements)
+   // now populate view with top-level items, from our model
    //  - children of these view items are only populated on-demand
 
-   switch ( elemtype ) {
+   switch ( rec.type ) {
    case VG_ELEM::PROTOCOL_VERSION: {
-      if ( elem.text() != "4" ) {
-         errMsg = "Unsupported XML protocol version: (" + elem.text() + ")";
+      loginfo.protocolVersion = rec.text;
+      if ( rec.text != "4" ) {
+         errMsg = "Unsupported XML protocol version: (" + rec.text + ")";
          vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
          return false;
       }
@@ -1114,54 +1420,90 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
    }
 
    case VG_ELEM::PROTOCOL_TOOL: {
+      loginfo.protocolTool = rec.text;
       QString tool = this->toolName();
-      if ( elem.text() != tool ) {
-         errMsg = "Wrong tool (" + tool + ") for XML stream (" + elem.text() + ")";
+      if ( rec.text != tool ) {
+         errMsg = "Wrong tool (" + tool + ") for XML stream (" + rec.text + ")";
          vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
          return false;
       }
       break;
    }
 
-   case VG_ELEM::STATUS: {
-      QDomElement status = elem;
-      if ( status.firstChildElement().text() == "RUNNING" ) {
-         QDomElement exe = logRoot().firstChildElement( "args" )
-                           .firstChildElement( "argv" ).firstChildElement( "exe" );
+   case VG_ELEM::PREAMBLE: loginfo.preamble    = rec.lines; break;
+   case VG_ELEM::PID:      loginfo.pid         = rec.text;  break;
+   case VG_ELEM::PPID:     loginfo.ppid        = rec.text;  break;
+   case VG_ELEM::TOOL:     loginfo.tool        = rec.text;  break;
+   case VG_ELEM::COMMENT:  loginfo.userComment = rec.text;  break;
 
-         QDomElement protocol = logRoot().firstChildElement( "protocolversion" );
+   case VG_ELEM::LOGQUAL: {
+      QString var   = rec.lines.value( 0 );
+      QString value = rec.lines.value( 1 );
+      loginfo.logQuals.append( qMakePair( var, value ) );
+      break;
+   }
 
-         topStatus = createTopStatus( view, exe, status, protocol.text() );
-         topStatus->setExpanded( true );
+   case VG_ELEM::ARGS: {
+      loginfo.vargv = rec.lines;
+      loginfo.argv  = rec.argv;
+      break;
+   }
 
-         lastItem = new InfoItem( topStatus, logRoot() );
-         lastItem->setChildIndicatorPolicy( QTreeWidgetItem::ShowIndicator );
+   case VG_ELEM::STATUS: {
+      if ( rec.status.state == "RUNNING" ) {
+         topStatus = createTopStatus( model, loginfo.exe(), rec.status,
+                                      loginfo.protocolVersion );
+         topStatus->openChildren();
+         if ( updateDepth > 0 ) {
+            topStatus->holdText( true );
+         }
 
-         QDomElement preamble = logRoot().firstChildElement( "preamble" );
-         lastItem = new PreambleItem( topStatus, lastItem, preamble );
+         lastItem = new InfoItem( topStatus, loginfo );
+
+         lastItem = new PreambleItem( topStatus, lastItem, loginfo.preamble );
       }
-      else {
+      else if ( topStatus ) {
          // update topStatus
-         topStatus->updateStatus( status );
+         topStatus->updateStatus( rec.status );
       }
       break;
    }
 
    case VG_ELEM::ERRORCOUNTS: {
-      if ( elem.childNodes().count() == 0 ) { // ignore empty errorcounts
+      if ( rec.counts.isEmpty() || !topStatus ) { // ignore empty errorcounts
          break;
       }
 
       // update topStatus
-      topStatus->updateFromErrorCounts( elem );
+      topStatus->updateFromErrorCounts( rec.counts );
 
       // update all non-leak errors
-      updateErrorItems( elem );
+      updateErrorItems( rec.counts );
+
+      // and any still to be paged in
+      if ( !pageSource.isNull() ) {
+         pageErrCounts = rec.counts;
+         pageCounts.clear();
+         foreach( const VgCountPair& pair, rec.counts ) {
+            pageCounts.insert( pair.key, pair.count );
+         }
+      }
       break;
    }
 
-   case VG_ELEM::SUPPCOUNTS: {
-      lastItem = new SuppCountsItem( topStatus, lastItem, elem );
+   case VG_ELEM::SUPPCOUNTS:
+   case VG_ELEM::ERROR:
+   case VG_ELEM::ANNOUNCETHREAD: {
+      if ( !topStatus ) {
+         errMsg = "Unexpected element before first status: (" +
+                  VgOutputItem::elemName( rec.type ) + ")";
+         vkPrintErr( "%s", qPrintable( "VgLogView::appendNode(): " + errMsg ) );
+         return false;
+      }
+
+      if ( rec.type == VG_ELEM::SUPPCOUNTS ) {
+         lastItem = new SuppCountsItem( topStatus, lastItem, rec.counts );
+      }
       break;
    }
 
@@ -1172,102 +1514,166 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
 
 
    // --------------------
-   // Allow tools to do stuff with elem, a-la "Template Method".
-   if ( ! appendNodeTool( elem, errMsg ) ) {
+   // Allow tools to do stuff with rec, a-la "Template Method".
+   if ( ! appendNodeTool( rec, errMsg ) ) {
       return false;
    }
 
 
    // --------------------
-   // Set properties for all new items
-   if ( lastItem ) {
-      lastItem->setChildIndicatorPolicy( QTreeWidgetItem::ShowIndicator );
+   // New error: into the log's error store, which has its count etc
+   if ( rec.type == VG_ELEM::ERROR && lastItem != prevItem &&
+        lastItem->elemType() == VG_ELEM::ERROR ) {
+      VgErrorStore* store = topStatus->errorStore();
+      ( ( ErrorItem* )lastItem )->setStoreRow( store, store->append( rec.error ) );
    }
 
-   return true;
-}
 
+   // --------------------
+   // Lazy mode: the tool is done with the error details
+   if ( rec.type == VG_ELEM::ERROR ) {
+      if ( !lazySource.isNull() && nErrors < lazyRanges.count() &&
+           lastItem && lastItem->elemType() == VG_ELEM::ERROR ) {
+         ( ( ErrorItem* )lastItem )->setLazy( lazySource,
+                                              lazyRanges.at( nErrors ), this );
+      }
+      nErrors++;
+   }
 
-/*!
-   document element: <valgrindoutput/>
-*/
-QDomElement VgLogView::logRoot()
-{
-   return vglog.documentElement();
-}
 
+   // --------------------
+   // Paged mode: the run's errorcounts came before this error
+   if ( paging && rec.type == VG_ELEM::ERROR &&
+        lastItem && lastItem->elemType() == VG_ELEM::ERROR ) {
+      int count = pageCounts.value( rec.error.unique, 1 );
+      ( ( ErrorItem* )lastItem )->updateCount( count );
+   }
 
-/*!
-  iterate over all errors in the listview, looking for a match on
-  error->unique with ecounts->pairList->unique.  if we find a match,
-  update the error's num_times value
-*/
-void VgLogView::updateErrorItems( QDomElement ec )
-{
-   for ( int i=0; i<topStatus->childCount(); ++i ) {
-      VgOutputItem* vgItem = (VgOutputItem*)topStatus->child( i );
 
-      if ( vgItem->elemType() != VG_ELEM::ERROR ) {
-         continue;
+   // --------------------
+   // Over budget: the oldest errors go out to disk
+   if ( rec.type == VG_ELEM::ERROR && lastItem != prevItem &&
+        lastItem->elemType() == VG_ELEM::ERROR ) {
+      qint64 n = ( ( ErrorItem* )lastItem )->detailsBytes();
+      residentBytes += n;
+      if ( errorBudget > 0 ) {
+         if ( n > 0 ) {
+            residentErrors.enqueue( ( ErrorItem* )lastItem );
+         }
+         checkErrorBudget();
       }
+   }
 
-      ErrorItem* vgItemError = ( ErrorItem* )vgItem;
-
-      QString count = "1"; // can't have less than 1 for a reported error
-      QString err_unique = vgItemError->getElement().firstChildElement().text();
-
-      // search errorcount pairs for err_unique
-      QDomNodeList pairs = ec.childNodes();
-      for ( int i = 0; i < pairs.count(); i++ ) {
-         QDomNode pair = pairs.item( i );
-         QDomNodeList pair_details = pair.childNodes();
-         QString unique = pair_details.item( 1 ).toElement().text();
 
-         if ( err_unique == unique ) {
-            count = pair_details.item( 0 ).toElement().text();
-            break;
+   // --------------------
+   // New error item: into the model now, or with the rest of the batch
+   if ( rec.type == VG_ELEM::ERROR && lastItem != prevItem ) {
+      if ( lastItem->elemType() == VG_ELEM::ERROR ) {
+         errorItems.insert( rec.error.unique, ( ErrorItem* )lastItem );
+         if ( groupModel ) {
+            groupModel->addError( ( ErrorItem* )lastItem, rec.error );
+         }
+      }
+      if ( updateDepth > 0 ) {
+         pendingItems.append( lastItem );
+      }
+      else {
+         emit errorItemAdded( lastItem );
+         if ( groupModel ) {
+            groupModel->updateRows();
          }
       }
-
-      vgItemError->updateCount( count );
    }
+   return true;
 }
 
 
+/*!
+  A lazy error's details, re-read from the log to be shown, are held
+  from now on: they count against the budget as a new error's do.
+*/
+void VgLogView::detailsKept( ErrorItem* item )
+{
+   qint64 n = item->detailsBytes();
+   residentBytes += n;
+   if ( errorBudget > 0 && n > 0 ) {
+      residentErrors.enqueue( item );
+      checkErrorBudget();
+   }
+}
 
 
+/*!
+  Spill if over budget, and show the memory use once it matters
+   - not tried again till there's another 1/8 of the budget to go:
+     if what's left can't be spilled, not on every error.
+*/
+void VgLogView::checkErrorBudget()
+{
+   VgErrorStore* store = topStatus->errorStore();
+   if ( residentBytes + store->bytes() >
+        qMax( errorBudget, spilledDownTo + errorBudget / 8 ) ) {
+      spillErrors();
+   }
+   qint64 used = residentBytes + store->bytes();
+   if ( !spill.isNull() || used > errorBudget ) {
+      topStatus->setMemoryUse( used, spill.isNull() ? 0 : spill->bytes(),
+                               errorBudget );
+   }
+}
 
 
-
-
-
-//TODO: needed?
-#if 0
-/*
-  xml string
-  - with \n between each top-level chunk
-  - reimplementation of QDomDocument::toString()
+/*!
+  Over budget: spill the oldest errors, down to 3/4 of it
+   - so it's not all to do again on the very next error.
+   - first the error items' details, then the old frames of the error
+     store. The store's per-error columns stay: they're what counts,
+     leak totals, groups and the filter work from. So a log of very
+     many errors can stay over budget: the status item says so.
+   - the spill file goes in the temp dir, with our logs.
 */
-QString VgLogView::toString( int )
+void VgLogView::spillErrors()
 {
-   if ( log.isNull() ) {
-      return "";
+   if ( spill.isNull() ) {
+      QString segfile = vk_mkstemp( VkCfg::tmpDir() + toolName() + "_spill", "seg" );
+      spill = QSharedPointer<VgErrorSpill>( new VgErrorSpill( segfile ) );
    }
 
-   QString str;
-   QTextStream s( &str, QIODevice::WriteOnly );
+   VgErrorStore* store = topStatus->errorStore();
+   qint64 target = errorBudget / 4 * 3;
+   qint64 storeBytes = store->bytes();
+   while ( residentBytes + storeBytes > target && !residentErrors.isEmpty() ) {
+      residentBytes -= residentErrors.dequeue()->spillDetails( spill );
+   }
+   if ( residentBytes + storeBytes > target ) {
+      store->spillFrames( spill, qMax( target - residentBytes, qint64( 0 ) ) );
+   }
 
-   s << log.firstChild() << "\n";
-   QString doc_elem = logRoot().nodeName();
-   s  << "<" << doc_elem << ">\n\n";
-   QDomNode n = logRoot().firstChild();
+   spilledDownTo = residentBytes + store->bytes();
+}
 
-   for ( ; !n.isNull(); n = n.nextSibling() ) {
-      n.save( s, 2 );
-      s << "\n";
-   }
 
-   s  << "</" << doc_elem << ">\n";
-   return str;
+/*!
+  for each errorcounts pair, look up the error item by its unique,
+  and update its count
+   - one pass over the pairs: errorcounts come again & again in a
+     long run, and there may be many thousands of errors.
+   - errors not in the pairs (leaks) keep their count of 1.
+   - one model update for the lot.
+*/
+void VgLogView::updateErrorItems( const VgCounts& ec )
+{
+   foreach( const VgCountPair& pair, ec ) {
+      ErrorItem* item = errorItems.value( pair.key, 0 );
+      if ( item != 0 ) {
+         if ( groupModel ) {
+            groupModel->updateCount( item, pair.count - item->getCount() );
+         }
+         item->updateCount( pair.count );
+      }
+   }
+   model->childrenChanged( topStatus );
+   if ( groupModel ) {
+      groupModel->updateRows();
+   }
 }
-#endif
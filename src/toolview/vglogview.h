@@ -1,6 +1,6 @@
 /****************************************************************************
 ** VgLogView definition
-**  - links QDomElements with QTreeWidgetItems
+**  - links VgLogRecords with VgOutputItems
 ** --------------------------------------------------------------------------
 **
 ** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
@@ -30,21 +30,27 @@
 #include <QObject>
 #include <QPainter>
 #include <QPixmap>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QVariant>
 
-// QDom stuff
-#include <QDomDocument>
-#include <QDomElement>
-#include <QList>
 #include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QSharedPointer>
 #include <QString>
 
+#include "toolview/vglogmodel.h"
+#include "utils/vgerrorspill.h"
+#include "utils/vgerrorstore.h"
+#include "utils/vglogrecord.h"
+#include "utils/vglogsource.h"
+
 
 // ============================================================
 // Forward decls
 class VgOutputItem;
 class TopStatusItem;
+class ErrorItem;
+class VgGroupModel;
 
 
 // ============================================================
@@ -53,15 +59,15 @@ class TopStatusItem;
 
    - Representation of a Valgrind XML log.
 
-   - Holds both model and view.
-     As the the parser (vglogreader) parses a complete top-level
-     element, it's passed to VgLogView to incrementally update
-     both the model and view.
+   - Fills a VgLogModel.
+     As the the parser (vglogreader) decodes a complete top-level
+     element, it's passed as a VgLogRecord to VgLogView to
+     incrementally update the model, and so any view on it.
 
-   - Takes a view* argument in constructor, and populates it at the same
-     time as the underlying model.
+   - Takes a model* argument in constructor, and adds its log to it,
+     under a top-level status item of its own.
 
-   - Each view item gets a ref to its appropriate VgLog element, for
+   - Each view item keeps the typed record data it represents, for
      setting the item text data, and providing access to any further
      element data.
      Note: this is NOT one-to-one!  Some elements are ignored, and some
@@ -69,21 +75,44 @@ class TopStatusItem;
 
     - On-demand sub-item creation.
       Children of top-level items are created only when the user opens
-      the branch. the QDomElement refs held by item are then queried
+      the branch. the record data held by the item is then used
       to fill the item data.
 */
-class VgLogView : public QObject
+class VgLogView : public QObject, public VgLogSink
 {
    Q_OBJECT
 public:
-   VgLogView( QTreeWidget* );
+   VgLogView( VgLogModel* );
    ~VgLogView();
 
-   bool init( QDomProcessingInstruction xml_insn, QString doc_tag );
-   bool appendNode( QDomNode node, QString& errMsg );
+   bool init( QString doc_tag );
+   bool appendNode( const VgLogRecord& rec, QString& errMsg );
+
+   // batched updates: new errors go into the model in one go
+   void beginUpdate();
+   void endUpdate();
+
+   // lazy mode: errors keep only their summary & range in the log
+   void setLazySource( QSharedPointer<VgLogSource> src,
+                       const VgLogRanges& ranges );
+
+   // paged mode: errors past the first page are left in the log
+   void setPagedSource( QSharedPointer<VgLogSource> src,
+                        qint64 from, qint64 to );
+   bool hasMoreErrors();
+   bool loadMoreErrors( int maxErrors, QString& errMsg );
+
+   // grouped errors: each new error also goes into its group
+   void setGroupModel( VgGroupModel* groups );
 
-//TODO: needed?
-//   QString toString( int indent = 2 ); // xml output
+   // a lazy error's details, re-read and kept while it's shown
+   void detailsKept( ErrorItem* item );
+
+signals:
+   void errorItemAdded( VgOutputItem* item );   // now in the model
+
+protected:
+   VgOutputItem* errorParent();
 
 protected:
    // keep track of our progress
@@ -92,89 +121,125 @@ protected:
 
 private:
    virtual QString toolName() = 0;
-   virtual bool appendNodeTool( QDomElement elem, QString& errMsg ) = 0;
-   virtual TopStatusItem* createTopStatus( QTreeWidget* view, QDomElement exe,
-                                           QDomElement status, QString _protocol ) = 0;
-   void updateErrorItems( QDomElement ec );
-   QDomElement logRoot();
+   virtual bool appendNodeTool( const VgLogRecord& rec, QString& errMsg ) = 0;
+   virtual TopStatusItem* createTopStatus( VgLogModel* model, QString exe,
+                                           const VgStatus& status,
+                                           QString _protocol ) = 0;
+   void updateErrorItems( const VgCounts& ec );
+   void insertPendingItems();
+   void checkErrorBudget();
+   void spillErrors();
 
 private:
-   QDomDocument vglog;
-   QTreeWidget* view;    // we don't own this: don't cleanup
+   VgLogInfo loginfo;    // header data, gathered before first <status>
+   bool initialised;
+   VgLogModel* model;    // we don't own this: don't cleanup
+
+   QSharedPointer<VgLogSource> lazySource;
+   VgLogRanges lazyRanges;  // byte range of each <error>, in log order
+   int nErrors;             // <error>s seen so far
+   QHash<QString, ErrorItem*> errorItems;  // by error unique
+
+   QSharedPointer<VgLogSource> pageSource;
+   qint64 pageNext, pageEnd;   // byte range of the errors not yet read
+   VgOutputItem* pageLast;     // item the next page goes after
+   VgCounts pageErrCounts;     // the run's errorcounts...
+   QHash<QString, int> pageCounts;  // ... by error unique
+   bool paging;                // reading in a page: we're its sink
+
+   int updateDepth;            // beginUpdate()s not yet ended
+   QList<VgOutputItem*> pendingItems;     // errors not yet in the model...
+   VgOutputItem* pendingAfter;            // ... to go after this item
+
+   VgGroupModel* groupModel;   // we don't own this either
+
+   // error details held in memory: see spillErrors()
+   qint64 errorBudget;         // bytes: 0 for no limit
+   qint64 residentBytes;       // details of errors not spilled
+   qint64 spilledDownTo;       // memory held after the last spill
+   QQueue<ErrorItem*> residentErrors;   // ... oldest first
+   QSharedPointer<VgErrorSpill> spill;  // made on first need
 };
 
 
 
-// ============================================================
-namespace VG_ELEM {
-   // All valgrind tag types, for mapping of tags to enum values
-   enum ElemType {
-      ROOT, PROTOCOL_VERSION, PROTOCOL_TOOL, PREAMBLE, PID, PPID, TOOL,
-      LOGQUAL, VAR, VALUE, COMMENT,
-      ARGS, VARGV, ARGV, EXE, ARG,
-      STATUS, STATE, TIME,
-      ERROR, UNIQUE, TID, KIND, WHAT, XWHAT, TEXT, STACK,
-      FRAME, IP, OBJ, FN, SRCDIR, SRCFILE, LINE, AUXWHAT, XAUXWHAT,
-      ERRORCOUNTS, ANNOUNCETHREAD, HTHREADID, PAIR, COUNT,
-      SUPPCOUNTS, NAME, LEAKEDBYTES, LEAKEDBLOCKS,
-      SUPPRESSION, SNAME, SKIND, SKAUX, SFRAME, RAWTEXT,
-      FATAL_SIGNAL,
-      NUM_ELEMS
-   };
-}
-
-// static map (tagname->enum) + access functions
-typedef QHash<QString, VG_ELEM::ElemType> ElemTypeMap;
-
-
-
 // ============================================================
 /*!
    VgOutputItem: base class
 
-   Items represent one (or more) branches/leaves of a Valgrind XML log.
+   Items represent one (or more) branches/leaves of a Valgrind XML log,
+   as shown by a VgLogModel.
+    - plain objects: each has its parent, its children, and its record
+      data, and makes up its text etc only when the view asks (data()).
 
-   Top-level items are initialised with state and QDomElement references.
-    - children are only initialised on demand, via openChildren(),
+   Top-level items are initialised with state and their record data.
+    - children are only initialised on demand, via fetchChildren(),
       for reasons of speed for large logs.
 
    Note: Items do not have a one-to-one relationship with XML elements:
    some XML log elements are ignored, some items represent multiple elements.
 */
-class VgOutputItem : public QTreeWidgetItem
+class VgOutputItem
 {
 public:
-   VgOutputItem( QTreeWidget* parent, QDomElement );
-   VgOutputItem( QTreeWidgetItem* parent, QDomElement );
-   VgOutputItem( QTreeWidgetItem* parent, QTreeWidgetItem* after, QDomElement );
+   // goes in as parent's last child, or after 'after' (first, if 0).
+   // no parent: not in the model yet (see insertChildren())
+   VgOutputItem( VgOutputItem* parent, VG_ELEM::ElemType );
+   VgOutputItem( VgOutputItem* parent, VgOutputItem* after, VG_ELEM::ElemType );
+   virtual ~VgOutputItem();
 
    void setText( QString str );
+   virtual QString text();
+   virtual QVariant data( int role );
 
    VgOutputItem* firstChild();
-   VgOutputItem* parent();
-
-   void openChildren();
+   VgOutputItem* parent();          // 0 for top-level items
+   VgOutputItem* child( int idx );
+   int childCount();
+   int indexOfChild( VgOutputItem* item );
+   int row();                       // our index in our parent
+   void insertChildren( int idx, const QList<VgOutputItem*>& items );
+
+   // children on demand
+   void openChildren();             // fetch them, and be shown open
+   void fetchChildren();
+   bool canFetchChildren();
    // all (non-root) items with children must reimplement this:
    virtual void setupChildren() {}
 
-   // useful static data + functions for mapping tagname -> enum
-   static ElemTypeMap elemtypeMap;
+   // the model we're in, if any: only the root item knows it
+   VgLogModel* model();
+   virtual VgLogModel* logModel() { return 0; }
+   void changed();                  // tell the model our data changed
+
+   // static functions for mapping tagname <-> enum
    static VG_ELEM::ElemType elemType( QString tagName );
+   static QString elemName( VG_ELEM::ElemType type );
    VG_ELEM::ElemType elemType();
 
    // getters
    bool getIsExpandable();
    bool getIsReadable();
    bool getIsWriteable();
-   QDomElement getElement();
+
+   // plain text / xml of the data represented by this item
+   virtual QString toText();
+   virtual QString toXml();
 
 protected:
    bool isReadable, isWriteable;
-   QDomElement elem;               // associated element
+   VG_ELEM::ElemType etype;        // type of associated element
    bool isExpandable;
 
 private:
-   void initialise();
+   void initialise( VgOutputItem* parent, VgOutputItem* after );
+
+private:
+   VgOutputItem* parentItem;
+   QList<VgOutputItem*> children;
+   int rowIdx;
+   bool fetched;                   // setupChildren() done
+   QString str;
 };
 
 
@@ -184,14 +249,17 @@ private:
 class TopStatusItem : public VgOutputItem
 {
 public:
-   TopStatusItem( QTreeWidget* parent, QDomElement exe,
-                              QDomElement status, QString toolstatus,
-                              QString _protocol );
-   void updateStatus( QDomElement status );
-   void updateFromErrorCounts( QDomElement ec );
+   TopStatusItem( VgLogModel* model, QString exe,
+                  const VgStatus& status, QString toolstatus,
+                  QString _protocol );
+   void updateStatus( const VgStatus& status );
+   void updateFromErrorCounts( const VgCounts& ec );
+   void holdText( bool hold );
+   void setMemoryUse( qint64 resident, qint64 spilled, qint64 budget );
+   VgErrorStore* errorStore();   // the log's errors, by column
 
    // all tool TopStatusItems must implement this:
-   virtual void updateToolStatus( QDomElement ) = 0;
+   virtual void updateToolStatus( const VgError& ) = 0;
 
 protected:
    void updateText();
@@ -201,9 +269,13 @@ protected:
    int num_errs;
 
 private:
+   bool textHeld, textStale;   // text updates put off till released
+   QString exe_str;
    QString state_str, start_time, time_str;
+   QString memory_str;
    QString protocol;
    QString status_tmplt, status_str;
+   VgErrorStore store;
 };
 
 
@@ -212,9 +284,12 @@ private:
 class InfoItem : public VgOutputItem
 {
 public:
-   InfoItem( VgOutputItem* parent, QDomElement root );
+   InfoItem( VgOutputItem* parent, const VgLogInfo& info );
 
    void setupChildren();
+
+private:
+   VgLogInfo loginfo;
 };
 
 
@@ -222,9 +297,13 @@ public:
 class LogQualItem : public VgOutputItem
 {
 public:
-   LogQualItem( VgOutputItem* parent, QDomElement logqual );
+   LogQualItem( VgOutputItem* parent, VgOutputItem* after,
+                QString var, QString value );
 
    void setupChildren();
+
+private:
+   QString var_str, value_str;
 };
 
 
@@ -232,10 +311,13 @@ public:
 class ArgsItem : public VgOutputItem
 {
 public:
-   ArgsItem( VgOutputItem* parent, QTreeWidgetItem* after,
-             QDomElement vgargs );
+   ArgsItem( VgOutputItem* parent, VgOutputItem* after,
+             QStringList vargv, QStringList argv );
 
    void setupChildren();
+
+private:
+   QStringList vg_args, exe_args;
 };
 
 
@@ -243,10 +325,27 @@ public:
 class PreambleItem : public VgOutputItem
 {
 public:
-   PreambleItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                 QDomElement preamble );
+   PreambleItem( VgOutputItem* parent, VgOutputItem* after,
+                 QStringList preamble );
 
    void setupChildren();
+
+private:
+   QStringList lines;
+};
+
+
+
+
+// ============================================================
+// WhatItem: an error's what / auxwhat text
+class WhatItem : public VgOutputItem
+{
+public:
+   WhatItem( VgOutputItem* parent, VgOutputItem* after,
+             VG_ELEM::ElemType et, QString what );
+
+   QVariant data( int role );
 };
 
 
@@ -259,23 +358,56 @@ class ErrorItem : public VgOutputItem
 public:
    typedef QMap<QString, QString> AcronymMap;
 
-   ErrorItem( VgOutputItem* parent, QTreeWidgetItem* after,
-              QDomElement err, ErrorItem::AcronymMap map );//, QString acnym );
-   void updateCount( QString count );
+   ErrorItem( VgOutputItem* parent, VgOutputItem* after,
+              const VgError& err, ErrorItem::AcronymMap map );
+   void updateCount( int count );   // the caller tells the model
+   int getCount();
+   void setStoreRow( VgErrorStore* store, int row );
+   int storeRow();                  // -1 if not in a store (yet)
+   VgErrorStore* getStore();
+   QString text();
 
    void showFullSrcPath( bool show );
    bool isFullSrcPathShown();
    QString getSuppressionStr();
+   const VgError& getError();
+   VgError getErrorDetails();
+
+   void setLazy( QSharedPointer<VgLogSource> src, const VgLogRange& rng,
+                 VgLogView* view );
+   qint64 spillDetails( QSharedPointer<VgErrorSpill> spl );
+   qint64 detailsBytes();           // held in memory
 
    void setupChildren();
 
+   QString toText();
+   QString toXml();
+
 protected:
    QString getErrorAcronym( ErrorItem::AcronymMap map, QString kind );
+   // tools can adjust error details re-read from the log
+   virtual void fixupError( VgError& /*err*/ ) {}
+
+private:
+   bool readDetails( VgError& err );
+   VgError withStacks( const VgError& err );
+
+protected:
+   VgError error;           // bar its stacks, once in the store
 
 private:
-   QString err_tmplt;
+   QString acronym;
+   VgErrorStore* errStore;  // our row there has our count etc
+   int errRow;
    bool fullSrcPathShown;
-   QString str_supp;
+
+   // lazy mode: error holds just the summary, until the details are needed
+   //  - re-read from the log's source, or from where they were spilled
+   QSharedPointer<VgLogSource> source;
+   QSharedPointer<VgErrorSpill> spill;
+   VgLogRange range;
+   bool hasDetails;
+   VgLogView* logView;      // told of details kept: they count too
 };
 
 
@@ -284,10 +416,13 @@ private:
 class StackItem : public VgOutputItem
 {
 public:
-   StackItem( VgOutputItem* parent, QTreeWidgetItem* after,
-              QDomElement stck );
+   StackItem( VgOutputItem* parent, VgOutputItem* after,
+              const VgStack& stck );
 
    void setupChildren();
+
+private:
+   VgStack stack;
 };
 
 
@@ -295,21 +430,35 @@ public:
 class FrameItem : public VgOutputItem
 {
 public:
-   FrameItem( VgOutputItem* parent, QTreeWidgetItem* after,
-              QDomElement frm );
+   FrameItem( VgOutputItem* parent, VgOutputItem* after,
+              const VgFrame& frm );
+
+   const VgFrame& getFrame();
+   void showFullSrcPath( bool show );   // the caller tells the model
 
-   QString describe_IP( bool withPath = false );
+   QString text();
+   QVariant data( int role );
 
    void setupChildren();
+
+   QString toText();
+   QString toXml();
+
+private:
+   VgFrame frame;
+   bool fullSrcPath;
 };
 
 
 // ============================================================
+// SrcItem: one line of the source around a frame
 class SrcItem : public VgOutputItem
 {
 public:
-   SrcItem( VgOutputItem* parent, QDomElement line, QString path );
+   SrcItem( VgOutputItem* parent, VgOutputItem* after, QString line );
    // leaf item: no children to setup.
+
+   QVariant data( int role );
 };
 
 
@@ -317,10 +466,13 @@ public:
 class SuppCountsItem : public VgOutputItem
 {
 public:
-   SuppCountsItem( VgOutputItem* parent, QTreeWidgetItem* after,
-                   QDomElement sc );
+   SuppCountsItem( VgOutputItem* parent, VgOutputItem* after,
+                   const VgCounts& sc );
 
    void setupChildren();
+
+private:
+   VgCounts counts;
 };
 
 
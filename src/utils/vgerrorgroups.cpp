@@ -0,0 +1,152 @@
+/****************************************************************************
+** VgErrorGroups implementation
+**  - groups errors reported from the same place, by stack signature
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgerrorgroups.h"
+#include "utils/vk_utils.h"
+
+#include <QStringList>
+
+
+// ============================================================
+/*!
+  Signature of the error's kind & top nFrames frames
+   - atoms are just ids: so this is O(nFrames), with no string
+     compares, once the kind is interned.
+*/
+VgErrorSig::VgErrorSig( const VgError& err, int nFrames )
+   : kind( err.kind )
+{
+   quint64 h = kind.atomId();
+
+   if ( !err.stacks.isEmpty() ) {
+      const VgStack& stack = err.stacks.at( 0 );
+      int n = qMin( nFrames, stack.count() );
+      words.reserve( 2 * n );
+
+      for ( int i=0; i<n; ++i ) {
+         const VgFrame& frame = stack.at( i );
+         bool byIP = frame.fn.isEmpty();
+         quint64 w0 = byIP ? frame.ip : frame.fn.atomId();
+         quint64 w1 = frame.obj.atomId() | ( byIP ? Q_UINT64_C( 1 ) << 32 : 0 );
+         words.append( w0 );
+         words.append( w1 );
+
+         h ^= w0 + Q_UINT64_C( 0x9e3779b97f4a7c15 ) + ( h << 6 ) + ( h >> 2 );
+         h ^= w1 + Q_UINT64_C( 0x9e3779b97f4a7c15 ) + ( h << 6 ) + ( h >> 2 );
+      }
+   }
+
+   hash = uint( h ^ ( h >> 32 ) );
+}
+
+
+
+// ============================================================
+/*!
+  One line for the group: where its errors happen
+   - innermost frame first
+*/
+QString VgErrorGroup::describe() const
+{
+   QStringList fns;
+   foreach( const VgFrame& frame, frames ) {
+      if ( !frame.fn.isEmpty() ) {
+         fns << frame.fn.str();
+      }
+      else if ( !frame.obj.isEmpty() ) {
+         fns << frame.ipStr() + " (within " + frame.obj.str() + ")";
+      }
+      else {
+         fns << frame.ipStr();
+      }
+   }
+
+   if ( fns.isEmpty() ) {
+      return "(no stack)";
+   }
+   return fns.join( " < " );
+}
+
+
+
+// ============================================================
+/*!
+  VgErrorGroups
+*/
+VgErrorGroups::VgErrorGroups( int nFrames )
+{
+   clear( nFrames );
+}
+
+
+/*!
+  Start over, comparing the top nFrames frames
+*/
+void VgErrorGroups::clear( int nFrames )
+{
+   depth = qMax( 1, nFrames );
+   groups.clear();
+   index.clear();
+}
+
+
+/*!
+  Add the error to its group: a new group if it's the first of its kind
+   - count: the times it's been reported so far
+*/
+int VgErrorGroups::addError( const VgError& err, int count )
+{
+   VgErrorSig sig( err, depth );
+
+   int grp;
+   QHash<VgErrorSig, int>::const_iterator it = index.constFind( sig );
+   if ( it != index.constEnd() ) {
+      grp = it.value();
+   }
+   else {
+      grp = groups.count();
+      VgErrorGroup group;
+      group.kind = sig.kind;
+      if ( !err.stacks.isEmpty() ) {
+         group.frames = err.stacks.at( 0 ).mid( 0, depth );
+      }
+      groups.append( group );
+      index.insert( sig, grp );
+   }
+
+   VgErrorGroup& group = groups[grp];
+   group.errors++;
+   group.count += count;
+   if ( err.hasLeak ) {
+      group.leakedBytes  += err.leakedBytes;
+      group.leakedBlocks += err.leakedBlocks;
+   }
+   return grp;
+}
+
+
+/*!
+  One of the group's errors has been reported delta more times
+*/
+void VgErrorGroups::addCount( int grp, int delta )
+{
+   vk_assert( grp >= 0 && grp < groups.count() );
+   groups[grp].count += delta;
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+** VgErrorGroups definition
+**  - groups errors reported from the same place, by stack signature
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGERRORGROUPS_H
+#define __VGERRORGROUPS_H
+
+#include "utils/vglogrecord.h"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+
+// ============================================================
+/*!
+  VgErrorSig: what makes errors 'the same', for grouping
+   - the error kind, and the top N frames of its (first) stack.
+   - a frame is its fn & obj atoms: or its ip, if it has no fn.
+     So the same bug, reached by different call paths further down,
+     or at different lines of the same function, has one signature.
+   - the hash is worked out once, as the signature is made.
+*/
+class VgErrorSig
+{
+public:
+   VgErrorSig() : hash( 0 ) {}
+   VgErrorSig( const VgError& err, int nFrames );
+
+   bool operator==( const VgErrorSig& other ) const {
+      return hash == other.hash && kind == other.kind &&
+             words == other.words;
+   }
+
+   VkAtom kind;
+   QVector<quint64> words;   // two per frame
+   uint hash;
+};
+
+inline uint qHash( const VgErrorSig& sig )
+{
+   return sig.hash;
+}
+
+
+
+// ============================================================
+/*!
+  VgErrorGroup: errors with the same signature
+*/
+class VgErrorGroup
+{
+public:
+   VgErrorGroup() : errors( 0 ), count( 0 ),
+                    leakedBytes( 0 ), leakedBlocks( 0 ) {}
+
+   QString describe() const;
+
+   VkAtom kind;
+   VgStack frames;           // the top frames, from the first error
+   int errors;               // distinct errors in the group
+   qulonglong count;         // times they were reported, all told
+   qulonglong leakedBytes;   // leak errors only
+   qulonglong leakedBlocks;
+};
+
+
+
+// ============================================================
+/*!
+  VgErrorGroups: the grouping engine
+   - errors are added as they come in: each is looked up by its
+     signature, and so costs O(frames compared), whatever the number
+     of errors or groups so far. Nothing is ever rescanned.
+   - groups are numbered in order of their first error.
+*/
+class VgErrorGroups
+{
+public:
+   VgErrorGroups( int nFrames = 4 );
+
+   void clear( int nFrames );
+   int frameCount() const {
+      return depth;
+   }
+
+   int addError( const VgError& err, int count );   // returns its group
+   void addCount( int grp, int delta );             // an error's count changed
+
+   int groupCount() const {
+      return groups.count();
+   }
+   const VgErrorGroup& group( int grp ) const {
+      return groups.at( grp );
+   }
+
+private:
+   int depth;
+   QVector<VgErrorGroup> groups;
+   QHash<VgErrorSig, int> index;   // signature -> group
+};
+
+#endif // #ifndef __VGERRORGROUPS_H
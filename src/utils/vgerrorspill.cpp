@@ -0,0 +1,229 @@
+/****************************************************************************
+** VgErrorSpill implementation
+**  - on-disk segment file for error details moved out of memory
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgerrorspill.h"
+#include "utils/vk_utils.h"
+
+#include <QByteArray>
+#include <QDataStream>
+
+
+// ============================================================
+/*
+  Error (de)serialisation
+   - as VgLogIndex's, but for this process only: frame strings go
+     as their global atom ids, and all strings as utf8.
+*/
+static QString getString( QDataStream& strm )
+{
+   QByteArray utf8;
+   strm >> utf8;
+   return QString::fromUtf8( utf8.constData(), utf8.size() );
+}
+
+static void putError( QDataStream& strm, const VgError& err )
+{
+   strm << err.unique.toUtf8() << err.tid.toUtf8()
+        << err.kind.toUtf8() << err.what.toUtf8()
+        << err.leakedBytes << err.leakedBlocks << err.hasLeak;
+
+   strm << ( quint32 )err.parts.count();
+   foreach( const VgErrorPart& part, err.parts ) {
+      strm << ( qint32 )part.type << part.text.toUtf8() << ( qint32 )part.stack;
+   }
+
+   strm << ( quint32 )err.stacks.count();
+   foreach( const VgStack& stack, err.stacks ) {
+      strm << ( quint32 )stack.count();
+      foreach( const VgFrame& frame, stack ) {
+         strm << frame.ip
+              << frame.obj.atomId() << frame.fn.atomId()
+              << frame.dir.atomId() << frame.file.atomId()
+              << ( qint32 )frame.line;
+      }
+   }
+
+   strm << err.suppression.toUtf8();
+}
+
+static void getError( QDataStream& strm, VgError& err )
+{
+   err.unique = getString( strm );
+   err.tid    = getString( strm );
+   err.kind   = getString( strm );
+   err.what   = getString( strm );
+   strm >> err.leakedBytes >> err.leakedBlocks >> err.hasLeak;
+
+   quint32 nparts;
+   strm >> nparts;
+   for ( quint32 i = 0; i < nparts && strm.status() == QDataStream::Ok; i++ ) {
+      qint32 type, stack;
+      strm >> type;
+      QString text = getString( strm );
+      strm >> stack;
+      if ( type < 0 || type >= VG_ELEM::NUM_ELEMS || stack < -1 ) {
+         strm.setStatus( QDataStream::ReadCorruptData );
+         break;
+      }
+      err.parts << VgErrorPart( ( VG_ELEM::ElemType )type, text, stack );
+   }
+
+   quint32 nstacks;
+   strm >> nstacks;
+   for ( quint32 i = 0; i < nstacks && strm.status() == QDataStream::Ok; i++ ) {
+      quint32 nframes;
+      strm >> nframes;
+      VgStack stack;
+      for ( quint32 j = 0; j < nframes && strm.status() == QDataStream::Ok; j++ ) {
+         VgFrame frame;
+         quint32 obj, fn, dir, file;
+         qint32 line;
+         strm >> frame.ip >> obj >> fn >> dir >> file >> line;
+         frame.obj  = VkAtom::fromId( obj );
+         frame.fn   = VkAtom::fromId( fn );
+         frame.dir  = VkAtom::fromId( dir );
+         frame.file = VkAtom::fromId( file );
+         frame.line = line;
+         stack.append( frame );
+      }
+      err.stacks.append( stack );
+   }
+
+   // each part's stack must be one of the error's
+   foreach( const VgErrorPart& part, err.parts ) {
+      if ( part.stack >= err.stacks.count() ) {
+         strm.setStatus( QDataStream::ReadCorruptData );
+         break;
+      }
+   }
+
+   err.suppression = getString( strm );
+}
+
+
+
+/**********************************************************************/
+/*!
+  VgErrorSpill
+   - the file isn't created till the first error's written.
+*/
+VgErrorSpill::VgErrorSpill( QString segfile )
+   : file( segfile ), size( 0 ), failed( false )
+{ }
+
+VgErrorSpill::~VgErrorSpill()
+{
+   if ( file.isOpen() ) {
+      file.remove();
+   }
+}
+
+
+/*!
+  Add the error to the end of the segment
+   - returns its byte range, for readError(): invalid if not written.
+*/
+VgLogRange VgErrorSpill::writeError( const VgError& err )
+{
+   QByteArray data;
+   QDataStream strm( &data, QIODevice::WriteOnly );
+   strm.setVersion( QDataStream::Qt_5_0 );
+   putError( strm, err );
+   return writeData( data );
+}
+
+
+/*!
+  Decode the error at the given byte range of the segment
+*/
+bool VgErrorSpill::readError( const VgLogRange& range, VgError& err )
+{
+   QByteArray data;
+   if ( !readData( range, data ) ) {
+      return false;
+   }
+
+   QDataStream strm( data );
+   strm.setVersion( QDataStream::Qt_5_0 );
+   VgError e;
+   getError( strm, e );
+   if ( strm.status() != QDataStream::Ok ) {
+      vkPrintErr( "VgErrorSpill::readError(): bad error at offset %lld",
+                  range.start );
+      return false;
+   }
+
+   err = e;
+   return true;
+}
+
+
+/*!
+  Add the data to the end of the segment
+   - returns its byte range, for readData(): invalid if not written.
+*/
+VgLogRange VgErrorSpill::writeData( const QByteArray& data )
+{
+   if ( failed || data.isEmpty() ) {
+      return VgLogRange();
+   }
+
+   if ( !file.isOpen() &&
+        !file.open( QIODevice::ReadWrite | QIODevice::Truncate ) ) {
+      vkPrintErr( "VgErrorSpill::writeData(): failed to open '%s'",
+                  qPrintable( file.fileName() ) );
+      failed = true;
+      return VgLogRange();
+   }
+
+   if ( !file.seek( size ) || file.write( data ) != data.size() ) {
+      vkPrintErr( "VgErrorSpill::writeData(): failed to write '%s': %s",
+                  qPrintable( file.fileName() ),
+                  qPrintable( file.errorString() ) );
+      failed = true;
+      return VgLogRange();
+   }
+
+   VgLogRange range( size, size + data.size() );
+   size = range.end;
+   return range;
+}
+
+
+/*!
+  The data at the given byte range of the segment
+*/
+bool VgErrorSpill::readData( const VgLogRange& range, QByteArray& data )
+{
+   if ( !range.isValid() || range.end > size || !file.isOpen() ) {
+      return false;
+   }
+
+   data.clear();
+   if ( file.seek( range.start ) ) {
+      data = file.read( range.end - range.start );
+   }
+   if ( data.size() != range.end - range.start ) {
+      vkPrintErr( "VgErrorSpill::readData(): failed to read '%s' at offset %lld",
+                  qPrintable( file.fileName() ), range.start );
+      return false;
+   }
+   return true;
+}
@@ -0,0 +1,67 @@
+/****************************************************************************
+** VgErrorSpill definition
+**  - on-disk segment file for error details moved out of memory
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGERRORSPILL_H
+#define __VGERRORSPILL_H
+
+#include "utils/vglogrecord.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VgErrorSpill: where a log's error details go when over budget
+
+   - An append-only segment file: writeError() adds an error, and
+     gives its byte range there, readError() decodes it again.
+     writeData() / readData() likewise, for blocks of the caller's own:
+     e.g. VgErrorStore's frame columns.
+   - Compact: strings as utf8, frame strings as their atom ids. Atoms
+     live as long as the process, and so does the file: it's ours
+     alone, and removed when we go.
+   - Any write failure, e.g. disk full, stops further writes: the
+     errors just stay in memory.
+   - Gui thread only.
+*/
+class VgErrorSpill
+{
+public:
+   VgErrorSpill( QString segfile );
+   ~VgErrorSpill();
+
+   VgLogRange writeError( const VgError& err );   // invalid: not written
+   bool readError( const VgLogRange& range, VgError& err );
+   VgLogRange writeData( const QByteArray& data );
+   bool readData( const VgLogRange& range, QByteArray& data );
+
+   qint64 bytes() const {   // spilled so far
+      return size;
+   }
+
+private:
+   QFile file;
+   qint64 size;
+   bool failed;
+};
+
+#endif // #ifndef __VGERRORSPILL_H
@@ -0,0 +1,447 @@
+/****************************************************************************
+** VgErrorStore implementation
+**  - the errors of a log, stored by column
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgerrorstore.h"
+#include "utils/vk_utils.h"
+
+#include <QDataStream>
+
+
+const quint64 VgErrorStore::NO_LEAK;
+const int VgErrorStore::SEG_ROWS;
+const int VgErrorStore::FRAME_BYTES;
+
+
+// ============================================================
+/*
+  Integer compares, as scan loop bodies: one loop per compare,
+  rather than a switch per value.
+*/
+struct VgCmpEq { bool operator()( qint64 a, qint64 b ) const { return a == b; } };
+struct VgCmpNe { bool operator()( qint64 a, qint64 b ) const { return a != b; } };
+struct VgCmpLt { bool operator()( qint64 a, qint64 b ) const { return a <  b; } };
+struct VgCmpGt { bool operator()( qint64 a, qint64 b ) const { return a >  b; } };
+
+
+/*
+  Leaks: rows [from, to) with leak column values matching
+*/
+template <typename Cmp>
+static void scanLeaks( const quint64* vals, const quint64* leakBytes,
+                       quint64 noLeak, Cmp cmp, qint64 value,
+                       int from, int to, QBitArray& res )
+{
+   for ( int row=from; row<to; ++row ) {
+      if ( leakBytes[row] != noLeak && cmp( qint64( vals[row] ), value ) ) {
+         res.setBit( row );
+      }
+   }
+}
+
+
+/*
+  Lines: rows [from, to) with any known line matching
+   - lines: the column of the rows' frame segment, which starts at
+     frame 'base'.
+*/
+template <typename Cmp>
+static void scanLines( const qint32* lines, quint32 base,
+                       const quint32* errStacks, const quint32* stackFrames,
+                       Cmp cmp, qint64 value, int from, int to, QBitArray& res )
+{
+   for ( int row=from; row<to; ++row ) {
+      quint32 end = stackFrames[errStacks[row + 1]] - base;
+      for ( quint32 f=stackFrames[errStacks[row]] - base; f<end; ++f ) {
+         if ( lines[f] >= 0 && cmp( lines[f], value ) ) {
+            res.setBit( row );
+            break;
+         }
+      }
+   }
+}
+
+
+
+// ============================================================
+/*!
+  VgErrorStore
+*/
+VgErrorStore::VgErrorStore()
+{
+   clear();
+}
+
+
+void VgErrorStore::clear()
+{
+   kinds.clear();
+   uniques.clear();
+   tids.clear();
+   counts.clear();
+   leakBytes.clear();
+   leakBlocks.clear();
+   errStacks.clear();
+   stackFrames.clear();
+   segs.clear();
+   nFrames = 0;
+   residentFrames = 0;
+   spill.clear();
+   cache = FrameSeg();
+   cacheSeg = -1;
+
+   errStacks.append( 0 );
+   stackFrames.append( 0 );
+}
+
+
+/*!
+  Add the error as the last row
+   - its count starts at 1: see setErrorCount()
+*/
+int VgErrorStore::append( const VgError& err )
+{
+   int row = kinds.count();
+
+   kinds.append( VkAtom( err.kind ).atomId() );
+   uniques.append( err.unique.toULongLong( 0, 0 ) );
+   tids.append( err.tid.toInt() );
+   counts.append( 1 );
+   leakBytes.append( err.hasLeak ? err.leakedBytes : NO_LEAK );
+   leakBlocks.append( err.hasLeak ? err.leakedBlocks : 0 );
+
+   if ( row % SEG_ROWS == 0 ) {
+      segs.append( FrameSeg( nFrames ) );
+   }
+   FrameSeg& fs = segs.last();
+
+   foreach( const VgStack& stck, err.stacks ) {
+      foreach( const VgFrame& frame, stck ) {
+         fs.ips.append( frame.ip );
+         fs.fns.append( frame.fn.atomId() );
+         fs.objs.append( frame.obj.atomId() );
+         fs.dirs.append( frame.dir.atomId() );
+         fs.files.append( frame.file.atomId() );
+         fs.lines.append( frame.line );
+      }
+      nFrames += stck.count();
+      residentFrames += stck.count();
+      stackFrames.append( nFrames );
+   }
+   errStacks.append( stackFrames.count() - 1 );
+
+   return row;
+}
+
+
+VkAtom VgErrorStore::kind( int row ) const
+{
+   return VkAtom::fromId( kinds.at( row ) );
+}
+
+
+void VgErrorStore::setErrorCount( int row, int count )
+{
+   counts[row] = count;
+}
+
+
+qulonglong VgErrorStore::leakedBytes( int row ) const
+{
+   return hasLeak( row ) ? leakBytes.at( row ) : 0;
+}
+
+
+qulonglong VgErrorStore::leakedBlocks( int row ) const
+{
+   return leakBlocks.at( row );
+}
+
+
+int VgErrorStore::stackCount( int row ) const
+{
+   return errStacks.at( row + 1 ) - errStacks.at( row );
+}
+
+
+/*!
+  The error's idx'th stack, as frames again
+   - empty if its frames were spilled, and can't be read back.
+*/
+VgStack VgErrorStore::stack( int row, int idx ) const
+{
+   vk_assert( idx >= 0 && idx < stackCount( row ) );
+
+   const FrameSeg* fs = frameSeg( row / SEG_ROWS );
+   if ( fs == 0 ) {
+      return VgStack();
+   }
+
+   int stk = errStacks.at( row ) + idx;
+   int beg = stackFrames.at( stk ) - fs->first;
+   int end = stackFrames.at( stk + 1 ) - fs->first;
+
+   VgStack frames( end - beg );
+   for ( int f=beg; f<end; ++f ) {
+      VgFrame& frame = frames[f - beg];
+      frame.ip   = fs->ips.at( f );
+      frame.fn   = VkAtom::fromId( fs->fns.at( f ) );
+      frame.obj  = VkAtom::fromId( fs->objs.at( f ) );
+      frame.dir  = VkAtom::fromId( fs->dirs.at( f ) );
+      frame.file = VkAtom::fromId( fs->files.at( f ) );
+      frame.line = fs->lines.at( f );
+   }
+   return frames;
+}
+
+
+/*!
+  Segment seg, with its frames in memory: read back if spilled
+   - kept till another's read back: a scan goes a segment at a time,
+     and stack() is mostly asked for the same error's stacks in turn.
+   - 0 if it can't be read back.
+*/
+const VgErrorStore::FrameSeg* VgErrorStore::frameSeg( int seg ) const
+{
+   const FrameSeg& fs = segs.at( seg );
+   if ( !fs.spilled.isValid() ) {
+      return &fs;
+   }
+   if ( seg == cacheSeg ) {
+      return &cache;
+   }
+
+   QByteArray data;
+   if ( spill.isNull() || !spill->readData( fs.spilled, data ) ) {
+      return 0;
+   }
+
+   FrameSeg seg_fs( fs.first );
+   QDataStream strm( data );
+   strm.setVersion( QDataStream::Qt_5_0 );
+   strm >> seg_fs.ips >> seg_fs.fns >> seg_fs.objs
+        >> seg_fs.dirs >> seg_fs.files >> seg_fs.lines;
+   if ( strm.status() != QDataStream::Ok ) {
+      vkPrintErr( "VgErrorStore::frameSeg(): bad frames at offset %lld",
+                  fs.spilled.start );
+      return 0;
+   }
+
+   cache = seg_fs;
+   cacheSeg = seg;
+   return &cache;
+}
+
+
+const QVector<quint32>* VgErrorStore::atomColumn( const FrameSeg* fs,
+                                                  VG_ELEM::ElemType field )
+{
+   switch ( field ) {
+   case VG_ELEM::FN:      return &fs->fns;
+   case VG_ELEM::OBJ:     return &fs->objs;
+   case VG_ELEM::SRCDIR:  return &fs->dirs;
+   case VG_ELEM::SRCFILE: return &fs->files;
+   default:               return 0;
+   }
+}
+
+
+/*!
+  Rows with a matching atom in the given field
+   - KIND: the row's kind. FN, OBJ, SRCDIR, SRCFILE: any of its frames'.
+   - the empty atom (0) never matches: an unknown field isn't a value.
+*/
+QBitArray VgErrorStore::matchAtoms( VG_ELEM::ElemType field,
+                                    const QByteArray& atoms,
+                                    int from, int to ) const
+{
+   int n = count();
+   QBitArray res( n );
+   if ( to < 0 || to > n ) {
+      to = n;
+   }
+   if ( from >= to ) {
+      return res;
+   }
+
+   const char* match = atoms.constData();
+   quint32 nAtoms = atoms.size();
+
+   if ( field == VG_ELEM::KIND ) {
+      const quint32* ids = kinds.constData();
+      for ( int row=from; row<to; ++row ) {
+         quint32 id = ids[row];
+         if ( id != 0 && id < nAtoms && match[id] ) {
+            res.setBit( row );
+         }
+      }
+      return res;
+   }
+
+   // a segment at a time
+   const quint32* es = errStacks.constData();
+   const quint32* sf = stackFrames.constData();
+   for ( int seg=from / SEG_ROWS; seg * SEG_ROWS < to; ++seg ) {
+      const FrameSeg* fs = frameSeg( seg );
+      const QVector<quint32>* col = fs ? atomColumn( fs, field ) : 0;
+      if ( col == 0 ) {
+         continue;
+      }
+
+      const quint32* ids = col->constData();
+      int segTo = qMin( to, ( seg + 1 ) * SEG_ROWS );
+      for ( int row=qMax( from, seg * SEG_ROWS ); row<segTo; ++row ) {
+         quint32 end = sf[es[row + 1]] - fs->first;
+         for ( quint32 f=sf[es[row]] - fs->first; f<end; ++f ) {
+            quint32 id = ids[f];
+            if ( id != 0 && id < nAtoms && match[id] ) {
+               res.setBit( row );
+               break;
+            }
+         }
+      }
+   }
+   return res;
+}
+
+
+/*!
+  Rows with a matching number in the given field
+   - LEAKEDBYTES, LEAKEDBLOCKS: leak errors only.
+   - LINE: any of its frames with a known line.
+*/
+QBitArray VgErrorStore::matchInts( VG_ELEM::ElemType field, IntCmp cmp,
+                                   qint64 value, int from, int to ) const
+{
+   int n = count();
+   QBitArray res( n );
+   if ( to < 0 || to > n ) {
+      to = n;
+   }
+   if ( from >= to ) {
+      return res;
+   }
+
+   switch ( field ) {
+   case VG_ELEM::LEAKEDBYTES:
+   case VG_ELEM::LEAKEDBLOCKS: {
+      const quint64* vals = ( field == VG_ELEM::LEAKEDBYTES )
+                            ? leakBytes.constData() : leakBlocks.constData();
+      const quint64* lb = leakBytes.constData();
+      switch ( cmp ) {
+      case CMP_EQ: scanLeaks( vals, lb, NO_LEAK, VgCmpEq(), value, from, to, res ); break;
+      case CMP_NE: scanLeaks( vals, lb, NO_LEAK, VgCmpNe(), value, from, to, res ); break;
+      case CMP_LT: scanLeaks( vals, lb, NO_LEAK, VgCmpLt(), value, from, to, res ); break;
+      case CMP_GT: scanLeaks( vals, lb, NO_LEAK, VgCmpGt(), value, from, to, res ); break;
+      }
+      break;
+   }
+
+   case VG_ELEM::LINE: {
+      // a segment at a time
+      const quint32* es = errStacks.constData();
+      const quint32* sf = stackFrames.constData();
+      for ( int seg=from / SEG_ROWS; seg * SEG_ROWS < to; ++seg ) {
+         const FrameSeg* fs = frameSeg( seg );
+         if ( fs == 0 ) {
+            continue;
+         }
+
+         const qint32* ln = fs->lines.constData();
+         quint32 base = fs->first;
+         int segFrom = qMax( from, seg * SEG_ROWS );
+         int segTo = qMin( to, ( seg + 1 ) * SEG_ROWS );
+         switch ( cmp ) {
+         case CMP_EQ: scanLines( ln, base, es, sf, VgCmpEq(), value, segFrom, segTo, res ); break;
+         case CMP_NE: scanLines( ln, base, es, sf, VgCmpNe(), value, segFrom, segTo, res ); break;
+         case CMP_LT: scanLines( ln, base, es, sf, VgCmpLt(), value, segFrom, segTo, res ); break;
+         case CMP_GT: scanLines( ln, base, es, sf, VgCmpGt(), value, segFrom, segTo, res ); break;
+         }
+      }
+      break;
+   }
+
+   default:
+      break;
+   }
+   return res;
+}
+
+
+/*!
+  Approx. memory held: by error, by stack, and the frames not spilled
+   - O(1): it's asked after each new error.
+*/
+qint64 VgErrorStore::bytes() const
+{
+   qint64 n = qint64( count() ) * ( 3 * sizeof( quint64 ) + 4 * sizeof( quint32 ) );
+   n += qint64( stackFrames.count() ) * sizeof( quint32 );
+   n += ( residentFrames + cache.ips.count() ) * FRAME_BYTES;
+   return n;
+}
+
+
+/*!
+  Over budget: spill the old segments' frames, oldest first, till
+  we're down to maxBytes (or there are no more to spill)
+   - not the last segment: errors are still being added to it.
+   - returns the bytes freed.
+*/
+qint64 VgErrorStore::spillFrames( QSharedPointer<VgErrorSpill> spl,
+                                  qint64 maxBytes )
+{
+   if ( spl.isNull() ) {
+      return 0;
+   }
+   if ( spill.isNull() ) {
+      spill = spl;
+   }
+   vk_assert( spill == spl );   // one spill file per log
+
+   qint64 before = bytes();
+   qint64 now = before;
+   for ( int seg=0; seg<segs.count() - 1 && now > maxBytes; ++seg ) {
+      FrameSeg& fs = segs[seg];
+      if ( fs.spilled.isValid() || fs.ips.isEmpty() ) {
+         continue;
+      }
+
+      QByteArray data;
+      QDataStream strm( &data, QIODevice::WriteOnly );
+      strm.setVersion( QDataStream::Qt_5_0 );
+      strm << fs.ips << fs.fns << fs.objs << fs.dirs << fs.files << fs.lines;
+
+      VgLogRange rng = spill->writeData( data );
+      if ( !rng.isValid() ) {
+         break;   // no more room: they stay
+      }
+
+      qint64 n = fs.ips.count();
+      fs.spilled = rng;
+      fs.ips   = QVector<quint64>();
+      fs.fns   = QVector<quint32>();
+      fs.objs  = QVector<quint32>();
+      fs.dirs  = QVector<quint32>();
+      fs.files = QVector<quint32>();
+      fs.lines = QVector<qint32>();
+      residentFrames -= n;
+      now -= n * FRAME_BYTES;
+   }
+   return before - now;
+}
@@ -0,0 +1,143 @@
+/****************************************************************************
+** VgErrorStore definition
+**  - the errors of a log, stored by column
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGERRORSTORE_H
+#define __VGERRORSTORE_H
+
+#include "utils/vgerrorspill.h"
+#include "utils/vglogrecord.h"
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QVector>
+
+
+// ============================================================
+/*!
+  VgErrorStore: a log's errors, as columns of plain numbers
+
+   - A row per error: kind (atom id), unique, tid, count, leaked
+     bytes & blocks, and the range of its stacks.
+   - All stacks' frames, also by column: ip, fn, obj, dir, file (atom
+     ids) and line. Each stack is a range of frames, each error a range
+     of stacks.
+
+  So full-log queries are linear scans over integer arrays: e.g. "all
+  errors with a frame in libfoo.so" is one pass over the obj column,
+  with the string compares done once per distinct obj (see matchAtoms()),
+  not once per frame.
+
+  Rows are only ever appended: row numbers stay valid.
+
+  The stacks kept here are the only copy the log view has: its error
+  items drop theirs, and get them back from here (see stack()).
+
+  Memory: the frames, most of it, are kept in segments of SEG_ROWS
+  errors' worth. Over budget, the old (full) segments can be spilled
+  (spillFrames()), and are read back for a scan or stack(), a segment
+  at a time. The per-error columns stay: some 50 bytes an error, as
+  counts etc are wanted all the time.
+*/
+class VgErrorStore
+{
+public:
+   enum IntCmp { CMP_EQ, CMP_NE, CMP_LT, CMP_GT };
+
+   VgErrorStore();
+
+   void clear();
+   int append( const VgError& err );   // returns its row
+   int count() const {
+      return kinds.count();
+   }
+
+   // row data
+   VkAtom     kind( int row ) const;
+   quint64    unique( int row ) const   { return uniques.at( row ); }
+   int        tid( int row ) const      { return tids.at( row ); }
+   int        errorCount( int row ) const { return counts.at( row ); }
+   void       setErrorCount( int row, int count );
+   bool       hasLeak( int row ) const  { return leakBytes.at( row ) != NO_LEAK; }
+   qulonglong leakedBytes( int row ) const;
+   qulonglong leakedBlocks( int row ) const;
+
+   int stackCount( int row ) const;
+   VgStack stack( int row, int idx ) const;
+
+   // scans: a bit per row in [from, to), to -1 for all
+   //  - atoms: a byte per atom id, non-0 for a match: ids past its
+   //    end don't match.
+   QBitArray matchAtoms( VG_ELEM::ElemType field, const QByteArray& atoms,
+                         int from = 0, int to = -1 ) const;
+   QBitArray matchInts( VG_ELEM::ElemType field, IntCmp cmp, qint64 value,
+                        int from = 0, int to = -1 ) const;
+
+   // memory: approx. bytes held, and spilling the old frames
+   qint64 bytes() const;
+   qint64 spillFrames( QSharedPointer<VgErrorSpill> spl, qint64 maxBytes );
+
+private:
+   // the frames of SEG_ROWS errors
+   class FrameSeg
+   {
+   public:
+      FrameSeg( quint32 f = 0 ) : first( f ) {}
+
+      quint32 first;             // its first frame
+      QVector<quint64> ips;
+      QVector<quint32> fns, objs, dirs, files;
+      QVector<qint32>  lines;
+      VgLogRange spilled;        // valid: the columns are in the spill
+   };
+
+   const FrameSeg* frameSeg( int seg ) const;
+   static const QVector<quint32>* atomColumn( const FrameSeg* fs,
+                                              VG_ELEM::ElemType field );
+
+private:
+   static const quint64 NO_LEAK = ~Q_UINT64_C( 0 );
+   static const int SEG_ROWS = 4096;
+   static const int FRAME_BYTES = sizeof( quint64 ) + 5 * sizeof( quint32 );
+
+   // by error
+   QVector<quint32> kinds;
+   QVector<quint64> uniques;
+   QVector<qint32>  tids;
+   QVector<qint32>  counts;
+   QVector<quint64> leakBytes;     // NO_LEAK if not a leak
+   QVector<quint64> leakBlocks;
+   QVector<quint32> errStacks;     // error -> first stack: one extra, at end
+
+   // by stack
+   QVector<quint32> stackFrames;   // stack -> first frame: one extra, at end
+
+   // by frame: segment s has the frames of rows [s*SEG_ROWS, (s+1)*SEG_ROWS)
+   QVector<FrameSeg> segs;
+   quint32 nFrames;                // frames in all
+   qint64 residentFrames;          // ... of them not spilled
+   QSharedPointer<VgErrorSpill> spill;
+
+   // the last spilled segment read back
+   mutable FrameSeg cache;
+   mutable int cacheSeg;
+};
+
+#endif // #ifndef __VGERRORSTORE_H
@@ -0,0 +1,651 @@
+/****************************************************************************
+** VgLogIndex implementation
+**  - binary sidecar cache of a parsed valgrind xml log
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogindex.h"
+#include "utils/vk_utils.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+#include <limits.h>
+
+
+#define VKIDX_MAGIC   0x564b4958   // "VKIX"
+#define VKIDX_VERSION 3
+
+/* the header: magic, version, log stamp, md5 of all after the header,
+   and the offset of the trailer (record count, doc tag, string table),
+   which follows the records. */
+#define VKIDX_HEADER_SIZE ( 4 + 4 + ( 8 + 8 + 4 + 16 ) + ( 4 + 16 ) + 8 )
+
+// checksummed a block at a time: the index may be big
+#define VKIDX_SUM_BLOCK ( 1024 * 1024 )
+
+// content hash: head + tail + evenly spaced samples of the log
+#define VKIDX_HASH_BLOCK   ( 64 * 1024 )
+#define VKIDX_HASH_SAMPLES 64
+
+// records replayed between progress reports
+#define VG_LOG_REPLAY_STEP 1024
+
+
+
+// ============================================================
+/*
+  Sampled content hash of the log
+   - hashing all of a multi-GB log would take as long as parsing it:
+     size & mtime catch most changes, this catches the rest
+     (e.g. a log rewritten in place, with the same size, within
+     the mtime granularity).
+*/
+static QByteArray logHash( QFile& file )
+{
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   qint64 size = file.size();
+
+   QByteArray buf;
+   for ( int i = 0; i <= VKIDX_HASH_SAMPLES; i++ ) {
+      qint64 pos = ( size - VKIDX_HASH_BLOCK ) * i / VKIDX_HASH_SAMPLES;
+      if ( pos < 0 ) {
+         pos = 0;
+      }
+      if ( !file.seek( pos ) ) {
+         return QByteArray();
+      }
+      buf = file.read( VKIDX_HASH_BLOCK );
+      hash.addData( buf );
+      if ( size <= VKIDX_HASH_BLOCK ) {
+         break;
+      }
+   }
+
+   return hash.result();
+}
+
+
+/*
+  The log identity, as stored in the index header
+*/
+class VgLogStamp
+{
+public:
+   VgLogStamp() : size( -1 ), mtime( 0 ) {}
+
+   bool read( QString logfile ) {
+      QFile file( logfile );
+      if ( !file.open( QIODevice::ReadOnly ) ) {
+         return false;
+      }
+      size  = file.size();
+      mtime = QFileInfo( file ).lastModified().toMSecsSinceEpoch();
+      hash  = logHash( file );
+      return !hash.isEmpty();
+   }
+
+   bool operator==( const VgLogStamp& other ) const {
+      return size == other.size && mtime == other.mtime &&
+             hash == other.hash;
+   }
+
+   qint64 size;
+   qint64 mtime;
+   QByteArray hash;
+};
+
+static QDataStream& operator<<( QDataStream& strm, const VgLogStamp& stamp )
+{
+   return strm << stamp.size << stamp.mtime << stamp.hash;
+}
+
+static QDataStream& operator>>( QDataStream& strm, VgLogStamp& stamp )
+{
+   return strm >> stamp.size >> stamp.mtime >> stamp.hash;
+}
+
+
+
+// ============================================================
+/*
+  Record (de)serialisation
+   - frame atoms are written as indices into the index's own string
+     table, which is re-interned on load.
+   - counts are checked against what's left to read: a bad one mustn't
+     have us reserve, or loop, for the sake of it.
+*/
+typedef QHash<quint32, quint32> AtomIds;   // global atom -> table index
+
+/*
+  A count of items of at least minBytes each: false, and the stream
+  marked corrupt, if there can't be that many left in it.
+*/
+static bool getCount( QDataStream& strm, quint32& n, int minBytes )
+{
+   strm >> n;
+   if ( strm.status() == QDataStream::Ok &&
+        n > strm.device()->bytesAvailable() / minBytes ) {
+      strm.setStatus( QDataStream::ReadCorruptData );
+   }
+   return strm.status() == QDataStream::Ok;
+}
+
+/* as QDataStream's operator>>(QStringList), but checking the count */
+static void getStrings( QDataStream& strm, QStringList& strs )
+{
+   quint32 n;
+   if ( !getCount( strm, n, 4 ) ) {
+      return;
+   }
+   strs.reserve( n );
+   for ( quint32 i = 0; i < n && strm.status() == QDataStream::Ok; i++ ) {
+      QString str;
+      strm >> str;
+      strs.append( str );
+   }
+}
+
+static quint32 tableId( VkAtom atom, AtomIds& ids, QStringList& table )
+{
+   if ( atom.isEmpty() ) {
+      return 0;
+   }
+   AtomIds::const_iterator it = ids.constFind( atom.atomId() );
+   if ( it != ids.constEnd() ) {
+      return it.value();
+   }
+   table << atom.str();
+   quint32 id = table.count();   // 0 is the empty string
+   ids.insert( atom.atomId(), id );
+   return id;
+}
+
+static VkAtom tableAtom( quint32 id, const QVector<VkAtom>& atoms )
+{
+   return ( id < ( quint32 )atoms.count() ) ? atoms.at( id ) : VkAtom();
+}
+
+
+static void putError( QDataStream& strm, const VgError& err,
+                      AtomIds& ids, QStringList& table )
+{
+   strm << err.unique << err.tid << err.kind << err.what
+        << err.leakedBytes << err.leakedBlocks << err.hasLeak;
+
+   strm << ( quint32 )err.parts.count();
+   foreach( const VgErrorPart& part, err.parts ) {
+      strm << ( qint32 )part.type << part.text << ( qint32 )part.stack;
+   }
+
+   strm << ( quint32 )err.stacks.count();
+   foreach( const VgStack& stack, err.stacks ) {
+      strm << ( quint32 )stack.count();
+      foreach( const VgFrame& frame, stack ) {
+         strm << frame.ip
+              << tableId( frame.obj, ids, table )
+              << tableId( frame.fn, ids, table )
+              << tableId( frame.dir, ids, table )
+              << tableId( frame.file, ids, table )
+              << ( qint32 )frame.line;
+      }
+   }
+
+   strm << err.suppression;
+}
+
+static void getError( QDataStream& strm, VgError& err,
+                      const QVector<VkAtom>& atoms )
+{
+   strm >> err.unique >> err.tid >> err.kind >> err.what
+        >> err.leakedBytes >> err.leakedBlocks >> err.hasLeak;
+
+   quint32 nparts;
+   getCount( strm, nparts, 4 + 4 + 4 );
+   for ( quint32 i = 0; i < nparts && strm.status() == QDataStream::Ok; i++ ) {
+      qint32 type, stack;
+      QString text;
+      strm >> type >> text >> stack;
+      if ( type < 0 || type >= VG_ELEM::NUM_ELEMS || stack < -1 ) {
+         strm.setStatus( QDataStream::ReadCorruptData );
+         break;
+      }
+      err.parts << VgErrorPart( ( VG_ELEM::ElemType )type, text, stack );
+   }
+
+   quint32 nstacks;
+   getCount( strm, nstacks, 4 );
+   for ( quint32 i = 0; i < nstacks && strm.status() == QDataStream::Ok; i++ ) {
+      quint32 nframes;
+      getCount( strm, nframes, 8 + 4 * 4 + 4 );
+      VgStack stack;
+      for ( quint32 j = 0; j < nframes && strm.status() == QDataStream::Ok; j++ ) {
+         VgFrame frame;
+         quint32 obj, fn, dir, file;
+         qint32 line;
+         strm >> frame.ip >> obj >> fn >> dir >> file >> line;
+         frame.obj  = tableAtom( obj, atoms );
+         frame.fn   = tableAtom( fn, atoms );
+         frame.dir  = tableAtom( dir, atoms );
+         frame.file = tableAtom( file, atoms );
+         frame.line = line;
+         stack.append( frame );
+      }
+      err.stacks.append( stack );
+   }
+
+   // each part's stack must be one of the error's: the view goes
+   // straight to it
+   foreach( const VgErrorPart& part, err.parts ) {
+      if ( part.stack >= err.stacks.count() ) {
+         strm.setStatus( QDataStream::ReadCorruptData );
+         break;
+      }
+   }
+
+   strm >> err.suppression;
+}
+
+
+static void putRecord( QDataStream& strm, const VgLogRecord& rec,
+                       AtomIds& ids, QStringList& table )
+{
+   strm << ( qint32 )rec.type << rec.text << rec.lines << rec.argv
+        << rec.status.state << rec.status.time;
+
+   strm << ( quint32 )rec.counts.count();
+   foreach( const VgCountPair& pair, rec.counts ) {
+      strm << ( qint32 )pair.count << pair.key;
+   }
+
+   putError( strm, rec.error, ids, table );
+}
+
+static void getRecord( QDataStream& strm, VgLogRecord& rec,
+                       const QVector<VkAtom>& atoms )
+{
+   qint32 type;
+   strm >> type >> rec.text;
+   getStrings( strm, rec.lines );
+   getStrings( strm, rec.argv );
+   strm >> rec.status.state >> rec.status.time;
+   rec.type = ( VG_ELEM::ElemType )type;
+
+   quint32 ncounts;
+   getCount( strm, ncounts, 4 + 4 );
+   for ( quint32 i = 0; i < ncounts && strm.status() == QDataStream::Ok; i++ ) {
+      qint32 count;
+      VgCountPair pair;
+      strm >> count >> pair.key;
+      pair.count = count;
+      rec.counts.append( pair );
+   }
+
+   getError( strm, rec.error, atoms );
+}
+
+
+
+/**********************************************************************/
+/*!
+  VgLogIndex
+*/
+VgLogIndex::VgLogIndex( VgLogSink* lv )
+   : logview( lv ), nrecs( 0 ), bodyHash( QCryptographicHash::Md5 ),
+     map( 0 ), trailerPos( 0 )
+{ }
+
+
+VgLogIndex::~VgLogIndex()
+{
+   unmap();
+}
+
+
+void VgLogIndex::setSink( VgLogSink* lv )
+{
+   logview = lv;
+}
+
+
+QString VgLogIndex::indexPath( QString logfile )
+{
+   return logfile + ".vkidx";
+}
+
+
+/*!
+  VgLogSink: (re)start passing on, and writing the index if asked to
+*/
+bool VgLogIndex::init( QString doc_tag )
+{
+   vk_assert( logview != 0 );
+
+   docTag = doc_tag;
+
+   if ( !logFile.isEmpty() && !openSave() ) {
+      cancelSave();
+   }
+   return logview->init( doc_tag );
+}
+
+
+/*!
+  VgLogSink: pass on, and add to the index.
+*/
+bool VgLogIndex::appendNode( const VgLogRecord& rec, QString& errMsg )
+{
+   vk_assert( logview != 0 );
+
+   if ( !logview->appendNode( rec, errMsg ) ) {
+      return false;
+   }
+
+   if ( !saveFile.isNull() ) {
+      QByteArray data;
+      QDataStream strm( &data, QIODevice::WriteOnly );
+      strm.setVersion( QDataStream::Qt_5_0 );
+      putRecord( strm, rec, tableIds, table );
+
+      if ( saveFile->write( data ) != data.size() ) {
+         VK_DEBUG( "Not writing log index '%s': %s",
+                   qPrintable( saveFile->fileName() ),
+                   qPrintable( saveFile->errorString() ) );
+         cancelSave();
+         return true;
+      }
+      bodyHash.addData( data );
+
+      nrecs++;
+   }
+   return true;
+}
+
+
+/*!
+  VgLogSink: pass on
+*/
+bool VgLogIndex::loadProgress( qint64 done, qint64 total )
+{
+   vk_assert( logview != 0 );
+
+   return logview->loadProgress( done, total );
+}
+
+
+/*!
+  Write an index for the given log, from the records passed on from
+  its init(): save() once it's been parsed in full.
+*/
+void VgLogIndex::startSave( QString logfile )
+{
+   cancelSave();
+   logFile = logfile;
+}
+
+
+/*
+  (Re)start the index: a placeholder header, till save() knows what
+  goes in it.
+*/
+bool VgLogIndex::openSave()
+{
+   saveFile.reset( new QSaveFile( indexPath( logFile ) ) );
+   bodyHash.reset();
+   tableIds.clear();
+   table.clear();
+   nrecs = 0;
+
+   if ( !saveFile->open( QIODevice::WriteOnly ) ) {
+      VK_DEBUG( "Not writing log index '%s': %s",
+                qPrintable( saveFile->fileName() ),
+                qPrintable( saveFile->errorString() ) );
+      return false;
+   }
+   return saveFile->write( QByteArray( VKIDX_HEADER_SIZE, '\0' ) )
+          == VKIDX_HEADER_SIZE;
+}
+
+
+/*
+  No index after all: any temporary file's removed
+*/
+void VgLogIndex::cancelSave()
+{
+   saveFile.reset();
+   logFile.clear();
+   tableIds.clear();
+   table.clear();
+}
+
+
+/*!
+  Finish the index for the (fully parsed) log
+   - only now does it replace any old index.
+   - not being able to write it is no problem: we just won't have one.
+*/
+bool VgLogIndex::save()
+{
+   if ( saveFile.isNull() ) {
+      return false;
+   }
+
+   VgLogStamp stamp;
+   bool ok = stamp.read( logFile ) && stamp.hash.size() == 16;
+
+   QByteArray trailer;
+   {
+      QDataStream strm( &trailer, QIODevice::WriteOnly );
+      strm.setVersion( QDataStream::Qt_5_0 );
+
+      strm << nrecs << docTag << table;
+   }
+   bodyHash.addData( trailer );
+
+   qint64 pos = saveFile->pos();
+   if ( ok ) {
+      ok = saveFile->write( trailer ) == trailer.size() && saveFile->seek( 0 );
+   }
+   if ( ok ) {
+      QDataStream strm( saveFile.data() );
+      strm.setVersion( QDataStream::Qt_5_0 );
+      strm << ( quint32 )VKIDX_MAGIC << ( quint32 )VKIDX_VERSION
+           << stamp << bodyHash.result() << pos;
+      ok = ( strm.status() == QDataStream::Ok &&
+             saveFile->pos() == VKIDX_HEADER_SIZE );
+   }
+   if ( ok ) {
+      ok = saveFile->commit();
+   }
+
+   if ( !ok ) {
+      VK_DEBUG( "Not writing log index '%s': %s",
+                qPrintable( saveFile->fileName() ),
+                qPrintable( saveFile->errorString() ) );
+   }
+   cancelSave();
+   return ok;
+}
+
+
+/*!
+  Map the index for the given log, if it has a valid one.
+*/
+bool VgLogIndex::load( QString logfile )
+{
+   unmap();
+   docTag.clear();
+   nrecs = 0;
+
+   QString idxfile = indexPath( logfile );
+   if ( !QFile::exists( idxfile ) ) {
+      return false;
+   }
+
+   idxFile.setFileName( idxfile );
+   if ( !idxFile.open( QIODevice::ReadOnly ) ||
+        idxFile.size() < VKIDX_HEADER_SIZE ) {
+      idxFile.close();
+      return false;
+   }
+
+   map = idxFile.map( 0, idxFile.size() );
+   if ( map == 0 ) {
+      idxFile.close();
+      return false;
+   }
+
+   if ( !readIndex( logfile ) ) {
+      VK_DEBUG( "Ignoring out-of-date or bad log index '%s'", qPrintable( idxfile ) );
+      unmap();
+      docTag.clear();
+      nrecs = 0;
+      return false;
+   }
+   return true;
+}
+
+
+/*
+  Check the mapped index: its header, against the log and its own
+  checksum, then read its trailer.
+*/
+bool VgLogIndex::readIndex( QString logfile )
+{
+   qint64 size = idxFile.size();
+   const char* data = ( const char* )map;
+
+   QByteArray head = QByteArray::fromRawData( data, VKIDX_HEADER_SIZE );
+   QDataStream strm( head );
+   strm.setVersion( QDataStream::Qt_5_0 );
+
+   quint32 magic, version;
+   strm >> magic >> version;
+   if ( strm.status() != QDataStream::Ok ||
+        magic != VKIDX_MAGIC || version != VKIDX_VERSION ) {
+      return false;
+   }
+
+   VgLogStamp stamp, logStamp;
+   QByteArray sum;
+   strm >> stamp >> sum >> trailerPos;
+   if ( strm.status() != QDataStream::Ok ||
+        trailerPos < VKIDX_HEADER_SIZE || trailerPos > size ||
+        trailerPos - VKIDX_HEADER_SIZE > INT_MAX || size - trailerPos > INT_MAX ) {
+      return false;
+   }
+
+   if ( !logStamp.read( logfile ) || !( stamp == logStamp ) ) {
+      return false;
+   }
+
+   // all after the header must be just as written
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   for ( qint64 pos = VKIDX_HEADER_SIZE; pos < size; pos += VKIDX_SUM_BLOCK ) {
+      hash.addData( data + pos, ( int )qMin( size - pos, ( qint64 )VKIDX_SUM_BLOCK ) );
+   }
+   if ( hash.result() != sum ) {
+      return false;
+   }
+
+   // the trailer
+   QByteArray tail = QByteArray::fromRawData( data + trailerPos,
+                                              size - trailerPos );
+   QDataStream tstrm( tail );
+   tstrm.setVersion( QDataStream::Qt_5_0 );
+
+   // no record is smaller than its type and text
+   tstrm >> nrecs;
+   if ( tstrm.status() != QDataStream::Ok ||
+        nrecs > ( trailerPos - VKIDX_HEADER_SIZE ) / ( 4 + 4 ) ) {
+      return false;
+   }
+
+   QStringList strs;
+   tstrm >> docTag;
+   getStrings( tstrm, strs );
+   if ( tstrm.status() != QDataStream::Ok || !tstrm.atEnd() ||
+        docTag.isEmpty() ) {
+      return false;
+   }
+
+   atoms.reserve( strs.count() + 1 );
+   atoms.append( VkAtom() );
+   foreach( const QString& str, strs ) {
+      atoms.append( VkAtom( str ) );
+   }
+   return true;
+}
+
+
+/*
+  Done with any mapped index
+*/
+void VgLogIndex::unmap()
+{
+   if ( map != 0 ) {
+      idxFile.unmap( map );
+      map = 0;
+   }
+   idxFile.close();
+   atoms.clear();
+}
+
+
+/*!
+  Feed the loaded index's records to the given view, decoding each
+  from the mapping as it goes.
+*/
+bool VgLogIndex::replay( VgLogSink* lv, QString& errMsg )
+{
+   vk_assert( lv != 0 );
+   vk_assert( map != 0 );
+
+   bool ok = lv->init( docTag );
+   if ( !ok ) {
+      errMsg = "Failed log initialisation";
+   }
+
+   QByteArray body = QByteArray::fromRawData( ( const char* )map + VKIDX_HEADER_SIZE,
+                                              trailerPos - VKIDX_HEADER_SIZE );
+   QDataStream strm( body );
+   strm.setVersion( QDataStream::Qt_5_0 );
+
+   for ( quint32 i = 0; ok && i < nrecs; i++ ) {
+      VgLogRecord rec;
+      getRecord( strm, rec, atoms );
+      if ( strm.status() != QDataStream::Ok ) {
+         errMsg = "Bad log index: " + idxFile.fileName();
+         ok = false;
+      }
+      else if ( !lv->appendNode( rec, errMsg ) ) {
+         ok = false;
+      }
+      else if ( ( i % VG_LOG_REPLAY_STEP ) == 0 &&
+                !lv->loadProgress( i, nrecs ) ) {
+         errMsg = "Load cancelled";
+         ok = false;
+      }
+   }
+
+   unmap();
+   return ok;
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+** VgLogIndex definition
+**  - binary sidecar cache of a parsed valgrind xml log
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGINDEX_H
+#define __VGLOGINDEX_H
+
+#include "utils/vglogrecord.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// ============================================================
+/*!
+  VgLogIndex: sidecar cache (<logfile>.vkidx) of a parsed log
+
+   - While a log is parsed, sits between the reader and the view:
+     after startSave(), records are passed straight on, and written
+     to the index as they go: nothing's kept but the string table.
+   - The records are in a compact binary form: frame strings go in a
+     string table, frames hold indices into it.
+   - save() finishes the index off: it's written to a temporary file,
+     renamed over any old one only once complete.
+   - load() mmaps the index, and checks it against the log's
+     size, mtime and a (sampled) content hash, and its own contents
+     against the checksum in its header: replay() then decodes the
+     records straight from the mapping into a view, without touching
+     the xml at all.
+*/
+class VgLogIndex : public VgLogSink
+{
+public:
+   VgLogIndex( VgLogSink* lv = 0 );
+   ~VgLogIndex();
+
+   void setSink( VgLogSink* lv );
+
+   // VgLogSink: pass on to our sink, writing the index as we go
+   bool init( QString doc_tag );
+   bool appendNode( const VgLogRecord& rec, QString& errMsg );
+   bool loadProgress( qint64 done, qint64 total );
+
+   void startSave( QString logfile );
+   bool save();
+
+   bool load( QString logfile );
+   bool replay( VgLogSink* lv, QString& errMsg );
+
+   static QString indexPath( QString logfile );
+
+private:
+   bool openSave();
+   void cancelSave();
+   bool readIndex( QString logfile );
+   void unmap();
+
+private:
+   VgLogSink* logview;
+
+   QString docTag;
+   quint32 nrecs;
+
+   // writing: the log, and the index so far
+   QString logFile;
+   QScopedPointer<QSaveFile> saveFile;
+   QCryptographicHash bodyHash;
+   QHash<quint32, quint32> tableIds;   // global atom id -> table index
+   QStringList table;
+
+   // reading: the mapped index
+   QFile idxFile;
+   uchar* map;
+   qint64 trailerPos;
+   QVector<VkAtom> atoms;              // table index -> atom
+};
+
+#endif // #ifndef __VGLOGINDEX_H
@@ -0,0 +1,299 @@
+/****************************************************************************
+** VgLogInput implementation
+**  - byte stream from a valgrind xml log, plain or compressed
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgloginput.h"
+#include "utils/vk_utils.h"
+
+#include <zlib.h>
+#ifdef VK_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+// compressed bytes read from the file at a time
+#define VG_LOG_INPUT_BUF ( 64 * 1024 )
+
+
+
+/**********************************************************************/
+/*!
+  VgLogInput
+*/
+VgLogInput::VgLogInput()
+   : fmt( PLAIN ), inPos( 0 ), inLen( 0 ), stream( 0 )
+{ }
+
+VgLogInput::~VgLogInput()
+{
+   close();
+}
+
+
+/*!
+  Identify a log's format by its magic number
+*/
+VgLogInput::Format VgLogInput::sniffFormat( const QByteArray& magic )
+{
+   const uchar* m = ( const uchar* )magic.constData();
+
+   if ( magic.size() >= 2 && m[0] == 0x1f && m[1] == 0x8b ) {
+      return GZIP;
+   }
+   if ( magic.size() >= 4 && m[0] == 0x28 && m[1] == 0xb5 &&
+        m[2] == 0x2f && m[3] == 0xfd ) {
+      return ZSTD;
+   }
+   return PLAIN;
+}
+
+VgLogInput::Format VgLogInput::fileFormat( QString filepath )
+{
+   QFile f( filepath );
+   if ( !f.open( QIODevice::ReadOnly ) ) {
+      return PLAIN;
+   }
+   return sniffFormat( f.peek( 4 ) );
+}
+
+
+bool VgLogInput::open( QString filepath )
+{
+   close();
+
+   file.setFileName( filepath );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      errMsg = "Failed to open file: " + file.errorString();
+      return false;
+   }
+
+   // a log valgrind has only just created may not have 4 bytes yet:
+   // it's not compressed, in any case.
+   fmt = sniffFormat( file.peek( 4 ) );
+
+   switch ( fmt ) {
+   case PLAIN:
+      break;
+
+   case GZIP: {
+      z_stream* zs = new z_stream;
+      zs->zalloc = Z_NULL;
+      zs->zfree  = Z_NULL;
+      zs->opaque = Z_NULL;
+      zs->next_in  = Z_NULL;
+      zs->avail_in = 0;
+      // 15+32: max window, and expect a gzip (or zlib) header
+      if ( inflateInit2( zs, 15 + 32 ) != Z_OK ) {
+         delete zs;
+         errMsg = "Failed to initialise gzip decompression";
+         file.close();
+         return false;
+      }
+      stream = zs;
+      break;
+   }
+
+   case ZSTD:
+#ifdef VK_HAVE_ZSTD
+      stream = ZSTD_createDStream();
+      if ( stream == 0 ||
+           ZSTD_isError( ZSTD_initDStream( ( ZSTD_DStream* )stream ) ) ) {
+         errMsg = "Failed to initialise zstd decompression";
+         close();
+         return false;
+      }
+      break;
+#else
+      errMsg = "This build of Valkyrie can't read zstd-compressed logs.";
+      file.close();
+      return false;
+#endif
+   }
+
+   if ( fmt != PLAIN ) {
+      inBuf.resize( VG_LOG_INPUT_BUF );
+   }
+
+   return true;
+}
+
+
+void VgLogInput::close()
+{
+   if ( stream != 0 ) {
+      if ( fmt == GZIP ) {
+         z_stream* zs = ( z_stream* )stream;
+         inflateEnd( zs );
+         delete zs;
+      }
+#ifdef VK_HAVE_ZSTD
+      else if ( fmt == ZSTD ) {
+         ZSTD_freeDStream( ( ZSTD_DStream* )stream );
+      }
+#endif
+      stream = 0;
+   }
+
+   if ( file.isOpen() ) {
+      file.close();
+   }
+
+   fmt = PLAIN;
+   errMsg = QString();
+   inBuf.clear();
+   inPos = inLen = 0;
+}
+
+
+/*!
+  Read up to maxlen (decompressed) bytes into data.
+  Returns the number of bytes read: 0 if nothing there, -1 on error,
+  when errorString() says what went wrong.
+*/
+qint64 VgLogInput::read( char* data, qint64 maxlen )
+{
+   if ( !file.isOpen() || !errMsg.isEmpty() ) {
+      return -1;
+   }
+
+   switch ( fmt ) {
+   case GZIP:
+      return readGzip( data, maxlen );
+   case ZSTD:
+      return readZstd( data, maxlen );
+   default:
+      break;
+   }
+
+   qint64 nread = file.read( data, maxlen );
+   if ( nread < 0 ) {
+      errMsg = file.errorString();
+   }
+   return nread;
+}
+
+
+/*
+  Refill the input buffer, once the decoder has used it all.
+  Returns false at the end of the file, or on error.
+*/
+bool VgLogInput::fillInput()
+{
+   vk_assert( inPos == inLen );
+
+   inPos = inLen = 0;
+   qint64 nread = file.read( inBuf.data(), inBuf.size() );
+   if ( nread < 0 ) {
+      errMsg = file.errorString();
+      return false;
+   }
+
+   inLen = nread;
+   return nread > 0;
+}
+
+
+/*
+  Decoders may hold back output they've no room for, so are called
+  until they make no progress: not just until the input runs out.
+*/
+qint64 VgLogInput::readGzip( char* data, qint64 maxlen )
+{
+   z_stream* zs = ( z_stream* )stream;
+   qint64 nout = 0;
+
+   while ( nout < maxlen ) {
+      if ( inPos == inLen ) {
+         fillInput();
+         if ( !errMsg.isEmpty() ) {
+            break;
+         }
+      }
+
+      zs->next_in   = ( Bytef* )inBuf.data() + inPos;
+      zs->avail_in  = ( uInt )( inLen - inPos );
+      zs->next_out  = ( Bytef* )data + nout;
+      zs->avail_out = ( uInt )qMin( maxlen - nout, ( qint64 )0x40000000 );
+
+      int ret = inflate( zs, Z_NO_FLUSH );
+
+      qint64 used = ( inLen - inPos ) - zs->avail_in;
+      qint64 made = ( ( char* )zs->next_out - data ) - nout;
+      inPos += used;
+      nout  += made;
+
+      if ( ret == Z_STREAM_END ) {
+         // gzip members may be concatenated, as e.g. by 'cat a.gz b.gz'
+         inflateReset( zs );
+      }
+      else if ( ret != Z_OK && ret != Z_BUF_ERROR ) {
+         errMsg = QString( "gzip: " ) +
+                  ( zs->msg ? zs->msg : "corrupt data" );
+         break;
+      }
+      else if ( used == 0 && made == 0 ) {
+         break;   // end of file, or truncated
+      }
+   }
+
+   return ( nout == 0 && !errMsg.isEmpty() ) ? -1 : nout;
+}
+
+
+qint64 VgLogInput::readZstd( char* data, qint64 maxlen )
+{
+#ifdef VK_HAVE_ZSTD
+   ZSTD_DStream* zd = ( ZSTD_DStream* )stream;
+   ZSTD_outBuffer out = { data, ( size_t )maxlen, 0 };
+
+   while ( out.pos < out.size ) {
+      if ( inPos == inLen ) {
+         fillInput();
+         if ( !errMsg.isEmpty() ) {
+            break;
+         }
+      }
+
+      ZSTD_inBuffer in = { inBuf.constData() + inPos,
+                           ( size_t )( inLen - inPos ), 0
+                         };
+      size_t outPos = out.pos;
+
+      // concatenated frames are handled by the decoder itself
+      size_t ret = ZSTD_decompressStream( zd, &out, &in );
+      inPos += in.pos;
+
+      if ( ZSTD_isError( ret ) ) {
+         errMsg = QString( "zstd: " ) + ZSTD_getErrorName( ret );
+         break;
+      }
+      if ( in.pos == 0 && out.pos == outPos ) {
+         break;   // end of file, or truncated
+      }
+   }
+
+   qint64 nout = out.pos;
+   return ( nout == 0 && !errMsg.isEmpty() ) ? -1 : nout;
+#else
+   Q_UNUSED( data );
+   Q_UNUSED( maxlen );
+   vk_assert_never_reached();
+   return -1;
+#endif
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+** VgLogInput definition
+**  - byte stream from a valgrind xml log, plain or compressed
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGINPUT_H
+#define __VGLOGINPUT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VgLogInput: reads a log file, decompressing it on the fly
+
+   - The format is taken from the file's first bytes, not its name:
+     gzip (.xml.gz), zstd (.xml.zst, if built with VK_HAVE_ZSTD),
+     else plain.
+   - Compressed data is inflated straight into the caller's buffer:
+     memory use is one small input buffer, whatever the log size.
+   - A plain file is read as is, so a log still being written by
+     valgrind can be read as it grows.
+*/
+class VgLogInput
+{
+public:
+   enum Format { PLAIN, GZIP, ZSTD };
+
+   VgLogInput();
+   ~VgLogInput();
+
+   bool open( QString filepath );
+   void close();
+   bool isOpen() {
+      return file.isOpen();
+   }
+
+   qint64 read( char* data, qint64 maxlen );   // -1 on error
+
+   // how far through the file we are: compressed bytes, if compressed
+   qint64 pos() {
+      return file.pos() - ( inLen - inPos );
+   }
+   qint64 size() {
+      return file.size();
+   }
+
+   Format format() {
+      return fmt;
+   }
+   bool isCompressed() {
+      return fmt != PLAIN;
+   }
+   QString errorString() {
+      return errMsg;
+   }
+
+   static Format fileFormat( QString filepath );
+   static bool isCompressedFile( QString filepath ) {
+      return fileFormat( filepath ) != PLAIN;
+   }
+
+private:
+   static Format sniffFormat( const QByteArray& magic );
+
+   bool fillInput();
+   qint64 readGzip( char* data, qint64 maxlen );
+   qint64 readZstd( char* data, qint64 maxlen );
+
+private:
+   QFile file;
+   Format fmt;
+   QString errMsg;
+
+   QByteArray inBuf;      // compressed data, yet to be decoded
+   qint64 inPos;
+   qint64 inLen;
+
+   void* stream;          // z_stream / ZSTD_DStream
+};
+
+#endif // #ifndef __VGLOGINPUT_H
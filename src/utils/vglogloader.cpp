@@ -0,0 +1,305 @@
+/****************************************************************************
+** VgLogLoader implementation
+**  - loads a saved valgrind xml log, using all cores
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogloader.h"
+#include "utils/vgloginput.h"
+#include "utils/vglogreader.h"
+#include "utils/vglogsource.h"
+#include "utils/vk_utils.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#include <string.h>
+
+
+// don't bother splitting chunks smaller than this
+#define VG_LOG_MIN_CHUNK ( 1024 * 1024 )
+// chunks per thread, to even out the load
+#define VG_LOG_CHUNKS_PER_THREAD 4
+// nor try to decode chunks bigger than this
+#define VG_LOG_MAX_CHUNK ( 256 * 1024 * 1024 )
+// msecs between progress reports, while waiting on a chunk
+#define VG_LOG_WAIT_MSECS 50
+
+
+
+// ============================================================
+/*
+  Collects a chunk's records, unless the load's been cancelled
+*/
+class VgLogChunkSink : public VgLogCollector
+{
+public:
+   VgLogChunkSink( const QAtomicInt* flag )
+      : cancelled( flag ) { }
+
+   bool appendNode( const VgLogRecord& rec, QString& errMsg ) {
+      if ( cancelled->loadAcquire() != 0 ) {
+         errMsg = "Load cancelled";
+         return false;
+      }
+      return VgLogCollector::appendNode( rec, errMsg );
+   }
+
+private:
+   const QAtomicInt* cancelled;
+};
+
+
+
+// ============================================================
+/*
+  Decodes one chunk, on a pool thread
+*/
+class VgLogChunkTask : public QRunnable
+{
+public:
+   VgLogChunkTask( const QList<QByteArray>& chunk, qint64 size,
+                   const QAtomicInt* cancelled, QSemaphore* doneSem )
+      : parts( chunk ), bytes( size ), sink( cancelled ), ok( false ),
+        done( 0 ), anyDone( doneSem ) {
+      setAutoDelete( false );
+   }
+
+   void run() {
+      VgLogReader reader( &sink );
+      ok = reader.parseData( parts );
+      parts.clear();
+
+      done.storeRelease( 1 );
+      anyDone->release();
+   }
+
+   bool isDone() {
+      return done.loadAcquire() != 0;
+   }
+
+   QList<QByteArray> parts;   // the chunk, between any document tags
+   qint64 bytes;              // of the log
+   VgLogChunkSink sink;
+   bool ok;
+
+private:
+   QAtomicInt done;
+   QSemaphore* anyDone;
+};
+
+
+
+/**********************************************************************/
+/*!
+  VgLogLoader
+*/
+VgLogLoader::VgLogLoader( VgLogSink* lv )
+   : logview( lv ), m_bytes( 0 ), m_msecs( 0 ), m_threads( 0 )
+{ }
+
+
+bool VgLogLoader::load( QString filepath, int nthreads/*=0*/ )
+{
+   vk_assert( logview != 0 );
+
+   m_fatalMsg = QString();
+   m_bytes = m_msecs = 0;
+   m_threads = ( nthreads > 0 ) ? nthreads : QThread::idealThreadCount();
+   if ( m_threads < 1 ) {
+      m_threads = 1;
+   }
+
+   QElapsedTimer timer;
+   timer.start();
+
+   // compressed data can't be split: read it as a stream.
+   if ( VgLogInput::isCompressedFile( filepath ) ) {
+      return false;
+   }
+
+   QFile file( filepath );
+   if ( !file.open( QIODevice::ReadOnly ) || file.size() == 0 ) {
+      return false;
+   }
+
+   uchar* map = file.map( 0, file.size() );
+   if ( map == 0 ) {
+      return false;
+   }
+
+   m_bytes = file.size();
+
+   qint64 nchunks = m_threads * VG_LOG_CHUNKS_PER_THREAD;
+   if ( m_bytes / nchunks < VG_LOG_MIN_CHUNK ) {
+      nchunks = qMax( ( qint64 )1, m_bytes / VG_LOG_MIN_CHUNK );
+   }
+   nchunks = qMax( nchunks, m_bytes / ( VG_LOG_MAX_CHUNK / 2 ) + 1 );
+
+   QByteArray docTag;
+   QList<QByteArray> chunks = splitLog( ( const char* )map, m_bytes,
+                                        ( int )nchunks, docTag );
+   if ( chunks.isEmpty() ) {
+      file.unmap( map );
+      return false;
+   }
+
+   // each chunk is read straight from the mapping: the document tags
+   // it needs to be well-formed are separate parts.
+   const QByteArray openDoc  = "<" + docTag + ">";
+   const QByteArray closeDoc = "</" + docTag + ">";
+
+   // decode ---------------------------------------------------------
+   QVector<VgLogChunkTask*> tasks;
+   QThreadPool pool;
+   QAtomicInt cancelled( 0 );
+   QSemaphore anyDone;
+   pool.setMaxThreadCount( m_threads );
+
+   for ( int i = 0; i < chunks.count(); i++ ) {
+      QList<QByteArray> parts;
+      if ( i > 0 ) {
+         parts << openDoc;
+      }
+      parts << chunks[i];
+      if ( i < chunks.count() - 1 ) {
+         parts << closeDoc;
+      }
+
+      VgLogChunkTask* task = new VgLogChunkTask( parts, chunks[i].size(),
+                                                 &cancelled, &anyDone );
+      tasks.append( task );
+      pool.start( task );
+   }
+   chunks.clear();
+
+   // merge, in document order, as the chunks come in -----------------
+   bool ok = true;
+   qint64 merged = 0;   // bytes of the log handed on so far
+
+   for ( int i = 0; ok && i < tasks.count(); i++ ) {
+      VgLogChunkTask* task = tasks[i];
+
+      while ( ok && !task->isDone() ) {
+         anyDone.tryAcquire( 1, VG_LOG_WAIT_MSECS );
+         if ( !logview->loadProgress( merged, m_bytes ) ) {
+            m_fatalMsg = "Load cancelled";
+            ok = false;
+         }
+      }
+      if ( !ok || !task->ok ) {
+         ok = false;   // cancelled, or a bad chunk (no fatalMsg: fall back)
+         break;
+      }
+
+      if ( i == 0 ) {
+         ok = logview->init( task->sink.docTag );
+         if ( !ok ) {
+            m_fatalMsg = "Failed log initialisation";
+         }
+      }
+
+      for ( int r = 0; ok && r < task->sink.records.count(); r++ ) {
+         ok = logview->appendNode( task->sink.records[r], m_fatalMsg );
+      }
+      task->sink.records.clear();
+
+      merged = qMin( merged + task->bytes, m_bytes );
+   }
+
+   // stop any chunks still being decoded
+   if ( !ok ) {
+      cancelled.storeRelease( 1 );
+   }
+   pool.waitForDone();
+
+   // the chunks refer to the mapped data: done with it now.
+   file.unmap( map );
+
+   qDeleteAll( tasks );
+
+   m_msecs = timer.elapsed();
+   return ok;
+}
+
+
+/*!
+  Split a complete log into nchunks, for load():
+   - cut just after a top-level </error>
+     (no nested element shares the tagname, and the text can't contain it)
+   - the chunks refer to the log's data: no copying.
+     All but the first need the document start tag before them,
+     all but the last the document end tag after, to be well-formed.
+  Returns an empty list if the log doesn't look like we expect.
+*/
+QList<QByteArray> VgLogLoader::splitLog( const char* log, qint64 size,
+                                         int nchunks, QByteArray& docTag )
+{
+   QList<QByteArray> chunks;
+
+   qint64 bodyStart;
+   docTag = VgLogSource::findDocTag( log, size, bodyStart );
+   if ( docTag.isEmpty() ) {
+      return chunks;
+   }
+
+   const char* cutTag = "</error>";
+
+   // cut points
+   QVector<qint64> cuts;
+   qint64 bodyLen = size - bodyStart;
+   for ( int i = 1; i < nchunks; i++ ) {
+      qint64 from = bodyStart + bodyLen * i / nchunks;
+      if ( !cuts.isEmpty() && from < cuts.last() ) {
+         from = cuts.last();
+      }
+      qint64 cut = VgLogSource::findBytes( log, size, from, cutTag );
+      if ( cut == -1 ) {
+         break;
+      }
+      cut += strlen( cutTag );
+      if ( cuts.isEmpty() || cut > cuts.last() ) {
+         cuts.append( cut );
+      }
+   }
+
+   // QByteArray sizes are int: give up on anything too big.
+   qint64 start = 0;
+   for ( int i = 0; i <= cuts.count(); i++ ) {
+      qint64 end = ( i < cuts.count() ) ? cuts[i] : size;
+      if ( end - start > VG_LOG_MAX_CHUNK ) {
+         chunks.clear();
+         return chunks;
+      }
+      start = end;
+   }
+
+   start = 0;
+   for ( int i = 0; i <= cuts.count(); i++ ) {
+      qint64 end = ( i < cuts.count() ) ? cuts[i] : size;
+      chunks.append( QByteArray::fromRawData( log + start, end - start ) );
+      start = end;
+   }
+
+   return chunks;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+** VgLogLoader definition
+**  - loads a saved valgrind xml log, using all cores
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGLOADER_H
+#define __VGLOGLOADER_H
+
+#include "utils/vglogrecord.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VgLogLoader: loads a complete (saved) log into a VgLogSink.
+
+   - The log is mmap'd, and split into chunks at top-level </error>
+     boundaries (the bulk of any large log).
+   - Each chunk is decoded straight from the mapping, by its own
+     VgLogReader on a thread pool: the document tags it needs either
+     side are handed to the reader as separate parts.
+   - Records are handed to the sink in document order, in the calling
+     thread, as each chunk (and all those before it) is decoded ok.
+   - While waiting on a chunk, the sink's loadProgress() is called
+     every so often: if it says stop, all decoding stops.
+
+  If the log is compressed, can't be mapped or split, or any chunk
+  fails to parse, load() returns false with no fatalMsg(): callers
+  should fall back to a plain VgLogReader::parse(), which also gives
+  exact error positions. Note the sink may already have had the
+  records of the chunks before the bad one.
+*/
+class VgLogLoader
+{
+public:
+   VgLogLoader( VgLogSink* lv );
+
+   bool load( QString filepath, int nthreads = 0 );  // 0: one per core
+
+   /* set if the sink rejected a record: no point falling back */
+   QString fatalMsg() {
+      return m_fatalMsg;
+   }
+
+   // stats from the last load()
+   qint64 bytes() {
+      return m_bytes;
+   }
+   qint64 msecs() {
+      return m_msecs;
+   }
+   int threads() {
+      return m_threads;
+   }
+
+private:
+   QList<QByteArray> splitLog( const char* log, qint64 size, int nchunks,
+                               QByteArray& docTag );
+
+private:
+   VgLogSink* logview;
+
+   QString m_fatalMsg;
+   qint64  m_bytes;
+   qint64  m_msecs;
+   int     m_threads;
+};
+
+#endif // #ifndef __VGLOGLOADER_H
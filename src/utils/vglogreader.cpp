@@ -19,22 +19,29 @@
 ****************************************************************************/
 
 #include "utils/vglogreader.h"
+#include "utils/vglogtokenizer.h"
 #include "utils/vk_utils.h"
 
+#include <QFile>
+
+
+// adaptive read size: bytes read from the log per readChunk()
+#define VG_LOG_READ_MIN    ( 4 * 1024 )
+#define VG_LOG_READ_START  ( 64 * 1024 )
+#define VG_LOG_READ_MAX    ( 4 * 1024 * 1024 )
+
+// a mapped log reports progress every so many bytes
+#define VG_LOG_PROGRESS_STEP  ( 4 * 1024 * 1024 )
+
 
 /**********************************************************************/
 /*!
   VgLogReader
 */
-VgLogReader::VgLogReader( VgLogView* lv )
-   : vghandler( 0 ), source( 0 )
+VgLogReader::VgLogReader( VgLogSink* lv )
+   : vghandler( 0 ), readSize( VG_LOG_READ_START ), fastPath( true )
 {
    vghandler = new VgLogHandler( lv );
-   setContentHandler( vghandler );
-   setErrorHandler( vghandler );
-   //  setLexicalHandler( vghandler );
-   //  setDeclHandler( vghandler );
-   //  setDTDHandler( vghandler );
 }
 
 VgLogReader::~VgLogReader()
@@ -44,109 +51,479 @@ VgLogReader::~VgLogReader()
       vghandler = 0;
    }
 
-   if ( source ) {
-      delete source;
-      source = 0;
+   input.close();
+}
+
+bool VgLogReader::parse( QString filepath, bool incremental/*=false*/ )
+{
+   input.close();
+
+   xml.clear();
+   vghandler->startDocument();
+
+   if ( !input.open( filepath ) ) {
+      vghandler->fatalError( input.errorString(), 0, 0 );
+      return false;
+   }
+
+   readSize = VG_LOG_READ_START;
+
+   if ( incremental ) {
+      return parseContinue();
    }
 
-   if ( file.isOpen() ) {
-      file.close();
+   if ( fastPath && !input.isCompressed() ) {
+      bool ok;
+      if ( parseMapped( filepath, ok ) ) {
+         input.close();
+         return ok;
+      }
    }
+
+   // read the lot.
+   while ( readChunk() > 0 ) {
+      if ( !parseTokens( true ) ) {
+         return false;
+      }
+      if ( !vghandler->loadProgress( input.pos(), input.size() ) ) {
+         vghandler->fatalError( "Load cancelled", 0, 0 );
+         return false;
+      }
+   }
+
+   // no more data: anything still incomplete is an error.
+   if ( !parseTokens( false ) ) {
+      return false;
+   }
+
+   return vghandler->finished();
 }
 
-bool VgLogReader::parse( QString filepath, bool incremental/*=false*/ )
+/*!
+  Parse a complete in-memory document (e.g. a chunk of a mapped log)
+*/
+bool VgLogReader::parseData( const QByteArray& data )
 {
-   if ( source ) {
-      delete source;
+   return parseData( QList<QByteArray>() << data );
+}
+
+/*!
+  Parse a complete document, given in consecutive parts
+   - e.g. a chunk of a mapped log, with the document tags either side:
+     the tokenizer takes the parts as they are, and they're only
+     copied (into QXmlStreamReader) if it can't cope.
+   - each part must end between tags.
+*/
+bool VgLogReader::parseData( const QList<QByteArray>& parts )
+{
+   input.close();
+
+   xml.clear();
+   vghandler->startDocument();
+
+   if ( fastPath ) {
+      VgLogTokenizer tokenizer( vghandler );
+      bool ok;
+      if ( fastResult( tokenizer.parse( parts ), ok ) ) {
+         return ok;
+      }
+   }
+
+   foreach( const QByteArray& part, parts ) {
+      xml.addData( part );
+   }
+   if ( !parseTokens( false ) ) {
+      return false;
+   }
+
+   return vghandler->finished();
+}
+
+/*!
+  Parse a plain log straight from the page cache: no copying.
+   - false if it can't be done that way (e.g. can't be mapped):
+     the caller's to read it instead.
+*/
+bool VgLogReader::parseMapped( QString filepath, bool& ok )
+{
+   QFile file( filepath );
+   if ( !file.open( QIODevice::ReadOnly ) || file.size() == 0 ) {
+      return false;
    }
 
-   if ( file.isOpen() ) {
-      file.close();
+   qint64 size = file.size();
+   uchar* map = file.map( 0, size );
+   if ( map == 0 ) {
+      return false;
    }
 
-   file.setFileName( filepath );
-   source = new QXmlInputSource( &file );
-   return QXmlSimpleReader::parse( source, incremental );
+   bool done = parseFast( ( const char* )map, size, VG_LOG_PROGRESS_STEP, ok );
+   file.unmap( map );
+   return done;
 }
 
+/*!
+  Try VgLogTokenizer on a complete document
+   - false if it couldn't cope: the handler's been set to start over,
+     without handing on again the records it already has.
+   - else ok gets the result, as for parseTokens().
+*/
+bool VgLogReader::parseFast( const char* data, qint64 size,
+                             qint64 progressStep, bool& ok )
+{
+   VgLogTokenizer tokenizer( vghandler );
+   tokenizer.setProgressStep( progressStep );
+
+   return fastResult( tokenizer.parse( data, size ), ok );
+}
+
+/*!
+  What to make of the tokenizer's result: as for parseFast()
+*/
+bool VgLogReader::fastResult( VgLogTokenizer::Result res, bool& ok )
+{
+   switch ( res ) {
+   case VgLogTokenizer::OK:
+      ok = vghandler->finished();
+      return true;
+
+   case VgLogTokenizer::FAILED:
+      ok = false;
+      return true;
+
+   case VgLogTokenizer::UNSUPPORTED:
+      break;
+   }
+
+   vghandler->restartDocument();
+   return false;
+}
+
+/*!
+  Start parsing a log that's handed to us a bit at a time
+*/
+void VgLogReader::startStream()
+{
+   input.close();
+
+   xml.clear();
+   vghandler->startDocument();
+}
+
+/*!
+  Parse the next lot of a streamed log.
+   - an incomplete document is fine, unless there's no more to come.
+*/
+bool VgLogReader::parseStream( const QByteArray& data, bool atEnd )
+{
+   if ( !data.isEmpty() ) {
+      xml.addData( data );
+   }
+
+   return parseTokens( !atEnd );
+}
+
+/*!
+  Parse all the new data available from the log.
+   - read & parse a chunk at a time, until we catch up with the writer,
+     so a burst of output is taken in one go, in bounded memory.
+  An incomplete document is fine: we'll be called again.
+*/
 bool VgLogReader::parseContinue()
 {
-   if ( source ) {
-      source->fetchData();
+   if ( !input.isOpen() ) {
+      return false;
+   }
+
+   for ( ;; ) {
+      qint64 nread = readChunk();
+
+      if ( !parseTokens( true ) ) {
+         return false;
+      }
+      if ( nread <= 0 || vghandler->finished() ) {
+         break;
+      }
+   }
+
+   return true;
+}
+
+/*!
+  Feed the next chunk of the log to the xml reader
+  Returns the number of bytes read: 0 if nothing there.
+
+  The read size adapts to the rate the log is being written:
+   - a full read means there's a backlog: double it.
+   - a mostly-empty read means we're keeping up: halve it.
+  so a quiet log costs small reads, and a flood is taken in large gulps.
+  (A compressed log always fills the buffer, so is read in large gulps.)
+*/
+qint64 VgLogReader::readChunk()
+{
+   if ( readBuf.size() < readSize ) {
+      readBuf.resize( readSize );
+   }
+
+   qint64 nread = input.read( readBuf.data(), readSize );
+   if ( nread < 0 ) {
+      // e.g. corrupt compressed data: report it as a parse error
+      xml.raiseError( "Failed to read log: " + input.errorString() );
+      return 0;
+   }
+   if ( nread == 0 ) {
+      return 0;
    }
 
-   return QXmlSimpleReader::parseContinue();
+   if ( nread == readSize ) {
+      readSize = qMin( readSize * 2, ( qint64 )VG_LOG_READ_MAX );
+   }
+   else if ( nread < readSize / 4 ) {
+      readSize = qMax( readSize / 2, ( qint64 )VG_LOG_READ_MIN );
+   }
+
+   // addData() copies: no need for a fresh buffer each time
+   xml.addData( QByteArray::fromRawData( readBuf.constData(), nread ) );
+   return nread;
 }
 
+/*!
+  Pull tokens until we run out of data, passing them to the handler.
+   - If the handler bails, report it as a fatal error, as
+     QXmlSimpleReader used to.
+*/
+bool VgLogReader::parseTokens( bool incremental )
+{
+   while ( !xml.atEnd() ) {
+      bool ok = true;
+
+      switch ( xml.readNext() ) {
+      case QXmlStreamReader::StartElement:
+         ok = vghandler->startElement( xml.name() );
+         break;
+
+      case QXmlStreamReader::EndElement:
+         ok = vghandler->endElement();
+         break;
+
+      case QXmlStreamReader::Characters:
+         ok = vghandler->characters( xml.text() );
+         break;
+
+      case QXmlStreamReader::EndDocument:
+         ok = vghandler->endDocument();
+         break;
+
+      default:
+         // StartDocument, comments, DTD, etc: nothing to do.
+         break;
+      }
+
+      if ( !ok ) {
+         xml.raiseError( "error triggered by consumer" );
+         break;
+      }
+   }
+
+   if ( xml.hasError() ) {
+      if ( incremental &&
+           xml.error() == QXmlStreamReader::PrematureEndOfDocumentError ) {
+         // just ran out of data: wait for more.
+         return true;
+      }
+
+      vghandler->fatalError( xml.errorString(),
+                             xml.lineNumber(), xml.columnNumber() );
+      return false;
+   }
+
+   return true;
+}
+
+
 
 /**********************************************************************/
 /* VgLogHandler */
-VgLogHandler::VgLogHandler( VgLogView* lv )
+
+// initial capacity of the leaf text buffer
+#define VG_LOG_CHARS_RESERVE 256
+
+static bool isWhiteSpace( const QStringRef& ch )
+{
+   const QChar* c = ch.unicode();
+   for ( int i = 0; i < ch.size(); i++ ) {
+      if ( !c[i].isSpace() ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+static bool isWhiteSpace( const char* ch, int len )
+{
+   for ( int i = 0; i < len; i++ ) {
+      if ( ch[i] != ' ' && ( ch[i] < '\t' || ch[i] > '\r' ) ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/*
+  As QString::simplified(), but in place: no allocation
+   - and nothing at all to do for the usual, already simple, text.
+*/
+static void simplifyText( QString& str )
+{
+   const QChar* c = str.constData();
+   int len = str.size();
+
+   int i = 0;
+   for ( ; i < len; i++ ) {
+      if ( c[i].isSpace() &&
+           ( c[i] != QLatin1Char( ' ' ) || i == 0 || i == len - 1 ||
+             c[i + 1].isSpace() ) ) {
+         break;
+      }
+   }
+   if ( i == len ) {
+      return;
+   }
+
+   QChar* d = str.data();
+   int n = 0;
+   bool space = false;
+   for ( i = 0; i < len; i++ ) {
+      if ( d[i].isSpace() ) {
+         space = ( n > 0 );
+         continue;
+      }
+      if ( space ) {
+         d[n++] = QLatin1Char( ' ' );
+         space = false;
+      }
+      d[n++] = d[i];
+   }
+   str.resize( n );
+}
+
+/*
+  An exact-size copy: sharing the buffer would force it to detach
+  (and reallocate) on the next append.
+*/
+static inline QString textCopy( const QString& str )
+{
+   return QString( str.unicode(), str.size() );
+}
+VgLogHandler::VgLogHandler( VgLogSink* lv )
 {
    logview = lv;
-   node = doc;
    m_finished = false;
    m_started = false;
+   m_inited = false;
+   m_records = 0;
+   m_skip = 0;
+   chars.reserve( VG_LOG_CHARS_RESERVE );
 }
 
 VgLogHandler::~VgLogHandler()
 { }
 
-/* gets <?xml...> element */
-bool VgLogHandler::processingInstruction( const QString& target, const QString& data )
+bool VgLogHandler::startElement( const QStringRef& tag )
 {
-   //  vkPrintErr("VgLogHandler::processingInstruction: %s, %s", target.latin1(), data.latin1());
-   doc.appendChild( doc.createProcessingInstruction( target, data ) );
-   node = doc;
-   return true;
+   //  vkPrintErr("VgLogHandler::startElement: '%s'", qPrintable( tag.toString() ));
+   VG_ELEM::ElemType etype = VG_ELEM::elemType( tag.unicode(), tag.size() );
+
+   if ( path.count() > 1 ) {
+      startSubElement( etype );
+      return true;
+   }
+   return startTopElement( etype, tag.toString() );
 }
 
-bool VgLogHandler::startElement( const QString&, const QString&,
-                                 const QString& tag,
-                                 const QXmlAttributes& )
+bool VgLogHandler::startElement( const char* tag, int len )
 {
-   //  vkPrintErr("VgLogHandler::startElement: '%s'", tag.latin1());
-   QDomNode n = doc.createElement( tag );
-   node.appendChild( n );
-   node = n;
+   VG_ELEM::ElemType etype = VG_ELEM::elemType( tag, len );
 
-   if ( node == doc.documentElement() ) {
-      QDomProcessingInstruction xml_insn =
-         doc.firstChild().toProcessingInstruction();
-      if ( ! logview->init( xml_insn, tag ) ) {
+   if ( path.count() > 1 ) {
+      startSubElement( etype );
+      return true;
+   }
+   return startTopElement( etype, QString::fromLatin1( tag, len ) );
+}
+
+/*
+  The document element, or a top-level one
+*/
+bool VgLogHandler::startTopElement( VG_ELEM::ElemType etype, const QString& tag )
+{
+   chars.resize( 0 );
+
+   if ( path.isEmpty() ) {
+      // document element
+      path.push_back( etype );
+      if ( m_inited ) {
+         return true;   // restarted: the logview already has it
+      }
+      if ( ! logview->init( tag ) ) {
          //VK_DEBUG("Error: Failed log initialisation");
          return false;
       }
+      m_inited = true;
+      return true;
+   }
+
+   // start of a top-level element
+   if ( etype == VG_ELEM::NUM_ELEMS ) {
+      m_fatalMsg = "Unrecognised tagname: (" + tag + ")";
+      vkPrintErr( "%s", qPrintable( "VgLogHandler::startElement(): " + m_fatalMsg ) );
+      return false;
    }
+   rec.clear();
+   rec.type = etype;
+   supp.clear();
 
+   path.push_back( etype );
    return true;
 }
 
-bool VgLogHandler::endElement( const QString&, const QString&,
-                               const QString& /*tag*/ )
+void VgLogHandler::startSubElement( VG_ELEM::ElemType etype )
 {
-   // vkPrintErr("VgLogHandler::endElement: %s", qPrintable( tag ));
-   // Should never have end element at doc level
-   if ( node == doc ) {
-      //VK_DEBUG("VgLogHandler::endElement(): Error: node == doc");
-      return false;
+   chars.resize( 0 );
+
+   switch ( etype ) {
+   case VG_ELEM::PAIR:
+      rec.counts.append( VgCountPair() );
+      break;
+   case VG_ELEM::FRAME:
+      frame = VgFrame();
+      break;
+   case VG_ELEM::STACK:
+      stack.clear();
+      break;
+   default:
+      break;
    }
 
-   QDomNode prnt = node.parentNode();
+   // unknown nested elements are kept on the path, but otherwise ignored
+   path.push_back( etype );
+}
 
-   /* if closing a top-level tag, append to vglog */
-   if ( prnt == doc.documentElement() ) {
-      QString errMsg;
-      if ( ! logview->appendNode( node, errMsg ) ) {
-         //VK_DEBUG("Failed to append node");
-         m_fatalMsg = errMsg;
-         return false;
-      }
+bool VgLogHandler::endElement()
+{
+   // vkPrintErr("VgLogHandler::endElement");
+   // Should never have end element at doc level
+   if ( path.isEmpty() ) {
+      //VK_DEBUG("VgLogHandler::endElement(): Error: path isEmpty");
+      return false;
    }
 
-   node = prnt;
+   VG_ELEM::ElemType etype = path.back();
+   path.pop_back();
 
-   if ( node == doc ) {
+   bool ok = true;
+
+   if ( path.isEmpty() ) {
       /* In case we get bad xml after the closing tag, mark as 'finished'
          This may happed, for example, as a result of doing fork() but
          not exec() under valgrind.  When the process forks, you wind up
@@ -155,29 +532,252 @@ bool VgLogHandler::endElement( const QString&, const QString&,
       */
       m_finished = true;
    }
+   else if ( path.count() == 1 ) {
+      /* if closing a top-level tag, append to vglog */
+      simplifyText( chars );
+      rec.text = textCopy( chars );
+      ok = endRecord();
+   }
+   else {
+      simplifyText( chars );
+      endSubElement( etype, path.back(), chars );
+   }
 
-   return true;
+   chars.resize( 0 );
+   return ok;
 }
 
-bool VgLogHandler::characters( const QString&  ch )
+bool VgLogHandler::characters( const QStringRef& ch )
 {
-   //  vkPrintErr("characters: '%s'", ch.latin1());
-   // No text as child of some document
-   if ( node == doc ) {
-      return false;
-   }
+   //  vkPrintErr("characters: '%s'", qPrintable( ch.toString() ));
 
    /* ignore text as child of doc_elem
       => valgrind non-xml output (shouldn't happen), or client output */
-   if ( node == doc.documentElement() ) {
+   if ( path.count() <= 1 ) {
+      return true;
+   }
+
+   /* leading whitespace is dropped anyway: this skips all the
+      indentation between tags, without touching the buffer */
+   if ( chars.isEmpty() && isWhiteSpace( ch ) ) {
+      return true;
+   }
+
+   chars.append( ch );
+   return true;
+}
+
+bool VgLogHandler::characters( const char* ch, int len, bool ascii )
+{
+   if ( path.count() <= 1 ) {
+      return true;
+   }
+
+   if ( chars.isEmpty() && isWhiteSpace( ch, len ) ) {
       return true;
    }
 
-   QString chars = ch.simplified();
+   if ( ascii ) {
+      // widen in place: no codec, no temporary
+      int n = chars.size();
+      chars.resize( n + len );
+      QChar* d = chars.data() + n;
+      for ( int i = 0; i < len; i++ ) {
+         d[i] = QLatin1Char( ch[i] );
+      }
+   }
+   else {
+      chars.append( QString::fromUtf8( ch, len ) );
+   }
+   return true;
+}
+
+/*!
+  Store the contents of a completed (non top-level) element
+  into the current record.
+   - 'text' is our reusable buffer: anything kept must be copied out
+     via textCopy(). Atoms & numbers need no copy at all.
+*/
+void VgLogHandler::endSubElement( VG_ELEM::ElemType etype,
+                                  VG_ELEM::ElemType parent,
+                                  const QString& text )
+{
+   VgError& err = rec.error;
+
+   switch ( etype ) {
+   // preamble, logfilequalifier, args
+   case VG_ELEM::VAR:
+   case VG_ELEM::VALUE:
+      rec.lines << textCopy( text );
+      break;
+
+   case VG_ELEM::EXE:
+   case VG_ELEM::ARG:
+      if ( parent == VG_ELEM::VARGV ) {
+         rec.lines << textCopy( text );
+      }
+      else if ( parent == VG_ELEM::ARGV ) {
+         rec.argv << textCopy( text );
+      }
+      break;
+
+   // status
+   case VG_ELEM::STATE:
+      rec.status.state = textCopy( text );
+      break;
+   case VG_ELEM::TIME:
+      rec.status.time = textCopy( text );
+      break;
+
+   // errorcounts, suppcounts
+   case VG_ELEM::COUNT:
+      if ( parent == VG_ELEM::PAIR && !rec.counts.isEmpty() ) {
+         rec.counts.last().count = text.toInt();
+      }
+      break;
+   case VG_ELEM::NAME:
+      if ( parent == VG_ELEM::PAIR && !rec.counts.isEmpty() ) {
+         rec.counts.last().key = textCopy( text );
+      }
+      break;
+   case VG_ELEM::UNIQUE:
+      if ( parent == VG_ELEM::PAIR && !rec.counts.isEmpty() ) {
+         rec.counts.last().key = textCopy( text );
+      }
+      else {
+         err.unique = textCopy( text );
+      }
+      break;
+
+   // error, announcethread, fatal_signal
+   case VG_ELEM::TID:
+      err.tid = textCopy( text );
+      err.parts << VgErrorPart( etype, err.tid );
+      break;
+   case VG_ELEM::KIND:
+      err.kind = textCopy( text );
+      break;
+   case VG_ELEM::WHAT:
+   case VG_ELEM::AUXWHAT:
+      err.parts << VgErrorPart( etype, textCopy( text ) );
+      break;
+   case VG_ELEM::TEXT:
+      if ( parent == VG_ELEM::XWHAT || parent == VG_ELEM::XAUXWHAT ) {
+         err.parts << VgErrorPart( parent, textCopy( text ) );
+      }
+      break;
+   case VG_ELEM::LEAKEDBYTES:
+      err.leakedBytes = text.toULongLong();
+      err.hasLeak = true;
+      break;
+   case VG_ELEM::LEAKEDBLOCKS:
+      err.leakedBlocks = text.toULongLong();
+      break;
+   case VG_ELEM::HTHREADID:
+      // only the announced thread: xwhat's hthreadid is within the text
+      if ( parent == rec.type ) {
+         err.parts << VgErrorPart( etype, textCopy( text ) );
+      }
+      break;
+
+   // stack
+   case VG_ELEM::IP:      frame.ip   = text.toULongLong( 0, 0 );  break;
+   case VG_ELEM::FN:      frame.fn   = VkAtom( text );            break;
+   case VG_ELEM::SRCDIR:  frame.dir  = VkAtom( text );            break;
+   case VG_ELEM::SRCFILE: frame.file = VkAtom( text );            break;
+   case VG_ELEM::LINE:
+      if ( parent == VG_ELEM::FRAME ) {
+         bool ok;
+         frame.line = text.toInt( &ok );
+         if ( !ok ) frame.line = -1;
+      }
+      else {
+         rec.lines << textCopy( text );   // preamble
+      }
+      break;
+   case VG_ELEM::OBJ:
+      if ( parent == VG_ELEM::SFRAME ) {
+         supp << "obj:" + text;
+      }
+      else {
+         frame.obj = VkAtom( text );
+      }
+      break;
+   case VG_ELEM::FRAME:
+      stack.append( frame );
+      break;
+   case VG_ELEM::STACK:
+      err.parts << VgErrorPart( etype, QString(), err.stacks.count() );
+      err.stacks.append( stack );
+      break;
+
+   // suppression
+   case VG_ELEM::SNAME:
+   case VG_ELEM::SKIND:
+   case VG_ELEM::SKAUX:
+      supp << textCopy( text );
+      break;
+   case VG_ELEM::SFUN:
+      supp << "fun:" + text;
+      break;
+   case VG_ELEM::SUPPRESSION:
+      err.suppression = supp.join( "\n" );
+      break;
+
+   default:
+      // rawtext, fatal_signal details, etc: ignore.
+      break;
+   }
+}
+
+/*!
+  A top-level element is complete: hand it over to the logview
+*/
+bool VgLogHandler::endRecord()
+{
+   if ( m_records++ < m_skip ) {
+      return true;   // handed on before a restart
+   }
+
+   VgError& err = rec.error;
+
+   switch ( rec.type ) {
+   case VG_ELEM::ERROR:
+   case VG_ELEM::ANNOUNCETHREAD:
+   case VG_ELEM::FATAL_SIGNAL: {
+      // unclear what we can expect re what/xwhat.
+      //  - give 'what' preference over 'xwhat'.
+      foreach( const VgErrorPart& part, err.parts ) {
+         if ( part.type == VG_ELEM::WHAT ) {
+            err.what = part.text;
+            break;
+         }
+         if ( part.type == VG_ELEM::XWHAT && err.what.isEmpty() ) {
+            err.what = part.text;
+         }
+      }
+      rec.text.clear();
+      break;
+   }
+
+   case VG_ELEM::PREAMBLE:
+   case VG_ELEM::LOGQUAL:
+   case VG_ELEM::ARGS:
+   case VG_ELEM::STATUS:
+   case VG_ELEM::ERRORCOUNTS:
+   case VG_ELEM::SUPPCOUNTS:
+      rec.text.clear();
+      break;
+
+   default:
+      break;
+   }
 
-   if ( !chars.isEmpty() ) {
-      node.appendChild( doc.createTextNode( chars ) );
-      //    vkPrintErr("chars: '%s'", chars.latin1());
+   QString errMsg;
+   if ( ! logview->appendNode( rec, errMsg ) ) {
+      //VK_DEBUG("Failed to append node");
+      m_fatalMsg = errMsg;
+      return false;
    }
 
    return true;
@@ -189,51 +789,56 @@ bool VgLogHandler::startDocument()
    //   vkPrintErr("VgLogHandler::startDocument()\n");
    vk_assert( logview != 0 );
 
-   doc = QDomDocument();
-   node = doc;
+   path.clear();
+   chars.resize( 0 );
+   rec.clear();
    m_fatalMsg = QString();
    m_finished = false;
    m_started = true;
+   m_inited = false;
+   m_records = 0;
+   m_skip = 0;
    return true;
 }
 
+/* Start parsing the same document again, from the top
+   (VgLogTokenizer gave up): the logview already has what's been
+   handed on so far, so that's skipped.
+*/
+void VgLogHandler::restartDocument()
+{
+   bool inited = m_inited;
+   int skip = m_records;
+
+   startDocument();
+   m_inited = inited;
+   m_skip = skip;
+}
+
 /* Called by xml reader after it has finished parsing
    Checks we have a complete document,
-   i.e. endElement() has returned node ptr to root
+   i.e. endElement() has closed the document element
 */
 bool VgLogHandler::endDocument()
 {
    //   vkPrintErr("VgLogHandler::endDocument()\n");
    m_finished = true;
 
-   if ( node != doc ) {
+   if ( !path.isEmpty() ) {
       return false;
    }
 
    return true;
 }
 
-/* non-fatal error: just report it */
-bool VgLogHandler::error( const QXmlParseException& exception )
-{
-   //   vkPrintErr("VgLogHandler::error");
-   QString err = exception.message() +
-                 " (line: " + QString::number( exception.lineNumber() ) +
-                 ", col: " + QString::number( exception.columnNumber() ) + ")";
-
-   // printf("VgLogHandler::non-fatal error: %s", err.latin1());
-
-   return true; /* try to continue. */
-}
-
-bool VgLogHandler::fatalError( const QXmlParseException& exception )
+bool VgLogHandler::fatalError( const QString& msg, qint64 line, qint64 col )
 {
    //  vkPrintErr("fatalError");
 
    // msg previously set by logview: print everything.
-   m_fatalMsg = exception.message() +
-                " (line: " + QString::number( exception.lineNumber() ) +
-                ", col: " + QString::number( exception.columnNumber() ) + ")" +
+   m_fatalMsg = msg +
+                " (line: " + QString::number( line ) +
+                ", col: " + QString::number( col ) + ")" +
                 "\n\n" + m_fatalMsg;
 
    if ( m_finished ) {
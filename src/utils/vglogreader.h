@@ -21,59 +21,55 @@
 #ifndef __VGLOGREADER_H
 #define __VGLOGREADER_H
 
-#include "toolview/vglogview.h"
+#include "utils/vgloginput.h"
+#include "utils/vglogrecord.h"
+#include "utils/vglogtokenizer.h"
 
-#include <QFile>
+#include <QByteArray>
+#include <QList>
 #include <QString>
-#include <QDomDocument>
-
-#if 1
-#include <QXmlAttributes>
-#include <QXmlDefaultHandler>
-#include <QXmlSimpleReader>
-#include <QXmlInputSource>
-#include <QXmlParseException>
-#else
-// For debugging xml parser
-#include <vkxml.h>
-#define QXmlSimpleReader VkXmlSimpleReader
-#define QXmlInputSource VkXmlInputSource
-#define QXmlDefaultHandler VkXmlDefaultHandler
-#define QXmlAttributes VkXmlAttributes
-#define QXmlParseException VkXmlParseException
-#endif
+#include <QStringList>
+#include <QStringRef>
+#include <QVector>
+#include <QXmlStreamReader>
 
 
 // ============================================================
 /*
   Simple xml handler class for valgrind logs:
-  - creates node tree from input
-  - hands off complete top-level branches to VgLog
+  - driven by VgLogReader, one xml token at a time: from
+    VgLogTokenizer (raw utf-8) if it can, else from QXmlStreamReader
+  - decodes each top-level element straight into a typed VgLogRecord
+    (no intermediate node tree)
+  - hands off complete top-level records to a VgLogSink
+    (VgLogView, or VgLogWorker when parsing in the background)
   (e.g. preamble, error etc)
 */
-class VgLogHandler : public QXmlDefaultHandler
+class VgLogHandler
 {
 public:
-   VgLogHandler( VgLogView* lv );
+   VgLogHandler( VgLogSink* lv );
    ~VgLogHandler();
 
    // content handler
-   bool processingInstruction( const QString& target,
-                               const QString& data );
-   bool startElement( const QString& nsURI,
-                      const QString& localName,
-                      const QString& qName,
-                      const QXmlAttributes& atts );
-   bool endElement( const QString& nsURI,
-                    const QString& localName,
-                    const QString& qName );
-   bool characters( const QString& ch );
+   bool startElement( const QStringRef& tag );
+   bool startElement( const char* tag, int len );     // ascii name
+   bool endElement();
+   bool characters( const QStringRef& ch );
+   bool characters( const char* ch, int len, bool ascii );   // utf-8
    bool startDocument();
    bool endDocument();
 
-   // reimplement error handlers
-   bool error( const QXmlParseException& exception );
-   bool fatalError( const QXmlParseException& exception );
+   // start over, not handing on again the records already handed on
+   void restartDocument();
+
+   // error handler
+   bool fatalError( const QString& msg, qint64 line, qint64 col );
+
+   // passed on to the sink
+   bool loadProgress( qint64 done, qint64 total ) {
+      return logview->loadProgress( done, total );
+   }
 
    /* only set if fatal error */
    QString fatalMsg() {
@@ -89,39 +85,108 @@ public:
    }
 
 private:
-   QDomDocument doc;
-   VgLogView* logview;
-   QDomNode node;
+   bool startTopElement( VG_ELEM::ElemType etype, const QString& tag );
+   void startSubElement( VG_ELEM::ElemType etype );
+   void endSubElement( VG_ELEM::ElemType etype, VG_ELEM::ElemType parent,
+                       const QString& text );
+   bool endRecord();
+
+private:
+   VgLogSink* logview;
+
+   // currently open elements: path[0] is the document element
+   QVector<VG_ELEM::ElemType> path;
+   QString chars;          // text of the current leaf element
+
+   // top-level record under construction
+   VgLogRecord rec;
+   VgFrame     frame;
+   VgStack     stack;
+   QStringList supp;       // suppression lines
 
    QString m_fatalMsg;
    bool m_finished;
    bool m_started;
+   bool m_inited;          // logview->init() done
+   int m_records;          // records completed since startDocument()
+   int m_skip;             // ... of which already handed on
+};
+
+
+
+// ============================================================
+/*
+  Simply collects the records decoded from a (chunk of a) log
+*/
+class VgLogCollector : public VgLogSink
+{
+public:
+   bool init( QString doc_tag ) {
+      docTag = doc_tag;
+      return true;
+   }
+   bool appendNode( const VgLogRecord& rec, QString& /*errMsg*/ ) {
+      records.append( rec );
+      return true;
+   }
+
+   QString docTag;
+   VgLogRecordList records;
 };
 
 
 
 // ============================================================
 /*
-  Simple subclass of QXmlSimpleReader,
-  to setup VgLogHandler for this reader
+  Pull-parser for valgrind xml logs:
+   - QXmlStreamReader fed from a VgLogInput (so plain or compressed),
+     tokens passed to VgLogHandler
+   - a complete document (parseData(), in one or more parts, or parse()
+     of a plain log, which is mapped) goes to VgLogTokenizer first: QXmlStreamReader only
+     takes over if it can't cope.
+   - incremental: parseContinue() reads everything written to the
+     log so far; an incomplete document just means "wait for more data".
+   - or fed by the caller: startStream(), then parseStream() with each
+     lot of data as it arrives (e.g. from a socket).
 */
-class VgLogReader : public QXmlSimpleReader
+class VgLogReader
 {
 public:
-   VgLogReader( VgLogView* lv );
+   VgLogReader( VgLogSink* lv );
    ~VgLogReader();
 
    bool parse( QString filepath, bool incremental = false );
    bool parseContinue();
+   bool parseData( const QByteArray& data );
+   bool parseData( const QList<QByteArray>& parts );
+
+   void startStream();
+   bool parseStream( const QByteArray& data, bool atEnd );
+
+   /* use VgLogTokenizer where we can: default true */
+   void setFastPath( bool on ) {
+      fastPath = on;
+   }
 
    VgLogHandler* handler() {
       return vghandler;
    }
 
+private:
+   bool parseMapped( QString filepath, bool& ok );
+   bool parseFast( const char* data, qint64 size, qint64 progressStep,
+                   bool& ok );
+   bool fastResult( VgLogTokenizer::Result res, bool& ok );
+   qint64 readChunk();
+   bool parseTokens( bool incremental );
+
 private:
    VgLogHandler* vghandler;
-   QXmlInputSource* source;
-   QFile file;
+   QXmlStreamReader xml;
+   VgLogInput input;
+   QByteArray readBuf;
+   qint64 readSize;        // adapts to the log write rate
+   bool fastPath;
 };
 
 #endif // #ifndef __VGLOGREADER_H
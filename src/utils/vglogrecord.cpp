@@ -0,0 +1,663 @@
+/****************************************************************************
+** VgLogRecord implementation
+**  - compact, typed records decoded from a valgrind xml log
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogrecord.h"
+
+#include <QXmlStreamWriter>
+
+
+// ============================================================
+/*
+  tagname <-> enum
+   - the protocol's tag set is fixed: a switch on (length, first char),
+     then a compare of the rest, finds any tag without hashing,
+     or building a QString from the reader's buffer.
+*/
+template <typename Ch>
+static inline bool tagIs( const Ch* s, const char* tag, int len )
+{
+   // first char already matched by the switch
+   for ( int i = 1; i < len; i++ ) {
+      if ( s[i] != ( unsigned char )tag[i] ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+template <typename Ch>
+static VG_ELEM::ElemType lookupTag( const Ch* s, int len )
+{
+   using namespace VG_ELEM;
+
+   switch ( len ) {
+   case 2:
+      switch ( s[0] ) {
+      case 'f':
+         if ( tagIs( s, "fn", 2 ) ) return FN;
+         break;
+      case 'i':
+         if ( tagIs( s, "ip", 2 ) ) return IP;
+         break;
+      }
+      break;
+   case 3:
+      switch ( s[0] ) {
+      case 'a':
+         if ( tagIs( s, "arg", 3 ) ) return ARG;
+         break;
+      case 'd':
+         if ( tagIs( s, "dir", 3 ) ) return SRCDIR;
+         break;
+      case 'e':
+         if ( tagIs( s, "exe", 3 ) ) return EXE;
+         break;
+      case 'f':
+         if ( tagIs( s, "fun", 3 ) ) return SFUN;
+         break;
+      case 'o':
+         if ( tagIs( s, "obj", 3 ) ) return OBJ;
+         break;
+      case 'p':
+         if ( tagIs( s, "pid", 3 ) ) return PID;
+         break;
+      case 't':
+         if ( tagIs( s, "tid", 3 ) ) return TID;
+         break;
+      case 'v':
+         if ( tagIs( s, "var", 3 ) ) return VAR;
+         break;
+      }
+      break;
+   case 4:
+      switch ( s[0] ) {
+      case 'a':
+         if ( tagIs( s, "args", 4 ) ) return ARGS;
+         if ( tagIs( s, "argv", 4 ) ) return ARGV;
+         break;
+      case 'f':
+         if ( tagIs( s, "file", 4 ) ) return SRCFILE;
+         break;
+      case 'k':
+         if ( tagIs( s, "kind", 4 ) ) return KIND;
+         break;
+      case 'l':
+         if ( tagIs( s, "line", 4 ) ) return LINE;
+         break;
+      case 'n':
+         if ( tagIs( s, "name", 4 ) ) return NAME;
+         break;
+      case 'p':
+         if ( tagIs( s, "ppid", 4 ) ) return PPID;
+         if ( tagIs( s, "pair", 4 ) ) return PAIR;
+         break;
+      case 't':
+         if ( tagIs( s, "tool", 4 ) ) return TOOL;
+         if ( tagIs( s, "time", 4 ) ) return TIME;
+         if ( tagIs( s, "text", 4 ) ) return TEXT;
+         break;
+      case 'w':
+         if ( tagIs( s, "what", 4 ) ) return WHAT;
+         break;
+      }
+      break;
+   case 5:
+      switch ( s[0] ) {
+      case 'c':
+         if ( tagIs( s, "count", 5 ) ) return COUNT;
+         break;
+      case 'e':
+         if ( tagIs( s, "error", 5 ) ) return ERROR;
+         break;
+      case 'f':
+         if ( tagIs( s, "frame", 5 ) ) return FRAME;
+         break;
+      case 's':
+         if ( tagIs( s, "state", 5 ) ) return STATE;
+         if ( tagIs( s, "stack", 5 ) ) return STACK;
+         if ( tagIs( s, "sname", 5 ) ) return SNAME;
+         if ( tagIs( s, "skind", 5 ) ) return SKIND;
+         if ( tagIs( s, "skaux", 5 ) ) return SKAUX;
+         break;
+      case 'v':
+         if ( tagIs( s, "value", 5 ) ) return VALUE;
+         if ( tagIs( s, "vargv", 5 ) ) return VARGV;
+         break;
+      case 'x':
+         if ( tagIs( s, "xwhat", 5 ) ) return XWHAT;
+         break;
+      }
+      break;
+   case 6:
+      switch ( s[0] ) {
+      case 's':
+         if ( tagIs( s, "status", 6 ) ) return STATUS;
+         if ( tagIs( s, "sframe", 6 ) ) return SFRAME;
+         break;
+      case 'u':
+         if ( tagIs( s, "unique", 6 ) ) return UNIQUE;
+         break;
+      }
+      break;
+   case 7:
+      switch ( s[0] ) {
+      case 'a':
+         if ( tagIs( s, "auxwhat", 7 ) ) return AUXWHAT;
+         break;
+      case 'r':
+         if ( tagIs( s, "rawtext", 7 ) ) return RAWTEXT;
+         break;
+      }
+      break;
+   case 8:
+      switch ( s[0] ) {
+      case 'p':
+         if ( tagIs( s, "preamble", 8 ) ) return PREAMBLE;
+         break;
+      case 'x':
+         if ( tagIs( s, "xauxwhat", 8 ) ) return XAUXWHAT;
+         break;
+      }
+      break;
+   case 9:
+      switch ( s[0] ) {
+      case 'h':
+         if ( tagIs( s, "hthreadid", 9 ) ) return HTHREADID;
+         break;
+      }
+      break;
+   case 10:
+      switch ( s[0] ) {
+      case 's':
+         if ( tagIs( s, "suppcounts", 10 ) ) return SUPPCOUNTS;
+         break;
+      }
+      break;
+   case 11:
+      switch ( s[0] ) {
+      case 'e':
+         if ( tagIs( s, "errorcounts", 11 ) ) return ERRORCOUNTS;
+         break;
+      case 'l':
+         if ( tagIs( s, "leakedbytes", 11 ) ) return LEAKEDBYTES;
+         break;
+      case 's':
+         if ( tagIs( s, "suppression", 11 ) ) return SUPPRESSION;
+         break;
+      case 'u':
+         if ( tagIs( s, "usercomment", 11 ) ) return COMMENT;
+         break;
+      }
+      break;
+   case 12:
+      switch ( s[0] ) {
+      case 'f':
+         if ( tagIs( s, "fatal_signal", 12 ) ) return FATAL_SIGNAL;
+         break;
+      case 'l':
+         if ( tagIs( s, "leakedblocks", 12 ) ) return LEAKEDBLOCKS;
+         break;
+      case 'p':
+         if ( tagIs( s, "protocoltool", 12 ) ) return PROTOCOL_TOOL;
+         break;
+      }
+      break;
+   case 14:
+      switch ( s[0] ) {
+      case 'a':
+         if ( tagIs( s, "announcethread", 14 ) ) return ANNOUNCETHREAD;
+         break;
+      case 'v':
+         if ( tagIs( s, "valgrindoutput", 14 ) ) return ROOT;
+         break;
+      }
+      break;
+   case 15:
+      switch ( s[0] ) {
+      case 'p':
+         if ( tagIs( s, "protocolversion", 15 ) ) return PROTOCOL_VERSION;
+         break;
+      }
+      break;
+   case 16:
+      switch ( s[0] ) {
+      case 'l':
+         if ( tagIs( s, "logfilequalifier", 16 ) ) return LOGQUAL;
+         break;
+      }
+      break;
+   }
+
+   return NUM_ELEMS;
+}
+
+/* enum -> tagname, in enum order */
+static const char* const elemNames[VG_ELEM::NUM_ELEMS] = {
+   "valgrindoutput",
+   "protocolversion",
+   "protocoltool",
+   "preamble",
+   "pid",
+   "ppid",
+   "tool",
+   "logfilequalifier",
+   "var",
+   "value",
+   "usercomment",
+   "args",
+   "vargv",
+   "argv",
+   "exe",
+   "arg",
+   "status",
+   "state",
+   "time",
+   "error",
+   "unique",
+   "tid",
+   "kind",
+   "what",
+   "xwhat",
+   "text",
+   "stack",
+   "frame",
+   "ip",
+   "obj",
+   "fn",
+   "dir",
+   "file",
+   "line",
+   "auxwhat",
+   "xauxwhat",
+   "errorcounts",
+   "announcethread",
+   "hthreadid",
+   "pair",
+   "count",
+   "suppcounts",
+   "name",
+   "leakedbytes",
+   "leakedblocks",
+   "suppression",
+   "sname",
+   "skind",
+   "skaux",
+   "sframe",
+   "fun",
+   "rawtext",
+   "fatal_signal"
+};
+
+
+VG_ELEM::ElemType VG_ELEM::elemType( const QChar* name, int len )
+{
+   return lookupTag( reinterpret_cast<const ushort*>( name ), len );
+}
+
+VG_ELEM::ElemType VG_ELEM::elemType( const char* name, int len )
+{
+   return lookupTag( name, len );
+}
+
+const char* VG_ELEM::elemName( ElemType type )
+{
+   if ( type < 0 || type >= NUM_ELEMS ) {
+      return "";
+   }
+   return elemNames[type];
+}
+
+
+
+static void writeFrame( QXmlStreamWriter& strm, const VgFrame& frame )
+{
+   strm.writeStartElement( "frame" );
+   strm.writeTextElement( "ip", frame.ipStr() );
+   if ( !frame.obj.isEmpty() )  strm.writeTextElement( "obj", frame.obj.str() );
+   if ( !frame.fn.isEmpty() )   strm.writeTextElement( "fn", frame.fn.str() );
+   if ( !frame.dir.isEmpty() )  strm.writeTextElement( "dir", frame.dir.str() );
+   if ( !frame.file.isEmpty() ) strm.writeTextElement( "file", frame.file.str() );
+   if ( frame.line >= 0 ) {
+      strm.writeTextElement( "line", QString::number( frame.line ) );
+   }
+   strm.writeEndElement();
+}
+
+
+// ============================================================
+/*!
+  VgFrame
+*/
+bool VgFrame::hasSrcLoc() const
+{
+   return !file.isEmpty() && line >= 0;
+}
+
+/*!
+  dir/file, or just file if no dir info
+*/
+QString VgFrame::srcPath() const
+{
+   if ( dir.isEmpty() ) {
+      return file.str();
+   }
+   return dir.str() + "/" + file.str();
+}
+
+/*!
+  ip as valgrind writes it: 0x%llX
+*/
+QString VgFrame::ipStr() const
+{
+   return "0x" + QString::number( ip, 16 ).toUpper();
+}
+
+/*!
+  ref: coregrind/m_debuginfo/symtab.c :: VG_(describe_IP)
+*/
+QString VgFrame::describeIP( bool withPath/*=false*/ ) const
+{
+   bool  know_fnname  = !fn.isEmpty();
+   bool  know_objname = !obj.isEmpty();
+   bool  know_srcloc  = hasSrcLoc();
+   bool  know_dirinfo = !dir.isEmpty();
+
+   QString str = ipStr() + ": ";
+
+   if ( know_fnname ) {
+      str += fn.str();
+
+      if ( !know_srcloc && know_objname ) {
+         str += " (in " + obj.str() + ")";
+      }
+   }
+   else if ( know_objname && !know_srcloc ) {
+      str += "(within " + obj.str() + ")";
+   }
+   else {
+      str += "???";
+   }
+
+   if ( know_srcloc ) {
+      QString path;
+
+      if ( withPath && know_dirinfo ) {
+         path = dir.str() + "/";
+      }
+
+      path += file.str();
+      str += " (" + path + ":" + QString::number( line ) + ")";
+   }
+
+   return str;
+}
+
+QString VgFrame::toXml() const
+{
+   QString xml;
+   QXmlStreamWriter strm( &xml );
+   strm.setAutoFormatting( true );
+   strm.setAutoFormattingIndent( 2 );
+   writeFrame( strm, *this );
+   return xml;
+}
+
+
+
+// ============================================================
+/*!
+  VgError
+*/
+bool VgError::isLeak() const
+{
+   return kind.startsWith( "Leak_" );
+}
+
+
+/*!
+  Leak errors: the loss record number, from the what text
+   - valgrind gives it nowhere else. 0 if not found.
+*/
+int VgError::lossRecord() const
+{
+   static const QLatin1String marker( "in loss record " );
+   int idx = what.indexOf( marker );
+   if ( idx < 0 ) {
+      return 0;
+   }
+
+   int num = 0;
+   const QChar* p   = what.unicode() + idx + marker.size();
+   const QChar* end = what.unicode() + what.size();
+   for ( ; p < end && p->isDigit(); ++p ) {
+      num = num * 10 + p->digitValue();
+   }
+   return num;
+}
+
+
+/*!
+  Just the fields needed to show the (collapsed) error:
+  the details (parts, stacks, suppression) are left out.
+*/
+VgError VgError::summary() const
+{
+   VgError err;
+   err.unique       = unique;
+   err.tid          = tid;
+   err.kind         = kind;
+   err.what         = what;
+   err.leakedBytes  = leakedBytes;
+   err.leakedBlocks = leakedBlocks;
+   err.hasLeak      = hasLeak;
+   return err;
+}
+
+/*!
+  Approx. memory held by the details: parts, stacks, suppression
+   - frame strings are interned, so not counted here.
+*/
+qint64 VgError::detailsBytes() const
+{
+   qint64 n = parts.capacity() * sizeof( VgErrorPart );
+   foreach( const VgErrorPart& part, parts ) {
+      n += part.text.capacity() * sizeof( QChar );
+   }
+   n += stacks.capacity() * sizeof( VgStack );
+   foreach( const VgStack& stack, stacks ) {
+      n += stack.capacity() * sizeof( VgFrame );
+   }
+   n += suppression.capacity() * sizeof( QChar );
+   return n;
+}
+
+/*!
+  Fields for which fieldValues() works on a summary()
+*/
+bool VgError::isSummaryField( VG_ELEM::ElemType field )
+{
+   return ( field == VG_ELEM::KIND ||
+            field == VG_ELEM::LEAKEDBYTES ||
+            field == VG_ELEM::LEAKEDBLOCKS );
+}
+
+
+/*!
+  All values of the given field within this error, as strings.
+  Used for filtering: stack-frame fields return one value per frame.
+*/
+QStringList VgError::fieldValues( VG_ELEM::ElemType field ) const
+{
+   QStringList vals;
+
+   switch ( field ) {
+   case VG_ELEM::KIND:
+      vals << kind;
+      break;
+
+   case VG_ELEM::LEAKEDBYTES:
+      if ( hasLeak ) {
+         vals << QString::number( leakedBytes );
+      }
+      break;
+
+   case VG_ELEM::LEAKEDBLOCKS:
+      if ( hasLeak ) {
+         vals << QString::number( leakedBlocks );
+      }
+      break;
+
+   case VG_ELEM::OBJ:
+   case VG_ELEM::FN:
+   case VG_ELEM::SRCDIR:
+   case VG_ELEM::SRCFILE:
+   case VG_ELEM::LINE: {
+      foreach( const VgStack& stack, stacks ) {
+         foreach( const VgFrame& frame, stack ) {
+            switch ( field ) {
+            case VG_ELEM::OBJ:
+               if ( !frame.obj.isEmpty() ) vals << frame.obj.str();
+               break;
+            case VG_ELEM::FN:
+               if ( !frame.fn.isEmpty() ) vals << frame.fn.str();
+               break;
+            case VG_ELEM::SRCDIR:
+               if ( !frame.dir.isEmpty() ) vals << frame.dir.str();
+               break;
+            case VG_ELEM::SRCFILE:
+               if ( !frame.file.isEmpty() ) vals << frame.file.str();
+               break;
+            default:
+               if ( frame.line >= 0 ) vals << QString::number( frame.line );
+               break;
+            }
+         }
+      }
+      break;
+   }
+
+   default:
+      break;
+   }
+
+   return vals;
+}
+
+
+/*!
+  Plain text description, one line per what/auxwhat/frame
+*/
+QString VgError::toText() const
+{
+   QStringList lines;
+
+   foreach( const VgErrorPart& part, parts ) {
+      if ( part.type == VG_ELEM::STACK ) {
+         foreach( const VgFrame& frame, stacks.at( part.stack ) ) {
+            lines << "   " + frame.describeIP( true );
+         }
+      }
+      else if ( part.type == VG_ELEM::TID ) {
+         lines << "Thread Id: " + part.text;
+      }
+      else {
+         lines << part.text;
+      }
+   }
+
+   return lines.join( "\n" );
+}
+
+
+/*!
+  Regenerate the xml for this error.
+  Note: the suppression is only kept in flattened form, so is not output.
+*/
+QString VgError::toXml( const QString& tag/*="error"*/ ) const
+{
+   QString xml;
+   QXmlStreamWriter strm( &xml );
+   strm.setAutoFormatting( true );
+   strm.setAutoFormattingIndent( 2 );
+
+   strm.writeStartElement( tag );
+   if ( !unique.isEmpty() ) strm.writeTextElement( "unique", unique );
+   if ( !tid.isEmpty() )    strm.writeTextElement( "tid", tid );
+   if ( !kind.isEmpty() )   strm.writeTextElement( "kind", kind );
+
+   foreach( const VgErrorPart& part, parts ) {
+      switch ( part.type ) {
+      case VG_ELEM::WHAT:      strm.writeTextElement( "what", part.text );      break;
+      case VG_ELEM::AUXWHAT:   strm.writeTextElement( "auxwhat", part.text );   break;
+      case VG_ELEM::HTHREADID: strm.writeTextElement( "hthreadid", part.text ); break;
+
+      case VG_ELEM::XWHAT:
+      case VG_ELEM::XAUXWHAT: {
+         bool isX = ( part.type == VG_ELEM::XWHAT );
+         strm.writeStartElement( isX ? "xwhat" : "xauxwhat" );
+         strm.writeTextElement( "text", part.text );
+         if ( isX && hasLeak ) {
+            strm.writeTextElement( "leakedbytes", QString::number( leakedBytes ) );
+            strm.writeTextElement( "leakedblocks", QString::number( leakedBlocks ) );
+         }
+         strm.writeEndElement();
+         break;
+      }
+
+      case VG_ELEM::STACK: {
+         strm.writeStartElement( "stack" );
+         foreach( const VgFrame& frame, stacks.at( part.stack ) ) {
+            writeFrame( strm, frame );
+         }
+         strm.writeEndElement();
+         break;
+      }
+
+      default:
+         // tid: written above.
+         break;
+      }
+   }
+
+   strm.writeEndElement();
+   return xml;
+}
+
+
+
+// ============================================================
+/*!
+  VgLogRecord
+*/
+void VgLogRecord::clear()
+{
+   *this = VgLogRecord();
+}
+
+
+
+// ============================================================
+/*!
+  VgLogInfo
+*/
+QString VgLogInfo::exe() const
+{
+   return argv.isEmpty() ? QString() : argv.first();
+}
@@ -0,0 +1,274 @@
+/****************************************************************************
+** VgLogRecord definition
+**  - compact, typed records decoded from a valgrind xml log
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGRECORD_H
+#define __VGLOGRECORD_H
+
+#include "utils/vk_atoms.h"
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// ============================================================
+namespace VG_ELEM {
+   // All valgrind tag types, for mapping of tags to enum values
+   enum ElemType {
+      ROOT, PROTOCOL_VERSION, PROTOCOL_TOOL, PREAMBLE, PID, PPID, TOOL,
+      LOGQUAL, VAR, VALUE, COMMENT,
+      ARGS, VARGV, ARGV, EXE, ARG,
+      STATUS, STATE, TIME,
+      ERROR, UNIQUE, TID, KIND, WHAT, XWHAT, TEXT, STACK,
+      FRAME, IP, OBJ, FN, SRCDIR, SRCFILE, LINE, AUXWHAT, XAUXWHAT,
+      ERRORCOUNTS, ANNOUNCETHREAD, HTHREADID, PAIR, COUNT,
+      SUPPCOUNTS, NAME, LEAKEDBYTES, LEAKEDBLOCKS,
+      SUPPRESSION, SNAME, SKIND, SKAUX, SFRAME, SFUN, RAWTEXT,
+      FATAL_SIGNAL,
+      NUM_ELEMS
+   };
+
+   // tagname -> enum: NUM_ELEMS if not a known tag
+   ElemType elemType( const QChar* name, int len );
+   ElemType elemType( const char* name, int len );
+   // enum -> tagname
+   const char* elemName( ElemType type );
+}
+
+
+
+// ============================================================
+/*!
+  VgFrame: one <frame> of a <stack>
+   - only the ip is guaranteed: all other fields may be empty.
+   - obj/fn/dir/file repeat across thousands of frames: interned.
+   - the ip is kept as a number: see ipStr()
+*/
+class VgFrame
+{
+public:
+   VgFrame() : ip( 0 ), line( -1 ) {}
+
+   bool hasSrcLoc() const;
+   QString srcPath() const;
+   QString ipStr() const;
+   QString describeIP( bool withPath = false ) const;
+   QString toXml() const;
+
+   quint64 ip;
+   VkAtom  obj;
+   VkAtom  fn;
+   VkAtom  dir;
+   VkAtom  file;
+   int     line;     // -1 if not known
+};
+
+typedef QVector<VgFrame> VgStack;
+
+
+
+// ============================================================
+/*!
+  VgLogRange: byte range of a top-level element within the log file
+*/
+class VgLogRange
+{
+public:
+   VgLogRange( qint64 s = 0, qint64 e = 0 ) : start( s ), end( e ) {}
+
+   qint64 start;   // offset of the '<' of the start tag
+   qint64 end;     // offset just past the '>' of the end tag
+
+   bool isValid() const {
+      return end > start;
+   }
+};
+
+typedef QVector<VgLogRange> VgLogRanges;
+
+
+
+// ============================================================
+/*!
+  VgErrorPart: one displayable child of an <error>, in log order.
+   - WHAT, AUXWHAT, XWHAT, XAUXWHAT, TID, HTHREADID: text holds the
+     (x)what::text / tid / hthreadid
+   - STACK: stack holds the index into VgError::stacks
+*/
+class VgErrorPart
+{
+public:
+   VgErrorPart( VG_ELEM::ElemType t = VG_ELEM::NUM_ELEMS,
+                const QString& txt = QString(), int stk = -1 )
+      : type( t ), text( txt ), stack( stk ) {}
+
+   VG_ELEM::ElemType type;
+   QString text;
+   int     stack;
+};
+
+
+
+// ============================================================
+/*!
+  VgError: a decoded <error> (also used for <announcethread>
+  and <fatal_signal>, which share the same building blocks)
+*/
+class VgError
+{
+public:
+   VgError() : leakedBytes( 0 ), leakedBlocks( 0 ), hasLeak( false ) {}
+
+   bool isLeak() const;
+   int lossRecord() const;    // leaks: N of "... in loss record N of M", else 0
+   VgError summary() const;
+   qint64 detailsBytes() const;   // approx. memory summary() leaves out
+   static bool isSummaryField( VG_ELEM::ElemType field );
+   QStringList fieldValues( VG_ELEM::ElemType field ) const;
+   QString toText() const;
+   QString toXml( const QString& tag = "error" ) const;
+
+   QString unique;
+   QString tid;
+   QString kind;
+   QString what;              // first what, else first xwhat::text
+
+   qulonglong leakedBytes;    // from xwhat: only valid if hasLeak
+   qulonglong leakedBlocks;
+   bool       hasLeak;
+
+   QVector<VgErrorPart> parts;
+   QVector<VgStack>     stacks;
+   QString              suppression;  // flattened sname/skind/skaux/sframes
+};
+
+
+
+// ============================================================
+/*!
+  VgStatus: a decoded <status>
+*/
+class VgStatus
+{
+public:
+   QString state;   // RUNNING | FINISHED
+   QString time;
+};
+
+
+
+// ============================================================
+/*!
+  VgCountPair: a <pair> of <errorcounts> (count, unique)
+  or <suppcounts> (count, name)
+*/
+class VgCountPair
+{
+public:
+   VgCountPair() : count( 0 ) {}
+
+   int     count;
+   QString key;
+};
+
+typedef QVector<VgCountPair> VgCounts;
+
+
+
+// ============================================================
+/*!
+  VgLogRecord: one complete top-level element of the log,
+  as handed from the log reader to the VgLogView.
+  Only the members relevant to the given type are filled.
+*/
+class VgLogRecord
+{
+public:
+   VgLogRecord() : type( VG_ELEM::NUM_ELEMS ) {}
+   void clear();
+
+   // the run's summary, found at the end of the log (bar the first status)
+   bool isSummary() const {
+      return type == VG_ELEM::STATUS || type == VG_ELEM::ERRORCOUNTS ||
+             type == VG_ELEM::SUPPCOUNTS || type == VG_ELEM::FATAL_SIGNAL;
+   }
+
+   VG_ELEM::ElemType type;
+
+   QString     text;    // protocolversion, protocoltool, pid, ppid, tool, usercomment
+   QStringList lines;   // preamble: lines; logfilequalifier: var,value; args: vargv
+   QStringList argv;    // args: argv (client exe + args)
+   VgStatus    status;  // status
+   VgCounts    counts;  // errorcounts, suppcounts
+   VgError     error;   // error, announcethread, fatal_signal
+};
+
+typedef QList<VgLogRecord> VgLogRecordList;
+
+
+
+// ============================================================
+/*!
+  VgLogSink: receiver of the records decoded by VgLogHandler
+   - VgLogView, when the log is parsed on the gui thread
+   - VgLogWorker, when the log is parsed in the background
+*/
+class VgLogSink
+{
+public:
+   virtual ~VgLogSink() {}
+
+   virtual bool init( QString doc_tag ) = 0;
+   virtual bool appendNode( const VgLogRecord& rec, QString& errMsg ) = 0;
+
+   /* long loads: 'done' of 'total' units of work so far.
+      returns false to have the load given up asap. */
+   virtual bool loadProgress( qint64 /*done*/, qint64 /*total*/ ) {
+      return true;
+   }
+};
+
+
+
+// ============================================================
+/*!
+  VgLogInfo: log header data, gathered from the top-level
+  elements preceding the first <status>
+*/
+class VgLogInfo
+{
+public:
+   QString exe() const;
+
+   QString protocolVersion;
+   QString protocolTool;
+   QString pid;
+   QString ppid;
+   QString tool;
+   QString userComment;
+   QStringList preamble;
+   QList< QPair<QString, QString> > logQuals;
+   QStringList vargv;   // valgrind exe + args
+   QStringList argv;    // client exe + args
+};
+
+#endif // #ifndef __VGLOGRECORD_H
@@ -0,0 +1,313 @@
+/****************************************************************************
+** VgLogSource implementation
+**  - re-reads parts of a valgrind xml log on demand
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogsource.h"
+#include "utils/vgloginput.h"
+#include "utils/vglogreader.h"
+#include "utils/vk_utils.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+// bytes searched between progress reports
+#define VG_LOG_SEARCH_STEP ( 64 * 1024 * 1024 )
+
+
+/**********************************************************************/
+/*!
+  VgLogSource
+*/
+VgLogSource::VgLogSource( QString logfile )
+   : file( logfile ), docTag( "valgrindoutput" )
+{ }
+
+
+/*!
+  Decode the <error> at the given byte range of the log
+   - wrapped in the document element, so it's a log of its own.
+*/
+bool VgLogSource::readError( const VgLogRange& range, VgError& err )
+{
+   if ( !range.isValid() ) {
+      return false;
+   }
+
+   if ( !file.isOpen() && !file.open( QIODevice::ReadOnly ) ) {
+      vkPrintErr( "VgLogSource::readError(): failed to open '%s'",
+                  qPrintable( file.fileName() ) );
+      return false;
+   }
+
+   QByteArray data = "<" + docTag.toLatin1() + ">";
+   if ( !file.seek( range.start ) ) {
+      return false;
+   }
+   data += file.read( range.end - range.start );
+   data += "</" + docTag.toLatin1() + ">";
+
+   VgLogCollector sink;
+   VgLogReader reader( &sink );
+   if ( !reader.parseData( data ) || sink.records.count() != 1 ||
+        sink.records.first().type != VG_ELEM::ERROR ) {
+      vkPrintErr( "VgLogSource::readError(): bad error at offset %lld",
+                  range.start );
+      return false;
+   }
+
+   err = sink.records.first().error;
+   return true;
+}
+
+
+// ============================================================
+/*
+  Passes on just the errors: for a page of a paged load
+*/
+class VgLogPageSink : public VgLogSink
+{
+public:
+   VgLogPageSink( VgLogSink* s ) : sink( s ) { }
+
+   bool init( QString doc_tag ) {
+      return sink->init( doc_tag );
+   }
+   bool appendNode( const VgLogRecord& rec, QString& errMsg ) {
+      if ( rec.type != VG_ELEM::ERROR && rec.type != VG_ELEM::ANNOUNCETHREAD ) {
+         return true;
+      }
+      return sink->appendNode( rec, errMsg );
+   }
+
+private:
+   VgLogSink* sink;
+};
+
+
+
+/*!
+  Decode the next page of the log: [from, to), cut short just after
+  its maxErrors'th top-level </error>.
+   - just the errors (and thread announcements) go to the sink, which
+     is also told the document element.
+   - next gets where the following page starts: 'to' when all's read.
+*/
+bool VgLogSource::readPage( qint64 from, qint64 to, int maxErrors,
+                            VgLogSink* sink, qint64& next )
+{
+   next = from;
+   if ( from >= to ) {
+      return true;
+   }
+
+   if ( !file.isOpen() && !file.open( QIODevice::ReadOnly ) ) {
+      vkPrintErr( "VgLogSource::readPage(): failed to open '%s'",
+                  qPrintable( file.fileName() ) );
+      return false;
+   }
+
+   uchar* map = file.map( from, to - from );
+   if ( map == 0 ) {
+      vkPrintErr( "VgLogSource::readPage(): failed to map '%s'",
+                  qPrintable( file.fileName() ) );
+      return false;
+   }
+
+   qint64 len = findErrorsEnd( ( const char* )map, to - from, 0, maxErrors );
+
+   QByteArray data = "<" + docTag.toLatin1() + ">";
+   data.append( ( const char* )map, len );
+   data += "</" + docTag.toLatin1() + ">";
+   file.unmap( map );
+
+   VgLogPageSink pageSink( sink );
+   VgLogReader reader( &pageSink );
+   if ( !reader.parseData( data ) ) {
+      vkPrintErr( "VgLogSource::readPage(): bad log at offset %lld", from );
+      return false;
+   }
+
+   next = from + len;
+   return true;
+}
+
+
+/*!
+  Find 'pat' in log[from..size), or -1
+*/
+qint64 VgLogSource::findBytes( const char* log, qint64 size, qint64 from,
+                               const char* pat )
+{
+   const char* end = log + size;
+   const char* hit = std::search( log + from, end, pat, pat + strlen( pat ) );
+   return ( hit == end ) ? -1 : hit - log;
+}
+
+
+/*!
+  Find the last 'pat' in log[from..size), or -1
+   - searches back from the end: costs only as much as it's from there.
+*/
+qint64 VgLogSource::findLastBytes( const char* log, qint64 size, qint64 from,
+                                   const char* pat )
+{
+   const char* end = log + size;
+   const char* hit = std::find_end( log + from, end, pat, pat + strlen( pat ) );
+   return ( hit == end ) ? -1 : hit - log;
+}
+
+
+/*!
+  The document element's tagname, skipping the xml decl, comments etc.
+   - bodyStart gets the offset just past its start tag.
+   - empty if the log doesn't look like we expect.
+*/
+QByteArray VgLogSource::findDocTag( const char* log, qint64 size,
+                                    qint64& bodyStart )
+{
+   qint64 pos = 0;
+   for ( ;; ) {
+      pos = findBytes( log, size, pos, "<" );
+      if ( pos == -1 || pos + 4 >= size ) {
+         return QByteArray();
+      }
+      if ( log[pos + 1] == '?' ) {
+         pos = findBytes( log, size, pos, "?>" );
+      }
+      else if ( strncmp( log + pos, "<!--", 4 ) == 0 ) {
+         pos = findBytes( log, size, pos, "-->" );
+      }
+      else if ( log[pos + 1] == '!' ) {
+         pos = findBytes( log, size, pos, ">" );
+      }
+      else {
+         break;
+      }
+      if ( pos == -1 ) {
+         return QByteArray();
+      }
+   }
+
+   qint64 tagEnd = pos + 1;
+   while ( tagEnd < size && !strchr( " \t\r\n/>", log[tagEnd] ) ) {
+      tagEnd++;
+   }
+   QByteArray docTag( log + pos + 1, tagEnd - pos - 1 );
+   bodyStart = findBytes( log, size, tagEnd, ">" );
+   if ( docTag.isEmpty() || bodyStart == -1 ) {
+      return QByteArray();
+   }
+   bodyStart++;
+   return docTag;
+}
+
+
+/*!
+  Offset just past the maxErrors'th top-level </error> from 'from':
+  or size, if there are fewer.
+   - nFound, if given, gets how many were found.
+*/
+qint64 VgLogSource::findErrorsEnd( const char* log, qint64 size, qint64 from,
+                                   int maxErrors, int* nFound/*=0*/ )
+{
+   static const char endTag[] = "</error>";
+
+   int n = 0;
+   qint64 pos = from;
+   while ( n < maxErrors ) {
+      pos = findBytes( log, size, pos, endTag );
+      if ( pos == -1 ) {
+         pos = size;
+         break;
+      }
+      pos += strlen( endTag );
+      n++;
+   }
+
+   if ( nFound != 0 ) {
+      *nFound = n;
+   }
+   return pos;
+}
+
+
+/*!
+  Byte range of every top-level <error> in the log, in order.
+   - no nested element shares the tagname, and the text can't contain
+     it, so a plain byte search finds them all.
+   - returns false if the progress sink gives up on us.
+*/
+bool VgLogSource::findErrorRanges( const char* log, qint64 size,
+                                   VgLogRanges& ranges,
+                                   VgLogSink* progress/*=0*/ )
+{
+   static const char startTag[] = "<error>";
+   static const char endTag[]   = "</error>";
+   const char* end = log + size;
+   const char* nextReport = log + VG_LOG_SEARCH_STEP;
+
+   ranges.clear();
+   const char* p = log;
+   for ( ;; ) {
+      if ( progress != 0 && p >= nextReport ) {
+         if ( !progress->loadProgress( p - log, size ) ) {
+            return false;
+         }
+         nextReport = p + VG_LOG_SEARCH_STEP;
+      }
+
+      p = std::search( p, end, startTag, startTag + strlen( startTag ) );
+      if ( p == end ) {
+         break;
+      }
+      const char* q = std::search( p, end, endTag, endTag + strlen( endTag ) );
+      if ( q == end ) {
+         return false;   // incomplete log
+      }
+      q += strlen( endTag );
+      ranges.append( VgLogRange( p - log, q - log ) );
+      p = q;
+   }
+   return true;
+}
+
+bool VgLogSource::findErrorRanges( QString logfile, VgLogRanges& ranges,
+                                   VgLogSink* progress/*=0*/ )
+{
+   // byte ranges in compressed data would be of no use
+   if ( VgLogInput::isCompressedFile( logfile ) ) {
+      return false;
+   }
+
+   QFile log( logfile );
+   if ( !log.open( QIODevice::ReadOnly ) || log.size() == 0 ) {
+      return false;
+   }
+
+   uchar* map = log.map( 0, log.size() );
+   if ( map == 0 ) {
+      return false;
+   }
+
+   bool ok = findErrorRanges( ( const char* )map, log.size(), ranges,
+                              progress );
+   log.unmap( map );
+   return ok;
+}
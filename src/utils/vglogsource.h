@@ -0,0 +1,77 @@
+/****************************************************************************
+** VgLogSource definition
+**  - re-reads parts of a valgrind xml log on demand
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGSOURCE_H
+#define __VGLOGSOURCE_H
+
+#include "utils/vglogrecord.h"
+
+#include <QFile>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VgLogSource: a (saved) log, for re-decoding single errors from it.
+
+   - Used by the lazy log view mode: error items keep just their byte
+     range in the log, and get their details from here when needed.
+   - And by the paged mode: the errors after the first page are left
+     in the log, and read from here a page at a time. Just the errors:
+     the run's summary has been read already, and any earlier
+     (periodic) errorcounts in a page would only put the counts back.
+   - Gui thread only (the static helpers are thread-safe).
+*/
+class VgLogSource
+{
+public:
+   VgLogSource( QString logfile );
+
+   void setDocTag( QString doc_tag ) {
+      docTag = doc_tag;
+   }
+
+   bool readError( const VgLogRange& range, VgError& err );
+   bool readPage( qint64 from, qint64 to, int maxErrors,
+                  VgLogSink* sink, qint64& next );
+
+   // progress: if given, told of the bytes searched now & then
+   static bool findErrorRanges( const char* log, qint64 size,
+                                VgLogRanges& ranges,
+                                VgLogSink* progress = 0 );
+   static bool findErrorRanges( QString logfile, VgLogRanges& ranges,
+                                VgLogSink* progress = 0 );
+
+   // byte searches of a mapped log
+   static qint64 findBytes( const char* log, qint64 size, qint64 from,
+                            const char* pat );
+   static qint64 findLastBytes( const char* log, qint64 size, qint64 from,
+                                const char* pat );
+   static QByteArray findDocTag( const char* log, qint64 size,
+                                 qint64& bodyStart );
+   static qint64 findErrorsEnd( const char* log, qint64 size, qint64 from,
+                                int maxErrors, int* nFound = 0 );
+
+private:
+   QFile file;
+   QString docTag;
+};
+
+#endif // #ifndef __VGLOGSOURCE_H
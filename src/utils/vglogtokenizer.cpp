@@ -0,0 +1,876 @@
+/****************************************************************************
+** VgLogTokenizer implementation
+**  - fast tokenizer for complete valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogtokenizer.h"
+#include "utils/vglogreader.h"
+
+#include <limits.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined( __SSE2__ )
+#  include <emmintrin.h>
+#  define VG_TOK_SSE2
+#endif
+
+// avx2 only if the cpu has it, so built just for those functions
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( defined( __clang__ ) || __GNUC__ >= 5 )
+#  include <immintrin.h>
+#  define VG_TOK_AVX2
+#endif
+
+
+// initial capacity of the resolved-text buffer
+#define VG_TOK_REFBUF_RESERVE 256
+
+// longest entity or char ref we resolve, '&' to ';'
+#define VG_TOK_REF_MAX 16
+
+// what the text scan saw on the way
+#define VG_TOK_HIGH   1     // non-ascii: utf-8 to check
+#define VG_TOK_CTRL   2     // a control char xml doesn't allow
+
+// byte classes
+#define VG_CC_NAMESTART  0x01
+#define VG_CC_NAME       0x02
+#define VG_CC_SPACE      0x04
+#define VG_CC_STOP       0x08    // '<', '>', '&': ends a text scan
+#define VG_CC_CTRL       0x10    // control char, other than \t \n \r
+#define VG_CC_HIGH       0x20    // >= 0x80
+
+static struct VgCharTable {
+   unsigned char cls[256];
+
+   VgCharTable() {
+      for ( int c = 0; c < 256; c++ ) {
+         unsigned char cc = 0;
+         if ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) ||
+              c == '_' || c == ':' ) {
+            cc |= VG_CC_NAMESTART | VG_CC_NAME;
+         }
+         if ( ( c >= '0' && c <= '9' ) || c == '-' || c == '.' ) {
+            cc |= VG_CC_NAME;
+         }
+         if ( c == ' ' || c == '\t' || c == '\n' || c == '\r' ) {
+            cc |= VG_CC_SPACE;
+         }
+         else if ( c < 0x20 ) {
+            cc |= VG_CC_CTRL;
+         }
+         if ( c == '<' || c == '>' || c == '&' ) {
+            cc |= VG_CC_STOP;
+         }
+         if ( c >= 0x80 ) {
+            cc |= VG_CC_HIGH;
+         }
+         cls[c] = cc;
+      }
+   }
+} charTable;
+
+static inline unsigned char charClass( char c )
+{
+   return charTable.cls[( unsigned char )c];
+}
+
+
+
+/**********************************************************************/
+/* Text scanning
+   Find the first '<', '>' or '&' in [p, end): end if none.
+   'flags' gets VG_TOK_* for what's in the bytes skipped.
+*/
+typedef const char* ( *VgScanFn )( const char* p, const char* end, int* flags );
+
+static const char* scanScalar( const char* p, const char* end, int* flags )
+{
+   for ( ; p < end; p++ ) {
+      unsigned char cc = charClass( *p );
+      if ( cc & ( VG_CC_STOP | VG_CC_CTRL | VG_CC_HIGH ) ) {
+         if ( cc & VG_CC_STOP ) {
+            break;
+         }
+         *flags |= ( cc & VG_CC_HIGH ) ? VG_TOK_HIGH : VG_TOK_CTRL;
+      }
+   }
+   return p;
+}
+
+#if defined( VG_TOK_SSE2 ) || defined( VG_TOK_AVX2 )
+/*
+  stop, high, ctrl: one bit per byte of the block.
+  Returns the offset of the first stop byte, or -1,
+  having added in the flags for the bytes before it.
+*/
+static inline int blockStop( unsigned stop, unsigned high, unsigned ctrl,
+                             int* flags )
+{
+   int at = -1;
+   if ( stop != 0 ) {
+      unsigned before = ( stop & -stop ) - 1;
+      high &= before;
+      ctrl &= before;
+      at = __builtin_ctz( stop );
+   }
+   if ( high != 0 ) {
+      *flags |= VG_TOK_HIGH;
+   }
+   if ( ctrl != 0 ) {
+      *flags |= VG_TOK_CTRL;
+   }
+   return at;
+}
+#endif
+
+#ifdef VG_TOK_SSE2
+static const char* scanSse2( const char* p, const char* end, int* flags )
+{
+   const __m128i lt  = _mm_set1_epi8( '<' );
+   const __m128i gt  = _mm_set1_epi8( '>' );
+   const __m128i amp = _mm_set1_epi8( '&' );
+   const __m128i c1f = _mm_set1_epi8( 0x1f );
+   const __m128i tab = _mm_set1_epi8( '\t' );
+   const __m128i nl  = _mm_set1_epi8( '\n' );
+   const __m128i cr  = _mm_set1_epi8( '\r' );
+
+   for ( ; end - p >= 16; p += 16 ) {
+      __m128i x = _mm_loadu_si128( ( const __m128i* )p );
+
+      __m128i stop = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( x, lt ),
+                                                 _mm_cmpeq_epi8( x, gt ) ),
+                                   _mm_cmpeq_epi8( x, amp ) );
+      // x <= 0x1f, but not whitespace
+      __m128i ctrl = _mm_cmpeq_epi8( _mm_min_epu8( x, c1f ), x );
+      __m128i ws   = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( x, tab ),
+                                                 _mm_cmpeq_epi8( x, nl ) ),
+                                   _mm_cmpeq_epi8( x, cr ) );
+      ctrl = _mm_andnot_si128( ws, ctrl );
+
+      int at = blockStop( _mm_movemask_epi8( stop ), _mm_movemask_epi8( x ),
+                          _mm_movemask_epi8( ctrl ), flags );
+      if ( at >= 0 ) {
+         return p + at;
+      }
+   }
+
+   return scanScalar( p, end, flags );
+}
+#endif
+
+#ifdef VG_TOK_AVX2
+__attribute__(( target( "avx2" ) ))
+static const char* scanAvx2( const char* p, const char* end, int* flags )
+{
+   const __m256i lt  = _mm256_set1_epi8( '<' );
+   const __m256i gt  = _mm256_set1_epi8( '>' );
+   const __m256i amp = _mm256_set1_epi8( '&' );
+   const __m256i c1f = _mm256_set1_epi8( 0x1f );
+   const __m256i tab = _mm256_set1_epi8( '\t' );
+   const __m256i nl  = _mm256_set1_epi8( '\n' );
+   const __m256i cr  = _mm256_set1_epi8( '\r' );
+
+   for ( ; end - p >= 32; p += 32 ) {
+      __m256i x = _mm256_loadu_si256( ( const __m256i* )p );
+
+      __m256i stop = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( x, lt ),
+                                                       _mm256_cmpeq_epi8( x, gt ) ),
+                                      _mm256_cmpeq_epi8( x, amp ) );
+      __m256i ctrl = _mm256_cmpeq_epi8( _mm256_min_epu8( x, c1f ), x );
+      __m256i ws   = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( x, tab ),
+                                                       _mm256_cmpeq_epi8( x, nl ) ),
+                                      _mm256_cmpeq_epi8( x, cr ) );
+      ctrl = _mm256_andnot_si256( ws, ctrl );
+
+      int at = blockStop( _mm256_movemask_epi8( stop ), _mm256_movemask_epi8( x ),
+                          _mm256_movemask_epi8( ctrl ), flags );
+      if ( at >= 0 ) {
+         return p + at;
+      }
+   }
+
+   return scanScalar( p, end, flags );
+}
+#endif
+
+static VgScanFn pickScan()
+{
+#ifdef VG_TOK_AVX2
+   __builtin_cpu_init();   // we may run before main()
+   if ( __builtin_cpu_supports( "avx2" ) ) {
+      return scanAvx2;
+   }
+#endif
+#ifdef VG_TOK_SSE2
+   return scanSse2;
+#else
+   return scanScalar;
+#endif
+}
+
+static const VgScanFn scanText = pickScan();
+
+
+
+/**********************************************************************/
+/* helpers */
+
+/*
+  Find 'pat' in [p, end), or 0
+*/
+static const char* findStr( const char* p, const char* end, const char* pat )
+{
+   qint64 n = strlen( pat );
+
+   while ( end - p >= n ) {
+      p = ( const char* )memchr( p, pat[0], end - p - n + 1 );
+      if ( p == 0 ) {
+         return 0;
+      }
+      if ( memcmp( p, pat, n ) == 0 ) {
+         return p;
+      }
+      p++;
+   }
+   return 0;
+}
+
+static inline bool isXmlChar( uint c )
+{
+   return c == 0x9 || c == 0xA || c == 0xD ||
+          ( c >= 0x20 && c <= 0xD7FF ) ||
+          ( c >= 0xE000 && c <= 0xFFFD ) ||
+          ( c >= 0x10000 && c <= 0x10FFFF );
+}
+
+/*
+  Well-formed utf-8, of chars xml allows?
+   - the scan has already checked the ascii control chars.
+*/
+static bool isXmlUtf8( const char* str, int len )
+{
+   const uchar* p = ( const uchar* )str;
+   const uchar* e = p + len;
+
+   while ( p < e ) {
+      uint c = *p++;
+      if ( c < 0x80 ) {
+         continue;
+      }
+
+      int n;
+      uint min;
+      if ( ( c & 0xE0 ) == 0xC0 ) {
+         n = 1;  c &= 0x1F;  min = 0x80;
+      }
+      else if ( ( c & 0xF0 ) == 0xE0 ) {
+         n = 2;  c &= 0x0F;  min = 0x800;
+      }
+      else if ( ( c & 0xF8 ) == 0xF0 ) {
+         n = 3;  c &= 0x07;  min = 0x10000;
+      }
+      else {
+         return false;
+      }
+
+      if ( e - p < n ) {
+         return false;
+      }
+      for ( ; n > 0; n-- ) {
+         if ( ( *p & 0xC0 ) != 0x80 ) {
+            return false;
+         }
+         c = ( c << 6 ) | ( *p++ & 0x3F );
+      }
+
+      // overlong, surrogate, out of range, ...
+      if ( c < min || !isXmlChar( c ) ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/*
+  Nothing but chars xml allows in [p, e): e.g. a comment
+*/
+static bool isXmlText( const char* p, const char* e )
+{
+   bool high = false;
+   for ( const char* c = p; c < e; c++ ) {
+      unsigned char cc = charClass( *c );
+      if ( cc & VG_CC_CTRL ) {
+         return false;
+      }
+      if ( cc & VG_CC_HIGH ) {
+         high = true;
+      }
+   }
+   return !high || isXmlUtf8( p, e - p );
+}
+
+static void appendUtf8( QByteArray& buf, uint c )
+{
+   if ( c < 0x80 ) {
+      buf += char( c );
+   }
+   else if ( c < 0x800 ) {
+      buf += char( 0xC0 | ( c >> 6 ) );
+      buf += char( 0x80 | ( c & 0x3F ) );
+   }
+   else if ( c < 0x10000 ) {
+      buf += char( 0xE0 | ( c >> 12 ) );
+      buf += char( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+      buf += char( 0x80 | ( c & 0x3F ) );
+   }
+   else {
+      buf += char( 0xF0 | ( c >> 18 ) );
+      buf += char( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+      buf += char( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+      buf += char( 0x80 | ( c & 0x3F ) );
+   }
+}
+
+
+
+/**********************************************************************/
+/*!
+  VgLogTokenizer
+*/
+VgLogTokenizer::VgLogTokenizer( VgLogHandler* hnd )
+   : handler( hnd ), base( 0 ), end( 0 ), pos( 0 ), docStart( 0 ),
+     offset( 0 ), total( 0 ), seenRoot( false ), rootDone( false ),
+     progressStep( 0 ), nextProgress( 0 )
+{
+   refBuf.reserve( VG_TOK_REFBUF_RESERVE );
+}
+
+
+const char* VgLogTokenizer::scanMode()
+{
+#ifdef VG_TOK_AVX2
+   if ( scanText == scanAvx2 ) {
+      return "avx2";
+   }
+#endif
+#ifdef VG_TOK_SSE2
+   if ( scanText == scanSse2 ) {
+      return "sse2";
+   }
+#endif
+   return "scalar";
+}
+
+
+/*!
+  Tokenize a complete document, passing the tokens to the handler.
+   - the handler's startDocument() is for the caller.
+*/
+VgLogTokenizer::Result VgLogTokenizer::parse( const char* data, qint64 size )
+{
+   start( size );
+
+   Result res = tokenize( data, size, true );
+   return ( res == OK ) ? finish() : res;
+}
+
+
+/*!
+  Tokenize a complete document given in consecutive parts: e.g. a
+  chunk of a mapped log, and the document tags to either side of it,
+  so the chunk needn't be copied to put them round it.
+   - each part must end between tags, and outlive the parse.
+*/
+VgLogTokenizer::Result VgLogTokenizer::parse( const QList<QByteArray>& parts )
+{
+   qint64 size = 0;
+   foreach( const QByteArray& part, parts ) {
+      size += part.size();
+   }
+   start( size );
+
+   for ( int i = 0; i < parts.count(); i++ ) {
+      Result res = tokenize( parts[i].constData(), parts[i].size(), i == 0 );
+      if ( res != OK ) {
+         return res;
+      }
+   }
+   return finish();
+}
+
+
+void VgLogTokenizer::start( qint64 size )
+{
+   base = end = pos = docStart = 0;
+   offset = 0;
+   total = size;
+   stack.resize( 0 );
+   seenRoot = false;
+   rootDone = false;
+   nextProgress = progressStep;
+}
+
+
+/*
+  The next part of the document: all of it, if there's just the one
+*/
+VgLogTokenizer::Result VgLogTokenizer::tokenize( const char* data, qint64 size,
+                                                 bool first )
+{
+   offset += end - base;
+   base = data;
+   end  = data + size;
+   pos  = data;
+
+   if ( first ) {
+      // utf-8 byte order mark
+      if ( size >= 3 && memcmp( pos, "\xEF\xBB\xBF", 3 ) == 0 ) {
+         pos += 3;
+      }
+      docStart = pos;
+   }
+
+   while ( pos < end ) {
+      Result res;
+      if ( *pos != '<' ) {
+         res = text();
+      }
+      else if ( end - pos < 2 ) {
+         res = UNSUPPORTED;
+      }
+      else if ( pos[1] == '/' ) {
+         res = endTag();
+      }
+      else if ( pos[1] == '?' ) {
+         res = procInstr();
+      }
+      else if ( pos[1] == '!' ) {
+         res = ( end - pos >= 9 && memcmp( pos, "<![CDATA[", 9 ) == 0 )
+               ? cdata() : comment();
+      }
+      else {
+         res = startTag();
+      }
+
+      if ( res != OK ) {
+         return res;
+      }
+   }
+
+   return OK;
+}
+
+
+/*
+  All the document's been tokenized
+*/
+VgLogTokenizer::Result VgLogTokenizer::finish()
+{
+   if ( !rootDone ) {
+      // incomplete: let QXmlStreamReader say why
+      return UNSUPPORTED;
+   }
+
+   if ( handler != 0 && !handler->endDocument() ) {
+      return consumerError( end );
+   }
+   return OK;
+}
+
+
+/*
+  Text, up to the next tag
+*/
+VgLogTokenizer::Result VgLogTokenizer::text()
+{
+   const char* start = pos;
+   const char* p = pos;
+   int flags = 0;
+   bool refs = false;
+
+   for ( ;; ) {
+      p = scanText( p, end, &flags );
+      if ( p == end || *p == '<' ) {
+         break;
+      }
+      if ( *p == '&' ) {
+         refs = true;
+      }
+      else if ( p - start >= 2 && p[-1] == ']' && p[-2] == ']' ) {
+         return UNSUPPORTED;   // ']]>' isn't allowed in text
+      }
+      p++;
+   }
+   pos = p;
+
+   if ( ( flags & VG_TOK_CTRL ) || p - start > INT_MAX ) {
+      return UNSUPPORTED;
+   }
+
+   int len = p - start;
+
+   if ( stack.isEmpty() ) {
+      // outside the document element: whitespace only
+      for ( const char* c = start; c < p; c++ ) {
+         if ( !( charClass( *c ) & VG_CC_SPACE ) ) {
+            return UNSUPPORTED;
+         }
+      }
+      return OK;
+   }
+
+   bool ascii = !( flags & VG_TOK_HIGH );
+   if ( !ascii && !isXmlUtf8( start, len ) ) {
+      return UNSUPPORTED;
+   }
+
+   const char* txt = start;
+   if ( refs ) {
+      if ( !decodeRefs( start, len, ascii ) ) {
+         return UNSUPPORTED;
+      }
+      txt = refBuf.constData();
+      len = refBuf.size();
+   }
+
+   if ( handler != 0 && !handler->characters( txt, len, ascii ) ) {
+      return consumerError( start );
+   }
+   return OK;
+}
+
+
+/*
+  <name> or <name/>: no attributes
+*/
+VgLogTokenizer::Result VgLogTokenizer::startTag()
+{
+   const char* name = pos + 1;
+   const char* p = name;
+
+   if ( !( charClass( *p ) & VG_CC_NAMESTART ) ) {
+      return UNSUPPORTED;
+   }
+   while ( p < end && ( charClass( *p ) & VG_CC_NAME ) ) {
+      p++;
+   }
+   int len = p - name;
+
+   while ( p < end && ( charClass( *p ) & VG_CC_SPACE ) ) {
+      p++;
+   }
+   bool empty = false;
+   if ( p < end && *p == '/' ) {
+      empty = true;
+      p++;
+   }
+   if ( p >= end || *p != '>' ) {
+      return UNSUPPORTED;   // attributes, or cut short
+   }
+
+   if ( stack.isEmpty() ) {
+      if ( seenRoot ) {
+         return UNSUPPORTED;   // a second document element
+      }
+      seenRoot = true;
+   }
+
+   if ( handler != 0 && !handler->startElement( name, len ) ) {
+      return consumerError( pos );
+   }
+
+   if ( empty ) {
+      if ( handler != 0 && !handler->endElement() ) {
+         return consumerError( pos );
+      }
+      if ( stack.isEmpty() ) {
+         rootDone = true;
+      }
+   }
+   else {
+      Tag tag = { name, len };
+      stack.append( tag );
+   }
+
+   pos = p + 1;
+   return OK;
+}
+
+
+/*
+  </name>: must match the open element
+*/
+VgLogTokenizer::Result VgLogTokenizer::endTag()
+{
+   const char* name = pos + 2;
+   const char* p = name;
+
+   while ( p < end && ( charClass( *p ) & VG_CC_NAME ) ) {
+      p++;
+   }
+   int len = p - name;
+
+   while ( p < end && ( charClass( *p ) & VG_CC_SPACE ) ) {
+      p++;
+   }
+   if ( p >= end || *p != '>' || stack.isEmpty() ) {
+      return UNSUPPORTED;
+   }
+
+   const Tag& open = stack.last();
+   if ( open.len != len || memcmp( open.name, name, len ) != 0 ) {
+      return UNSUPPORTED;
+   }
+   stack.removeLast();
+
+   if ( handler != 0 && !handler->endElement() ) {
+      return consumerError( pos );
+   }
+
+   pos = p + 1;
+
+   if ( stack.isEmpty() ) {
+      rootDone = true;
+   }
+   else if ( stack.count() == 1 && progressStep > 0 &&
+             offset + ( pos - base ) >= nextProgress ) {
+      // a top-level element done: a good time to report progress
+      qint64 done = offset + ( pos - base );
+      nextProgress = done + progressStep;
+      if ( handler != 0 && !handler->loadProgress( done, total ) ) {
+         handler->fatalError( "Load cancelled", 0, 0 );
+         return FAILED;
+      }
+   }
+
+   return OK;
+}
+
+
+/*
+  <?target ... ?>
+   - the xml declaration only as valgrind writes it, give or take.
+*/
+VgLogTokenizer::Result VgLogTokenizer::procInstr()
+{
+   static const char* const xmlDecls[] = {
+      " version=\"1.0\"",
+      " version='1.0'",
+      " version=\"1.0\" encoding=\"UTF-8\"",
+      " version=\"1.0\" encoding=\"utf-8\"",
+      0
+   };
+
+   const char* target = pos + 2;
+   const char* close = findStr( target, end, "?>" );
+   if ( close == 0 || !( charClass( *target ) & VG_CC_NAMESTART ) ||
+        !isXmlText( target, close ) ) {
+      return UNSUPPORTED;
+   }
+
+   const char* p = target;
+   while ( p < close && ( charClass( *p ) & VG_CC_NAME ) ) {
+      p++;
+   }
+   if ( p < close && !( charClass( *p ) & VG_CC_SPACE ) ) {
+      return UNSUPPORTED;
+   }
+
+   if ( p - target == 3 && strncasecmp( target, "xml", 3 ) == 0 ) {
+      // at the very start only
+      if ( pos != docStart || memcmp( target, "xml", 3 ) != 0 ) {
+         return UNSUPPORTED;
+      }
+      const char* e = close;
+      while ( e > p && ( charClass( e[-1] ) & VG_CC_SPACE ) ) {
+         e--;
+      }
+      int i = 0;
+      for ( ; xmlDecls[i] != 0; i++ ) {
+         if ( e - p == ( qint64 )strlen( xmlDecls[i] ) &&
+              memcmp( p, xmlDecls[i], e - p ) == 0 ) {
+            break;
+         }
+      }
+      if ( xmlDecls[i] == 0 ) {
+         return UNSUPPORTED;
+      }
+   }
+
+   pos = close + 2;
+   return OK;
+}
+
+
+/*
+  <!-- ... -->: anything else (dtd) isn't for us.
+*/
+VgLogTokenizer::Result VgLogTokenizer::comment()
+{
+   if ( end - pos < 4 || memcmp( pos, "<!--", 4 ) != 0 ) {
+      return UNSUPPORTED;
+   }
+
+   // '--' may only end a comment
+   const char* dashes = findStr( pos + 4, end, "--" );
+   if ( dashes == 0 || end - dashes < 3 || dashes[2] != '>' ||
+        !isXmlText( pos + 4, dashes ) ) {
+      return UNSUPPORTED;
+   }
+
+   pos = dashes + 3;
+   return OK;
+}
+
+
+/*
+  <![CDATA[ ... ]]>: e.g. a suppression's <rawtext>
+   - the raw bytes are the text: no refs to resolve.
+*/
+VgLogTokenizer::Result VgLogTokenizer::cdata()
+{
+   const char* txt = pos + 9;
+   const char* close = findStr( txt, end, "]]>" );
+   if ( close == 0 || stack.isEmpty() || close - txt > INT_MAX ||
+        !isXmlText( txt, close ) ) {
+      return UNSUPPORTED;
+   }
+
+   int len = close - txt;
+   bool ascii = true;
+   for ( int i = 0; i < len && ascii; i++ ) {
+      ascii = !( charClass( txt[i] ) & VG_CC_HIGH );
+   }
+
+   if ( len > 0 && handler != 0 && !handler->characters( txt, len, ascii ) ) {
+      return consumerError( pos );
+   }
+
+   pos = close + 3;
+   return OK;
+}
+
+
+/*
+  Resolve the entity & char refs in txt[0..len), into refBuf
+   - false for any we don't know, or that's malformed.
+   - ascii is cleared if any resolves to a non-ascii char.
+*/
+bool VgLogTokenizer::decodeRefs( const char* txt, int len, bool& ascii )
+{
+   const char* s = txt;
+   const char* e = txt + len;
+
+   refBuf.resize( 0 );
+
+   while ( s < e ) {
+      const char* amp = ( const char* )memchr( s, '&', e - s );
+      if ( amp == 0 ) {
+         refBuf.append( s, e - s );
+         break;
+      }
+      refBuf.append( s, amp - s );
+
+      const char* semi = ( const char* )memchr( amp, ';',
+                                                qMin( int( e - amp ), VG_TOK_REF_MAX ) );
+      if ( semi == 0 ) {
+         return false;
+      }
+
+      const char* ref = amp + 1;
+      int n = semi - ref;
+
+      if ( n >= 2 && ref[0] == '#' ) {
+         bool hex = ( ref[1] == 'x' );
+         const char* d = ref + ( hex ? 2 : 1 );
+         if ( d == semi ) {
+            return false;
+         }
+
+         uint c = 0;
+         for ( ; d < semi; d++ ) {
+            uint v;
+            char lc = *d | 0x20;
+            if ( *d >= '0' && *d <= '9' ) {
+               v = *d - '0';
+            }
+            else if ( hex && lc >= 'a' && lc <= 'f' ) {
+               v = lc - 'a' + 10;
+            }
+            else {
+               return false;
+            }
+            c = c * ( hex ? 16 : 10 ) + v;
+            if ( c > 0x10FFFF ) {
+               return false;
+            }
+         }
+
+         if ( !isXmlChar( c ) ) {
+            return false;
+         }
+         if ( c >= 0x80 ) {
+            ascii = false;
+         }
+         appendUtf8( refBuf, c );
+      }
+      else if ( n == 2 && memcmp( ref, "lt", 2 ) == 0 ) {
+         refBuf += '<';
+      }
+      else if ( n == 2 && memcmp( ref, "gt", 2 ) == 0 ) {
+         refBuf += '>';
+      }
+      else if ( n == 3 && memcmp( ref, "amp", 3 ) == 0 ) {
+         refBuf += '&';
+      }
+      else if ( n == 4 && memcmp( ref, "quot", 4 ) == 0 ) {
+         refBuf += '"';
+      }
+      else if ( n == 4 && memcmp( ref, "apos", 4 ) == 0 ) {
+         refBuf += '\'';
+      }
+      else {
+         return false;
+      }
+
+      s = semi + 1;
+   }
+
+   return true;
+}
+
+
+/*
+  The handler gave up: report it as QXmlStreamReader would
+   - the line is within the part being tokenized.
+*/
+VgLogTokenizer::Result VgLogTokenizer::consumerError( const char* at )
+{
+   qint64 line = 1;
+   const char* lineStart = base;
+   const char* nl;
+   while ( ( nl = ( const char* )memchr( lineStart, '\n', at - lineStart ) ) != 0 ) {
+      lineStart = nl + 1;
+      line++;
+   }
+
+   handler->fatalError( "error triggered by consumer", line, at - lineStart );
+   return FAILED;
+}
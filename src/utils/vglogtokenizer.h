@@ -0,0 +1,108 @@
+/****************************************************************************
+** VgLogTokenizer definition
+**  - fast tokenizer for complete valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGTOKENIZER_H
+#define __VGLOGTOKENIZER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QtGlobal>
+
+class VgLogHandler;
+
+
+// ============================================================
+/*!
+  VgLogTokenizer: fast path for a complete valgrind xml log in memory
+   - valgrind's xml (protocol 4) is a small, regular subset of xml:
+     utf-8, no attributes, no dtd, the five predefined entities, and
+     cdata only for the raw text of suppressions (--gen-suppressions).
+     Just that subset is tokenized here, straight from the
+     raw bytes, skipping through the text 16 (sse2) or 32 (avx2, if
+     the cpu has it) bytes at a time.
+   - tokens go to a VgLogHandler, as from VgLogReader's QXmlStreamReader.
+   - anything else, or anything wrong, gives UNSUPPORTED, stopping where
+     it is: VgLogReader then starts over with QXmlStreamReader, which
+     has the final say (and the error messages).
+   - with no handler, it only tokenizes: see bench/vglogbench/vglogbench.cpp.
+*/
+class VgLogTokenizer
+{
+public:
+   enum Result {
+      OK,            // all parsed
+      FAILED,        // the handler gave up: fatalError() already called
+      UNSUPPORTED    // not for us: use the general parser
+   };
+
+   VgLogTokenizer( VgLogHandler* hnd );
+
+   /* have the handler's loadProgress() called every 'step' bytes */
+   void setProgressStep( qint64 step ) {
+      progressStep = step;
+   }
+
+   Result parse( const char* data, qint64 size );
+   Result parse( const QList<QByteArray>& parts );
+
+   /* how the text is scanned on this cpu: "avx2", "sse2" or "scalar" */
+   static const char* scanMode();
+
+private:
+   void start( qint64 size );
+   Result tokenize( const char* data, qint64 size, bool first );
+   Result finish();
+
+   Result text();
+   Result startTag();
+   Result endTag();
+   Result procInstr();
+   Result comment();
+   Result cdata();
+
+   bool decodeRefs( const char* txt, int len, bool& ascii );
+   Result consumerError( const char* at );
+
+private:
+   struct Tag {
+      const char* name;
+      int len;
+   };
+
+   VgLogHandler* handler;
+
+   const char* base;       // the document, or the part of it being done
+   const char* end;
+   const char* pos;        // next byte to tokenize
+   const char* docStart;   // after any byte order mark
+   qint64 offset;          // of base in the whole document
+   qint64 total;           // the whole document's size
+
+   QVector<Tag> stack;     // open elements: names point into the document
+   QByteArray refBuf;      // text with its entities resolved
+   bool seenRoot;
+   bool rootDone;
+
+   qint64 progressStep;
+   qint64 nextProgress;
+};
+
+#endif // #ifndef __VGLOGTOKENIZER_H
@@ -0,0 +1,520 @@
+/****************************************************************************
+** VgLogWorker implementation
+**  - parses a valgrind xml log in a background thread
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogworker.h"
+#include "utils/vglogindex.h"
+#include "utils/vgloginput.h"
+#include "utils/vglogloader.h"
+#include "utils/vglogsource.h"
+#include "utils/vk_atoms.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMetaType>
+
+#include <limits.h>
+#include <string.h>
+
+
+// max records per hand-off to the gui thread
+#define VG_LOG_BATCH_MAX 100
+// max batches posted, and not yet taken by the gui thread
+#define VG_LOG_BATCHES_AHEAD 64
+// msecs between checks for an abort, while waiting on the gui thread
+#define VG_LOG_WAIT_MSECS 50
+// msecs between progress reports
+#define VG_LOG_PROGRESS_MSECS 50
+// msecs into (each part of) a load before there's any point guessing an eta
+#define VG_LOG_ETA_MIN_MSECS 1000
+
+
+
+// ============================================================
+/*
+  Passes on just the run's summary records: for the end of a paged load
+*/
+class VgLogTailSink : public VgLogSink
+{
+public:
+   VgLogTailSink( VgLogSink* s ) : sink( s ) { }
+
+   bool init( QString ) {
+      return true;   // the head's done that
+   }
+   bool appendNode( const VgLogRecord& rec, QString& errMsg ) {
+      return !rec.isSummary() || sink->appendNode( rec, errMsg );
+   }
+
+private:
+   VgLogSink* sink;
+};
+
+
+/**********************************************************************/
+/*!
+  VgLogWorker
+*/
+VgLogWorker::VgLogWorker( QString logfile )
+   : QObject(), logFname( logfile ), vgreader( 0 ), aborted( 0 ),
+     batchesFree( VG_LOG_BATCHES_AHEAD ), nErrors( 0 ), nSent( 0 ),
+     nSkip( 0 ), initSent( false ), logSize( 0 ), lastDone( 0 )
+{
+   // records cross threads via queued connections
+   qRegisterMetaType<VgLogRecordList>( "VgLogRecordList" );
+   qRegisterMetaType<VgLogRanges>( "VgLogRanges" );
+}
+
+VgLogWorker::~VgLogWorker()
+{
+   if ( vgreader != 0 ) {
+      delete vgreader;
+      vgreader = 0;
+   }
+}
+
+
+/*!
+  Stop parsing asap. Thread-safe.
+*/
+void VgLogWorker::abort()
+{
+   aborted.storeRelease( 1 );
+}
+
+bool VgLogWorker::isAborted()
+{
+   return aborted.loadAcquire() != 0;
+}
+
+
+/*!
+  The gui thread has dealt with one of our batches. Thread-safe.
+*/
+void VgLogWorker::recordsTaken()
+{
+   batchesFree.release();
+}
+
+
+/*!
+  Read & parse everything currently in the log.
+   - invoked via queued calls, so runs in the worker thread.
+   - reports back via parsed(), unless aborted.
+*/
+void VgLogWorker::parse()
+{
+   if ( isAborted() ) {
+      return;
+   }
+
+   bool ok = true;
+
+   if ( vgreader == 0 ) {
+      // first time around...
+      vgreader = new VgLogReader( this );
+      ok = vgreader->parse( logFname, true/*incremental*/ );
+   }
+   else {
+      // reads all that's available
+      ok = vgreader->parseContinue();
+   }
+
+   reportParsed( ok );
+}
+
+
+/*!
+  Parse the next lot of a streamed log: atEnd if there's no more to come.
+   - invoked via queued calls, so runs in the worker thread,
+     and gets the data in the order it was sent.
+*/
+void VgLogWorker::parseStream( QByteArray data, bool atEnd )
+{
+   if ( isAborted() ) {
+      return;
+   }
+
+   if ( vgreader == 0 ) {
+      // first time around...
+      vgreader = new VgLogReader( this );
+      vgreader->startStream();
+   }
+   else if ( vgreader->handler()->finished() ) {
+      // anything after the document: nothing more to tell
+      emit streamParsed( data.size() );
+      return;
+   }
+
+   bool ok = vgreader->parseStream( data, atEnd );
+   if ( isAborted() ) {
+      return;
+   }
+   emit streamParsed( data.size() );
+   reportParsed( ok );
+}
+
+
+/*!
+  Load a complete (saved) log, in one go.
+   - invoked via a queued call, so runs in the worker thread.
+   - maxErrors: just the first page of errors, if the log has more
+     than that (see loadPaged()): the rest are read in when wanted.
+   - lazy: for a huge log, first find the byte range of each error in
+     the log, so the view can drop the details of each error as it
+     goes, and re-read them when needed (see VgLogView::setLazySource).
+     Then a streaming parse: no index, and no parallel load, as those
+     hold all the records at once.
+   - otherwise, replay the log's index if it's still valid, else decode
+     the log on all cores, falling back to a plain sequential parse
+     (which also gives the exact position of any xml errors).
+     Next time, we needn't parse it at all: the index is saved.
+   - reports progress() every so often, and parsed() once done,
+     unless aborted: records already passed on are the gui's to keep.
+*/
+void VgLogWorker::load( bool lazy, int maxErrors/*=0*/ )
+{
+   if ( isAborted() ) {
+      return;
+   }
+
+   logSize  = QFileInfo( logFname ).size();
+   nErrors  = nSent = nSkip = 0;
+   initSent = false;
+   lastDone = 0;
+   phaseTimer.start();
+   reportTimer.start();
+
+   QElapsedTimer timer;
+   timer.start();
+   bool ok = false;
+   QString fatalMsg;
+
+   if ( maxErrors > 0 && loadPaged( maxErrors, ok, fatalMsg ) ) {
+      VK_DEBUG( "Loaded log (first %d errors) in %.3f s",
+                maxErrors, timer.elapsed() / 1000.0 );
+   }
+   else if ( lazy ) {
+      VgLogRanges ranges;
+      if ( VgLogSource::findErrorRanges( logFname, ranges, this ) ) {
+         emit lazyRangesFound( logFname, ranges );
+      }
+
+      VgLogReader vgLogFileReader( this );
+      ok = vgLogFileReader.parse( logFname );
+      fatalMsg = vgLogFileReader.handler()->fatalMsg();
+      VK_DEBUG( "Loaded log (lazy mode) in %.3f s", timer.elapsed() / 1000.0 );
+   }
+   else {
+      VgLogIndex vgLogIndex;
+
+      if ( vgLogIndex.load( logFname ) ) {
+         ok = vgLogIndex.replay( this, fatalMsg );
+         VK_DEBUG( "Loaded log index in %.3f s", timer.elapsed() / 1000.0 );
+      }
+      else {
+         // vgLogIndex passes the records on to us, writing the index
+         // as it goes.
+         vgLogIndex.setSink( this );
+         vgLogIndex.startSave( logFname );
+         VgLogLoader vgLogLoader( &vgLogIndex );
+         ok = vgLogLoader.load( logFname );
+         fatalMsg = vgLogLoader.fatalMsg();
+
+         if ( !ok && fatalMsg.isEmpty() && !isAborted() ) {
+            // couldn't load it that way: plain sequential parse.
+            //  - the loader may have passed on the first few chunks:
+            //    the gui has those already.
+            nSkip = nSent;
+            VgLogReader vgLogFileReader( &vgLogIndex );
+            ok = vgLogFileReader.parse( logFname );
+            fatalMsg = vgLogFileReader.handler()->fatalMsg();
+         }
+         else if ( ok ) {
+            // throughput by thread count: see bench/vglogbench
+            VK_DEBUG( "Loaded %.1f MB in %.3f s (%d threads)",
+                      vgLogLoader.bytes() / ( 1024.0 * 1024.0 ),
+                      vgLogLoader.msecs() / 1000.0, vgLogLoader.threads() );
+            VK_DEBUG( "Frame strings: %d atoms, ~%.1f MB",
+                      VkAtom::tableCount(), VkAtom::tableBytes() / ( 1024.0 * 1024.0 ) );
+         }
+
+         if ( ok && !isAborted() ) {
+            vgLogIndex.save();
+         }
+      }
+   }
+
+   if ( isAborted() ) {
+      return;
+   }
+
+   flushRecords();
+
+   // all there is: finished, one way or another
+   emit parsed( ok && fatalMsg.isEmpty(), true, fatalMsg );
+}
+
+
+/*
+  Paged load: the log up to just after its maxErrors'th top-level
+  </error>, then the run's summary: the last <status>, <errorcounts>,
+  <suppcounts> and <fatal_signal> past that, each found searching back
+  from the end of the log.
+   - the summary's not simply all after the last </error>: memcheck's
+     leak errors come after the final status. Nor is it all of those
+     elements: errorcounts may come every so often, the earlier ones
+     with smaller counts.
+   - the rest, up to just after the last </error>, is left in the log:
+     pagedRestFound() says where, before the summary's records, for the
+     view to read its errors in a page at a time
+     (see VgLogView::setPagedSource).
+   - only the head and the end of the log are read: the time taken
+     doesn't depend much on how big the log is.
+   - returns false if the log's not worth paging (too few errors),
+     or can't be (compressed, or not as we expect): nothing's been
+     sent, so load it in full instead.
+*/
+bool VgLogWorker::loadPaged( int maxErrors, bool& ok, QString& fatalMsg )
+{
+   // byte offsets in compressed data would be of no use
+   if ( VgLogInput::isCompressedFile( logFname ) ) {
+      return false;
+   }
+
+   QFile file( logFname );
+   if ( !file.open( QIODevice::ReadOnly ) || file.size() == 0 ) {
+      return false;
+   }
+   qint64 size = file.size();
+
+   uchar* map = file.map( 0, size );
+   if ( map == 0 ) {
+      return false;
+   }
+   const char* log = ( const char* )map;
+
+   // find the head, rest & summary -----------------------------------
+   int nFound = 0;
+   qint64 bodyStart = 0;
+   QByteArray docTag = VgLogSource::findDocTag( log, size, bodyStart );
+   qint64 headEnd = docTag.isEmpty() ? size :
+                    VgLogSource::findErrorsEnd( log, size, bodyStart,
+                                                maxErrors, &nFound );
+
+   qint64 restEnd = -1;
+   if ( nFound == maxErrors && headEnd < size && headEnd < INT_MAX / 2 ) {
+      restEnd = VgLogSource::findLastBytes( log, size, headEnd, "</error>" );
+      restEnd = ( restEnd == -1 ) ? headEnd : restEnd + strlen( "</error>" );
+   }
+   if ( restEnd == -1 ) {
+      file.unmap( map );
+      return false;
+   }
+
+   // summary elements past the head, by where they start: in log order
+   static const char* const summaryTags[] = {
+      "status", "errorcounts", "suppcounts", "fatal_signal"
+   };
+   QMap<qint64, qint64> summary;
+   for ( size_t i=0; i<sizeof( summaryTags ) / sizeof( summaryTags[0] ); ++i ) {
+      QByteArray startTag = QByteArray( "<" ) + summaryTags[i] + ">";
+      QByteArray endTag   = QByteArray( "</" ) + summaryTags[i] + ">";
+      qint64 start = VgLogSource::findLastBytes( log, size, headEnd,
+                                                 startTag.constData() );
+      if ( start == -1 ) {
+         continue;
+      }
+      qint64 end = VgLogSource::findBytes( log, size, start, endTag.constData() );
+      if ( end == -1 ) {
+         continue;   // cut short: as if not there
+      }
+      summary.insert( start, end + endTag.size() );
+   }
+
+   const QByteArray openDoc  = "<" + docTag + ">";
+   const QByteArray closeDoc = "</" + docTag + ">";
+
+   // head: passed on as is -------------------------------------------
+   QByteArray data( log, headEnd );
+   data += closeDoc;
+   {
+      VgLogReader vgLogHeadReader( this );
+      ok = vgLogHeadReader.parseData( data );
+      fatalMsg = vgLogHeadReader.handler()->fatalMsg();
+   }
+
+   if ( ok && fatalMsg.isEmpty() && !isAborted() ) {
+      flushRecords();
+      emit pagedRestFound( logFname, headEnd, restEnd );
+
+      // summary: just those elements --------------------------------
+      data = openDoc;
+      QMap<qint64, qint64>::const_iterator it;
+      for ( it = summary.constBegin(); it != summary.constEnd(); ++it ) {
+         data.append( log + it.key(), it.value() - it.key() );
+      }
+      data += closeDoc;
+      VgLogTailSink tailSink( this );
+      VgLogReader vgLogTailReader( &tailSink );
+      ok = vgLogTailReader.parseData( data );
+      fatalMsg = vgLogTailReader.handler()->fatalMsg();
+   }
+
+   file.unmap( map );
+   return true;
+}
+
+
+/*!
+  VgLogSink: how the load's going
+   - 'done' of 'total' may be bytes, or e.g. records of an index:
+     reported as bytes of the log, either way.
+   - the eta is for the current part of the load: the parts
+     (e.g. lazy mode's search, then parse) each start from 0.
+*/
+bool VgLogWorker::loadProgress( qint64 done, qint64 total )
+{
+   if ( isAborted() ) {
+      return false;
+   }
+   if ( total <= 0 ) {
+      return true;
+   }
+
+   if ( done < lastDone ) {
+      phaseTimer.restart();   // next part of the load
+   }
+   lastDone = done;
+
+   if ( reportTimer.elapsed() < VG_LOG_PROGRESS_MSECS ) {
+      return true;
+   }
+   reportTimer.restart();
+
+   qint64 bytes = ( total == logSize ) ? done :
+                  ( qint64 )( logSize * ( ( double )done / total ) );
+
+   int secsLeft = -1;   // don't know yet
+   qint64 msecs = phaseTimer.elapsed();
+   if ( done > 0 && msecs >= VG_LOG_ETA_MIN_MSECS ) {
+      secsLeft = ( int )( msecs * ( ( double )( total - done ) / done ) / 1000 );
+   }
+
+   // the records so far first: so the counts match what's shown
+   flushRecords();
+   emit progress( bytes, logSize, nErrors, secsLeft );
+
+   return !isAborted();
+}
+
+
+/*!
+  Hand over what's left of this lot, and say how it went.
+*/
+void VgLogWorker::reportParsed( bool ok )
+{
+   VgLogHandler* hnd = vgreader->handler();
+
+   if ( isAborted() ) {
+      return;
+   }
+
+   flushRecords();
+
+   if ( !hnd->fatalMsg().isEmpty() ) {
+      ok = false;
+   }
+
+   emit parsed( ok, hnd->finished(), hnd->fatalMsg() );
+}
+
+
+/*!
+  VgLogSink: log started
+*/
+bool VgLogWorker::init( QString doc_tag )
+{
+   if ( doc_tag.isEmpty() ) {
+      vkPrintErr( "VgLogWorker::init(): doc_tag isEmpty" );
+      return false;
+   }
+
+   if ( initSent ) {
+      return true;   // load() starting over: the gui knows already
+   }
+   initSent = true;
+
+   emit logStarted( doc_tag );
+   return true;
+}
+
+
+/*!
+  VgLogSink: queue a top-level record for the gui thread
+   - the VgLogView checks the record when it gets it.
+*/
+bool VgLogWorker::appendNode( const VgLogRecord& rec, QString& errMsg )
+{
+   if ( isAborted() ) {
+      errMsg = "Aborted";
+      return false;
+   }
+
+   if ( nSkip > 0 ) {
+      nSkip--;
+      return true;   // passed on before load() started over
+   }
+   if ( rec.type == VG_ELEM::ERROR ) {
+      nErrors++;
+   }
+   nSent++;
+
+   batch.append( rec );
+
+   if ( batch.count() >= VG_LOG_BATCH_MAX ) {
+      flushRecords();
+   }
+
+   return true;
+}
+
+
+/*!
+  Hand off the queued records to the gui thread
+*/
+void VgLogWorker::flushRecords()
+{
+   if ( batch.isEmpty() ) {
+      return;
+   }
+
+   // don't get too far ahead of the gui thread
+   while ( !batchesFree.tryAcquire( 1, VG_LOG_WAIT_MSECS ) ) {
+      if ( isAborted() ) {
+         batch.clear();
+         return;
+      }
+   }
+
+   emit recordsReady( batch );
+   batch.clear();
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+** VgLogWorker definition
+**  - parses a valgrind xml log in a background thread
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGWORKER_H
+#define __VGLOGWORKER_H
+
+#include "utils/vglogreader.h"
+#include "utils/vglogrecord.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSemaphore>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VgLogWorker: drives a VgLogReader from a worker thread.
+
+   - Lives in a parser QThread (moveToThread()): parse() is invoked
+     via queued calls, and reads all the log data currently available.
+   - Without a logfile, the log is streamed to us instead: each lot
+     of data is passed in via a queued parseStream() call, and
+     streamParsed() says when we're done with it, so the caller can
+     hold back the stream while we're behind.
+   - Or a complete (saved) log is loaded in one go, via load(),
+     reporting on its progress() as it goes: or just its first page
+     of errors, plus the run's summary (see loadPaged()).
+   - Decoded records are collected into batches, and posted back
+     to the gui thread via recordsReady(): all item creation is
+     done there, by the VgLogView. The gui thread says when it's
+     taken each batch (recordsTaken()): we don't get more than a
+     few batches ahead of it, so memory stays flat however big the log.
+   - abort() may be called from any thread: parsing stops at the
+     next record or chunk, and no further signals are sent.
+*/
+class VgLogWorker : public QObject, public VgLogSink
+{
+   Q_OBJECT
+public:
+   VgLogWorker( QString logfile = QString() );
+   ~VgLogWorker();
+
+   // VgLogSink: called by our reader, in the worker thread
+   bool init( QString doc_tag );
+   bool appendNode( const VgLogRecord& rec, QString& errMsg );
+   bool loadProgress( qint64 done, qint64 total );
+
+   void abort();
+   void recordsTaken();     // gui thread's done with a batch
+
+public slots:
+   void parse();
+   void parseStream( QByteArray data, bool atEnd );
+   void load( bool lazy, int maxErrors = 0 );
+
+signals:
+   void logStarted( QString doc_tag );
+   void lazyRangesFound( QString logfile, VgLogRanges ranges );
+   void pagedRestFound( QString logfile, qint64 from, qint64 to );
+   void recordsReady( VgLogRecordList recs );
+   void streamParsed( qint64 nbytes );
+   void progress( qint64 bytesDone, qint64 bytesTotal,
+                  int nErrors, int secsLeft );
+   void parsed( bool ok, bool finished, QString fatalMsg );
+
+private:
+   bool isAborted();
+   void flushRecords();
+   void reportParsed( bool ok );
+   bool loadPaged( int maxErrors, bool& ok, QString& fatalMsg );
+
+private:
+   QString logFname;
+   VgLogReader* vgreader;   // created in the worker thread
+   VgLogRecordList batch;
+   QAtomicInt aborted;
+   QSemaphore batchesFree;  // batches we may still post
+
+   // load() only
+   int nErrors;             // error records so far
+   int nSent;               // records passed on so far
+   int nSkip;               // records already passed on, before a restart
+   bool initSent;
+   qint64 logSize;
+   qint64 lastDone;         // as of the last progress report
+   QElapsedTimer phaseTimer;   // since this part of the load started
+   QElapsedTimer reportTimer;  // since the last progress report
+};
+
+#endif // #ifndef __VGLOGWORKER_H
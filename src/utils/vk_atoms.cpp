@@ -0,0 +1,126 @@
+/****************************************************************************
+** VkAtom implementation
+**  - interned strings
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_atoms.h"
+
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QWriteLocker>
+
+
+// ============================================================
+/*
+  The global atom table
+   - interned from the log reader threads, read from the gui thread.
+*/
+class VkAtomTable
+{
+public:
+   VkAtomTable() : bytes( 0 ) {
+      strings.append( QString() );   // atom 0
+   }
+
+   QReadWriteLock lock;
+   QVector<QString> strings;         // atom id -> string
+   QHash<QString, quint32> ids;      // string -> atom id
+   qint64 bytes;                     // total string data
+};
+
+static VkAtomTable& atomTable()
+{
+   static VkAtomTable table;
+   return table;
+}
+
+
+
+/**********************************************************************/
+/*!
+  Intern the given string
+   - most strings have been seen before: only take the write lock
+     when we have a new one.
+*/
+VkAtom::VkAtom( const QString& str )
+   : id( 0 )
+{
+   if ( str.isEmpty() ) {
+      return;
+   }
+
+   VkAtomTable& table = atomTable();
+   {
+      QReadLocker locker( &table.lock );
+      QHash<QString, quint32>::const_iterator it = table.ids.constFind( str );
+      if ( it != table.ids.constEnd() ) {
+         id = it.value();
+         return;
+      }
+   }
+
+   QWriteLocker locker( &table.lock );
+
+   // may have been added while we were unlocked
+   QHash<QString, quint32>::const_iterator it = table.ids.constFind( str );
+   if ( it != table.ids.constEnd() ) {
+      id = it.value();
+      return;
+   }
+
+   // exact-size copy: str may be a (reused) parse buffer
+   QString copy( str.unicode(), str.size() );
+   id = table.strings.count();
+   table.strings.append( copy );
+   table.ids.insert( copy, id );
+   table.bytes += str.size() * sizeof( QChar );
+}
+
+
+QString VkAtom::str() const
+{
+   if ( id == 0 ) {
+      return QString();
+   }
+
+   VkAtomTable& table = atomTable();
+   QReadLocker locker( &table.lock );
+   return table.strings.at( id );
+}
+
+
+int VkAtom::tableCount()
+{
+   VkAtomTable& table = atomTable();
+   QReadLocker locker( &table.lock );
+   return table.strings.count() - 1;
+}
+
+
+/*!
+  Rough memory footprint: string data plus per-entry overheads
+  (one shared QString header, a vector slot, and a hash node)
+*/
+qint64 VkAtom::tableBytes()
+{
+   VkAtomTable& table = atomTable();
+   QReadLocker locker( &table.lock );
+   qint64 perEntry = 24 + sizeof( QString ) + 32;
+   return table.bytes + perEntry * table.strings.count();
+}
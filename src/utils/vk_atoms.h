@@ -0,0 +1,82 @@
+/****************************************************************************
+** VkAtom definition
+**  - interned strings
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_ATOMS_H
+#define __VK_ATOMS_H
+
+#include <QHash>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VkAtom: an interned string.
+
+   - Each distinct string is stored once, in a global table,
+     and an atom is just its index in that table.
+   - So atoms are cheap to copy & store, and compare/hash in O(1).
+   - The empty (or null) string is always atom 0.
+   - The table only ever grows: atoms stay valid for the life of
+     the program. Interning & lookup are thread-safe.
+
+  Used for the (massively repeated) stack frame fields: fn, obj, dir, file
+*/
+class VkAtom
+{
+public:
+   VkAtom() : id( 0 ) {}
+   explicit VkAtom( const QString& str );
+
+   bool isEmpty() const {
+      return id == 0;
+   }
+   quint32 atomId() const {
+      return id;
+   }
+   QString str() const;
+
+   // back from atomId(): the id must be one we gave out
+   static VkAtom fromId( quint32 atomId ) {
+      VkAtom atom;
+      atom.id = atomId;
+      return atom;
+   }
+
+   bool operator==( const VkAtom& other ) const {
+      return id == other.id;
+   }
+   bool operator!=( const VkAtom& other ) const {
+      return id != other.id;
+   }
+
+   // table stats
+   static int    tableCount();
+   static qint64 tableBytes();   // approx. memory held by the table
+
+private:
+   quint32 id;
+};
+
+inline uint qHash( const VkAtom& atom )
+{
+   return atom.atomId();
+}
+
+#endif // #ifndef __VK_ATOMS_H
@@ -42,8 +42,8 @@
 /*!
   Initialise static data: Basic configuration setup
 */
-const unsigned int VkCfg::_projCfgVersion = 1;   // @@@ increment if project config keys change @@@
-const unsigned int VkCfg::_glblCfgVersion = 2;   // @@@ increment if  global config keys change @@@
+const unsigned int VkCfg::_projCfgVersion = 6;   // @@@ increment if project config keys change @@@
+const unsigned int VkCfg::_glblCfgVersion = 3;   // @@@ increment if  global config keys change @@@
 
 const QString VkCfg::_email       = "info@open-works.net"; // bug-reports
 const QString VkCfg::_copyright   = "Valkyrie is Copyright (C) 2003-2011 by OpenWorks GbR";
@@ -418,7 +418,7 @@ void VkCfgGlbl::writeConfigDefaults()
    // These are settings/caches for file/dir-dialogs: filterlist + default filter to use
    // - list key = filefilters/<proj or glbl key, with all '/' replaced by '_'>
    // - dflt key = <list key>-default
-   setValue( "filefilters/valkyrie_view-log", "XML Files (*.xml);;Log Files (*.log.*);;All Files (*)" );
+   setValue( "filefilters/valkyrie_view-log", "XML Files (*.xml);;Compressed XML Files (*.xml.gz *.xml.zst);;Log Files (*.log.*);;All Files (*)" );
    setValue( "filefilters/valkyrie_view-log-default", "" );
    setValue( "filefilters/handbook_docdir", "Html Files (*.html *.htm);;All Files (*)" );
    setValue( "filefilters/handbook_docdir-default", "" );
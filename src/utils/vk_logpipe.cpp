@@ -0,0 +1,183 @@
+/****************************************************************************
+** VkLogPipe implementation
+**  - receives a valgrind xml log over an inherited pipe
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_logpipe.h"
+#include "utils/vk_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// max bytes read from the pipe at a time
+#define VK_LOGPIPE_READ ( 64 * 1024 )
+// max reads each time the pipe's readable: a fast writer mustn't
+// keep the event loop from anything else
+#define VK_LOGPIPE_READS 16
+
+
+/***************************************************************************/
+VkLogPipe::VkLogPipe( QObject* parent )
+   : QObject( parent ), readFd( -1 ), wrFd( -1 ), notifier( 0 ),
+     paused( false )
+{
+   this->setObjectName( "logpipe" );
+}
+
+
+VkLogPipe::~VkLogPipe()
+{
+   close();
+}
+
+
+/*!
+  Create the pipe, and start listening on the read end
+   - only the write end may be inherited: the read end is close-on-exec,
+     so the writer can't hold it (or its own pipe) open.
+*/
+bool VkLogPipe::open( QString teefile )
+{
+   close();
+   errMsg = QString();
+
+   tee.setFileName( teefile );
+   if ( !tee.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+      errMsg = "Failed to open '" + teefile + "': " + tee.errorString();
+      return false;
+   }
+
+   int fds[2];
+   if ( pipe( fds ) != 0 ) {
+      errMsg = QString( "Failed to create pipe: " ) + strerror( errno );
+      tee.close();
+      return false;
+   }
+
+   readFd = fds[0];
+   wrFd   = fds[1];
+   fcntl( readFd, F_SETFD, FD_CLOEXEC );
+   fcntl( readFd, F_SETFL, fcntl( readFd, F_GETFL ) | O_NONBLOCK );
+
+   readBuf.resize( VK_LOGPIPE_READ );
+   paused = false;
+
+   notifier = new QSocketNotifier( readFd, QSocketNotifier::Read, this );
+   connect( notifier, SIGNAL( activated( int ) ),
+            this,     SLOT( readPipe() ) );
+   return true;
+}
+
+
+/*!
+  The writer's started, with its own copy of the write end:
+  drop ours, so we see end-of-file when the writer's done.
+*/
+void VkLogPipe::closeWriteEnd()
+{
+   if ( wrFd != -1 ) {
+      ::close( wrFd );
+      wrFd = -1;
+   }
+}
+
+
+/*!
+  Stop listening: no more signals
+*/
+void VkLogPipe::close()
+{
+   if ( notifier != 0 ) {
+      // may be called from our notifier's signal: readPipe()
+      notifier->setEnabled( false );
+      notifier->deleteLater();
+      notifier = 0;
+   }
+
+   closeWriteEnd();
+
+   if ( readFd != -1 ) {
+      ::close( readFd );
+      readFd = -1;
+   }
+
+   if ( tee.isOpen() ) {
+      tee.close();
+   }
+}
+
+
+/*!
+  Stop (or start again) reading the pipe
+   - while paused, the writer blocks once the pipe's full.
+*/
+void VkLogPipe::setPaused( bool pause )
+{
+   paused = pause;
+   if ( notifier != 0 ) {
+      notifier->setEnabled( !paused );
+   }
+}
+
+
+/*!
+  Pass on what's in the pipe, up to VK_LOGPIPE_READS reads' worth:
+  if there's more, the notifier tells us again.
+*/
+void VkLogPipe::readPipe()
+{
+   for ( int n = 0; n < VK_LOGPIPE_READS && !paused; n++ ) {
+      ssize_t nread = ::read( readFd, readBuf.data(), readBuf.size() );
+
+      if ( nread < 0 && errno == EINTR ) {
+         continue;
+      }
+      if ( nread < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+         break;   // all read: wait for more
+      }
+
+      if ( nread <= 0 ) {
+         // end of file (or a broken pipe): that's all.
+         if ( nread < 0 ) {
+            vkPrintErr( "VkLogPipe::readPipe(): %s", strerror( errno ) );
+         }
+         tee.flush();
+         close();
+         emit closed();
+         return;
+      }
+
+      // a deep copy: readBuf is reused
+      QByteArray data( readBuf.constData(), nread );
+
+      if ( tee.write( data ) != data.size() ) {
+         vkPrintErr( "VkLogPipe::readPipe(): failed to write '%s': %s",
+                     qPrintable( tee.fileName() ),
+                     qPrintable( tee.errorString() ) );
+      }
+
+      emit received( data );
+
+      if ( readFd == -1 ) {
+         return;   // closed by the receiver
+      }
+   }
+}
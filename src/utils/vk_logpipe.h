@@ -0,0 +1,81 @@
+/****************************************************************************
+** VkLogPipe definition
+**  - receives a valgrind xml log over an inherited pipe
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_LOGPIPE_H
+#define __VK_LOGPIPE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+
+
+// ============================================================
+/*!
+  class VkLogPipe
+   - A pipe for valgrind's --xml-fd=<writeFd()>: the write end is
+     inherited by the valgrind process, we keep the read end.
+   - Data is passed on via received() as soon as it arrives
+     (no polling), and closed() once every writer has gone.
+   - setPaused() stops us reading the pipe, e.g. while whoever gets
+     the data is behind: the pipe fills, and holds back the writer.
+   - Everything received is also written to a tee file, so the log
+     can still be saved (copied) once the run's done.
+*/
+class VkLogPipe : public QObject
+{
+   Q_OBJECT
+public:
+   VkLogPipe( QObject* parent );
+   ~VkLogPipe();
+
+   bool open( QString teefile );
+   void closeWriteEnd();    // once the writer has it
+   void close();
+   void setPaused( bool pause );
+   bool isOpen() {
+      return readFd != -1;
+   }
+   int writeFd() {
+      return wrFd;
+   }
+   QString errorString() {
+      return errMsg;
+   }
+
+signals:
+   void received( QByteArray data );
+   void closed();
+
+private slots:
+   void readPipe();
+
+private:
+   int readFd;
+   int wrFd;
+   QSocketNotifier* notifier;
+   bool paused;
+   QFile tee;
+   QByteArray readBuf;
+   QString errMsg;
+};
+
+#endif // #ifndef __VK_LOGPIPE_H
@@ -19,36 +19,73 @@
 ****************************************************************************/
 
 #include "utils/vk_logpoller.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// watching the log itself: data written, or the file gone from its name
+#define VK_WATCH_LOG ( IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF )
+// watching the log's directory: a new file given the log's name
+#define VK_WATCH_DIR ( IN_CREATE | IN_MOVED_TO )
+#endif
 
 
 /***************************************************************************/
 VkLogPoller::VkLogPoller( QObject* parent )
-   : QObject( parent )
+   : QObject( parent ), watchFd( -1 ), watchWd( -1 ), dirWd( -1 ),
+     notifier( 0 ), logSize( 0 ), logIno( 0 )
 {
    this->setObjectName( "logpoller" );
 
    timer = new QTimer( this );
 
    connect( timer, SIGNAL( timeout() ),
-            this,  SIGNAL( logUpdated() ) );
+            this,    SLOT( pollLog() ) );
 }
 
 
 VkLogPoller::~VkLogPoller()
 {
+   stopWatch();
    // timer deleted by it's parent: this
 }
 
 
-// start with interval msecs
-void VkLogPoller::start( int interval )
+/*!
+  start watching / polling
+   - if logfile given, try to watch it: timer only used as a fallback.
+*/
+void VkLogPoller::start( int interval, QString logfile )
 {
+   stop();
+
+   logFname = logfile;
+   logSize  = 0;
+   logIno   = 0;
+   statLog( &logIno, 0 );
+
+   if ( !logfile.isEmpty() && startWatch( logfile ) ) {
+      // pick up anything written before the watch was set up.
+      QTimer::singleShot( 0, this, SIGNAL( logUpdated() ) );
+      return;
+   }
+
    timer->start( interval );
 }
 
 
 void VkLogPoller::stop()
 {
+   stopWatch();
+
    if ( timer->isActive() ) {
       timer->stop();
    }
@@ -57,6 +94,224 @@ void VkLogPoller::stop()
 
 bool VkLogPoller::isActive()
 {
-   return timer->isActive();
+   return isWatching() || timer->isActive();
+}
+
+
+bool VkLogPoller::isWatching()
+{
+   return notifier != 0;
+}
+
+
+/*!
+  Set up an inotify watch on the logfile.
+   - returns false if not possible: use the timer instead.
+*/
+bool VkLogPoller::startWatch( QString logfile )
+{
+#ifdef Q_OS_LINUX
+   vk_assert( watchFd == -1 );
+
+   watchFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+   if ( watchFd == -1 ) {
+      vkPrintErr( "VkLogPoller: inotify_init1 failed: %s", strerror( errno ) );
+      return false;
+   }
+
+   watchWd = inotify_add_watch( watchFd, QFile::encodeName( logfile ).constData(),
+                                VK_WATCH_LOG );
+   if ( watchWd == -1 ) {
+      vkPrintErr( "VkLogPoller: failed to watch '%s': %s",
+                  qPrintable( logfile ), strerror( errno ) );
+      ::close( watchFd );
+      watchFd = -1;
+      return false;
+   }
+
+   // not fatal: we just won't see the log being replaced by a rename.
+   QString dir = QFileInfo( logfile ).absolutePath();
+   dirWd = inotify_add_watch( watchFd, QFile::encodeName( dir ).constData(),
+                              VK_WATCH_DIR );
+
+   notifier = new QSocketNotifier( watchFd, QSocketNotifier::Read, this );
+   connect( notifier, SIGNAL( activated( int ) ),
+            this,       SLOT( readEvents() ) );
+   return true;
+#else
+   Q_UNUSED( logfile );
+   return false;
+#endif
+}
+
+
+void VkLogPoller::stopWatch()
+{
+#ifdef Q_OS_LINUX
+   if ( notifier != 0 ) {
+      notifier->setEnabled( false );
+      delete notifier;
+      notifier = 0;
+   }
+
+   if ( watchFd != -1 ) {
+      ::close( watchFd );   // also removes the watch
+      watchFd = -1;
+      watchWd = -1;
+      dirWd   = -1;
+   }
+#endif
+}
+
+
+/*
+  Current inode & size of the file named as the log: false if none.
+*/
+bool VkLogPoller::statLog( quint64* ino, qint64* size )
+{
+   if ( logFname.isEmpty() ) {
+      return false;
+   }
+
+#ifdef Q_OS_LINUX
+   struct stat st;
+   if ( ::stat( QFile::encodeName( logFname ).constData(), &st ) != 0 ) {
+      return false;
+   }
+   if ( ino != 0 ) {
+      *ino = st.st_ino;
+   }
+   if ( size != 0 ) {
+      *size = st.st_size;
+   }
+#else
+   QFileInfo fi( logFname );
+   if ( !fi.exists() ) {
+      return false;
+   }
+   if ( ino != 0 ) {
+      *ino = 0;   // no inodes: only truncation is seen
+   }
+   if ( size != 0 ) {
+      *size = fi.size();
+   }
+#endif
+   return true;
+}
+
+
+/*
+  Is the log we're reading still the file by that name?
+   - not if it's been truncated, or another file's taken the name:
+     watch that one instead, and tell our user to start over.
+   - size gets the log's current size: -1 if there's no such file (yet).
+*/
+bool VkLogPoller::checkReplaced( qint64* size )
+{
+   quint64 ino = 0;
+   *size = -1;
+   if ( !statLog( &ino, size ) ) {
+      *size = -1;
+      return false;   // gone: wait for its replacement
+   }
+
+   if ( logIno == 0 ) {
+      logIno = ino;   // didn't exist when we started
+   }
+   if ( ino == logIno && *size >= logSize ) {
+      return false;
+   }
+
+   logIno  = ino;
+   logSize = 0;
+
+#ifdef Q_OS_LINUX
+   if ( watchFd != -1 ) {
+      // a watch belongs to a file, not its name
+      if ( watchWd != -1 ) {
+         inotify_rm_watch( watchFd, watchWd );
+      }
+      watchWd = inotify_add_watch( watchFd,
+                                   QFile::encodeName( logFname ).constData(),
+                                   VK_WATCH_LOG );
+   }
+#endif
+
+   emit logReplaced();
+   return true;
+}
+
+
+/*!
+  Timer fallback: signal an update every time around,
+  unless the log's been replaced.
+*/
+void VkLogPoller::pollLog()
+{
+   qint64 size;
+   if ( checkReplaced( &size ) ) {
+      return;
+   }
+
+   if ( size > logSize ) {
+      logSize = size;
+   }
+   emit logUpdated();
+}
+
+
+/*!
+  Drain the pending inotify events:
+  signal an update if the log grew, or the writer closed it,
+  or a replacement if it's been truncated or replaced.
+*/
+void VkLogPoller::readEvents()
+{
+#ifdef Q_OS_LINUX
+   bool closed = false;
+   bool seen = false;      // any event for the log, not just its neighbours
+   QByteArray logName = QFile::encodeName( QFileInfo( logFname ).fileName() );
+   char buf[ 4096 ]
+   __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+
+   for ( ;; ) {
+      ssize_t len = ::read( watchFd, buf, sizeof( buf ) );
+      if ( len <= 0 ) {
+         break;   // EAGAIN: all read
+      }
+
+      for ( char* p = buf; p < buf + len; ) {
+         const struct inotify_event* ev = ( const struct inotify_event* )p;
+         if ( ev->wd == dirWd ) {
+            // some file in the log's directory: only the log's name matters.
+            if ( ev->len > 0 && logName == ev->name ) {
+               seen = true;
+            }
+         }
+         else {
+            seen = true;
+            if ( ev->mask & IN_CLOSE_WRITE ) {
+               closed = true;
+            }
+         }
+         p += sizeof( struct inotify_event ) + ev->len;
+      }
+   }
+
+   if ( !seen ) {
+      return;
+   }
+
+   // a truncate, or a rename over the log, has no event of its own
+   qint64 size;
+   if ( checkReplaced( &size ) ) {
+      return;
+   }
+
+   if ( size > logSize || ( closed && size != -1 ) ) {
+      logSize = size;
+      emit logUpdated();
+   }
+#endif
 }
 
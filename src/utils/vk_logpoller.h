@@ -22,19 +22,23 @@
 #define VK_LOGPOLLER_H
 
 #include <QObject>
+#include <QSocketNotifier>
+#include <QString>
 #include <QTimer>
 
 
-/*!
-  NOTE:
-  Future intention is to have another thread running select on the
-  given file, so triggering signal when the file is updated.
-  Or something...
-*/
-
 // ============================================================
 /*!
   class VkLogPoller
+   - Given a logfile (on Linux), watches it via inotify:
+     logUpdated() is only emitted when data has been appended to
+     the log, or when the writer closes it.
+     No busy polling, and new data is signalled straight away.
+   - Otherwise (no logfile, or inotify not available), falls back
+     to plain polling: logUpdated() is emitted every 'interval' msecs.
+   - If the log is truncated, or another file takes its name (e.g. a
+     test harness re-running valgrind), the new file is watched instead,
+     and logReplaced() is emitted: the log must be re-read from the start.
 */
 class VkLogPoller : public QObject
 {
@@ -43,16 +47,38 @@ public:
    VkLogPoller( QObject* parent );
    ~VkLogPoller();
 
-   void start( int interval = 100 ); // msec
+   void start( int interval = 100, // msec
+               QString logfile = QString() );
    void stop();
    bool isActive();
    int  interval();
+   bool isWatching();
 
 signals:
    void logUpdated();
+   void logReplaced();
+
+private slots:
+   void readEvents();
+   void pollLog();
+
+private:
+   bool startWatch( QString logfile );
+   void stopWatch();
+   bool statLog( quint64* ino, qint64* size );
+   bool checkReplaced( qint64* size );
 
 private:
    QTimer* timer;
+
+   // inotify watch
+   int watchFd;
+   int watchWd;
+   int dirWd;              // the log's directory: new files named as the log
+   QSocketNotifier* notifier;
+   QString logFname;
+   qint64 logSize;         // size as of last logUpdated()
+   quint64 logIno;         // inode of the file we're reading
 };
 
 #endif // VK_LOGPOLLER_H
@@ -0,0 +1,378 @@
+/****************************************************************************
+** VkLogServer implementation
+**  - receives valgrind xml logs over local socket connections
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_logserver.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QHostAddress>
+#include <QRunnable>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+
+// each connection's buffer: once it's full, we stop reading the
+// socket (see setPaused())
+#define VK_LOGSERVER_READ ( 1024 * 1024 )
+// a log bigger than this goes to disk
+#define VK_LOGSERVER_MEM_MAX ( 64 * 1024 * 1024 )
+
+
+// ============================================================
+/*
+  Writes a log to disk, on a pool thread: or copies it, if spilled
+*/
+class VkLogWriter : public QRunnable
+{
+public:
+   VkLogWriter( VkLogServer* srv, const QByteArray& log, QString spill,
+                QString fname )
+      : server( srv ), data( log ), spillFname( spill ), logFname( fname ) { }
+
+   void run() {
+      QString errMsg;
+
+      // first delete if already exists
+      if ( QFile::exists( logFname ) ) {
+         QFile::remove( logFname );
+      }
+
+      if ( !spillFname.isEmpty() ) {
+         QFile spill( spillFname );
+         if ( !spill.copy( logFname ) ) {
+            errMsg = spill.errorString();
+         }
+      }
+      else {
+         QFile file( logFname );
+         if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+            errMsg = file.errorString();
+         }
+         else if ( file.write( data ) != data.size() ) {
+            errMsg = file.errorString();
+         }
+         file.close();
+      }
+
+      QMetaObject::invokeMethod( server, "writeDone", Qt::QueuedConnection,
+                                 Q_ARG( QString, logFname ),
+                                 Q_ARG( QString, errMsg ) );
+   }
+
+private:
+   VkLogServer* server;
+   QByteArray data;       // shared with the server's copy: no real copy
+   QString spillFname;
+   QString logFname;
+};
+
+
+
+/***************************************************************************/
+VkLogServer::VkLogServer( QObject* parent )
+   : QObject( parent ), spillFailed( false )
+{
+   this->setObjectName( "logserver" );
+
+   server = new QTcpServer( this );
+   connect( server, SIGNAL( newConnection() ),
+            this,   SLOT( newConnection() ) );
+
+   writers.setMaxThreadCount( 1 );
+}
+
+
+VkLogServer::~VkLogServer()
+{
+   // writers report back to us: clear() lets them finish first.
+   clear();
+   // server deleted by it's parent: this
+}
+
+
+/*!
+  Start listening on a free localhost port
+   - a log that needs spilling goes to a new file named from spillBase,
+     e.g. VkCfg::tmpDir() + "memcheck_log".
+*/
+bool VkLogServer::listen( QString spillBase )
+{
+   clear();
+
+   spillPath = spillBase;
+   spillFailed = false;
+   return server->listen( QHostAddress::LocalHost, 0 );
+}
+
+
+/*!
+  Stop listening, and drop any live connections: no more signals.
+   - the logs received so far are kept.
+*/
+void VkLogServer::close()
+{
+   server->close();
+
+   for ( int id = 0; id < sockets.count(); id++ ) {
+      QTcpSocket* sock = sockets[id];
+      if ( sock != 0 ) {
+         sock->disconnect( this );
+         sock->abort();
+         sock->deleteLater();
+         sockets[id] = 0;
+      }
+   }
+}
+
+
+bool VkLogServer::isListening()
+{
+   return server->isListening();
+}
+
+
+QString VkLogServer::address()
+{
+   return server->serverAddress().toString() + ":" +
+          QString::number( server->serverPort() );
+}
+
+
+QString VkLogServer::errorString()
+{
+   return server->errorString();
+}
+
+
+/*!
+  Forget the logs, and remove any spill files
+   - any being saved are written first.
+*/
+void VkLogServer::clear()
+{
+   close();
+   writers.waitForDone();
+
+   foreach( QFile* spill, spills ) {
+      if ( spill != 0 ) {
+         spill->remove();
+      }
+   }
+   qDeleteAll( spills );
+
+   sockets.clear();
+   logs.clear();
+   spills.clear();
+   spillErrors.clear();
+   paused.clear();
+}
+
+
+/*!
+  Take any connections that have been made, but not yet picked up
+  by the event loop: e.g. when valgrind is already done.
+*/
+void VkLogServer::acceptPending()
+{
+   if ( !server->isListening() ) {
+      return;
+   }
+
+   while ( server->waitForNewConnection( 0 ) ) {
+      newConnection();   // in case it wasn't signalled
+   }
+}
+
+
+/*!
+  Write log 'id' to fname, in the background
+   - as much of it as has been received, if the connection's still live.
+*/
+void VkLogServer::saveLog( int id, QString fname )
+{
+   vk_assert( id >= 0 && id < logs.count() );
+
+   if ( !spillErrors[id].isEmpty() ) {
+      QMetaObject::invokeMethod( this, "writeDone", Qt::QueuedConnection,
+                                 Q_ARG( QString, fname ),
+                                 Q_ARG( QString, spillErrors[id] ) );
+      return;
+   }
+
+   QFile* spill = spills[id];
+   if ( spill == 0 ) {
+      writers.start( new VkLogWriter( this, logs[id], QString(), fname ) );
+      return;
+   }
+
+   if ( spill->isOpen() ) {
+      spill->flush();
+   }
+   writers.start( new VkLogWriter( this, QByteArray(), spill->fileName(), fname ) );
+}
+
+
+void VkLogServer::writeDone( QString fname, QString errMsg )
+{
+   emit saved( fname, errMsg );
+}
+
+
+/*!
+  New connection(s): one per valgrind process
+*/
+void VkLogServer::newConnection()
+{
+   while ( server->hasPendingConnections() ) {
+      QTcpSocket* sock = server->nextPendingConnection();
+      sock->setParent( this );
+
+      int id = sockets.count();
+      sockets.append( sock );
+      paused.append( false );
+      sock->setReadBufferSize( VK_LOGSERVER_READ );
+
+      logs.append( QByteArray() );
+      spills.append( 0 );
+      spillErrors.append( QString() );
+
+      connect( sock, SIGNAL( readyRead() ),
+               this, SLOT( readSocket() ) );
+      connect( sock, SIGNAL( disconnected() ),
+               this, SLOT( socketClosed() ) );
+
+      emit opened( id );
+   }
+}
+
+
+void VkLogServer::readSocket()
+{
+   QTcpSocket* sock = qobject_cast<QTcpSocket*>( sender() );
+   int id = sockets.indexOf( sock );
+   if ( id != -1 && !paused[id] ) {
+      readLog( id );
+   }
+}
+
+
+/*!
+  Stop (or start again) reading connection 'id'
+   - while paused, what's received fills the socket's read buffer,
+     then the kernel's, then the sender waits.
+   - ids from before the last clear() are ignored.
+*/
+void VkLogServer::setPaused( int id, bool pause )
+{
+   if ( id < 0 || id >= paused.count() ) {
+      return;
+   }
+
+   paused[id] = pause;
+
+   // anything already buffered won't be signalled again
+   if ( !pause && sockets[id] != 0 ) {
+      readLog( id );
+   }
+}
+
+
+/*!
+  Pass on whatever's come in on connection 'id', keeping a copy
+*/
+void VkLogServer::readLog( int id )
+{
+   QTcpSocket* sock = sockets[id];
+   if ( sock->bytesAvailable() == 0 ) {
+      return;
+   }
+
+   QByteArray data = sock->readAll();
+
+   if ( spills[id] == 0 && !spillFailed &&
+        logs[id].size() + data.size() > VK_LOGSERVER_MEM_MAX ) {
+      spillLog( id );
+   }
+
+   QFile* spill = spills[id];
+   if ( spill == 0 ) {
+      logs[id].append( data );
+   }
+   else if ( spill->isOpen() && spill->write( data ) != data.size() ) {
+      spillErrors[id] = "Failed to write '" + spill->fileName() + "': " +
+                        spill->errorString();
+      vkPrintErr( "VkLogServer: %s", qPrintable( spillErrors[id] ) );
+      spill->close();
+   }
+
+   emit received( id, data );
+}
+
+
+/*!
+  Log 'id' is too big to keep in memory: move it to a file of its own
+   - if the file can't be written, we stop trying: this and any other
+     logs just stay in memory.
+*/
+void VkLogServer::spillLog( int id )
+{
+   QFile* spill = new QFile( vk_mkstemp( spillPath, "xml" ) );
+
+   if ( !spill->open( QIODevice::WriteOnly | QIODevice::Truncate ) ||
+        spill->write( logs[id] ) != logs[id].size() ) {
+      vkPrintErr( "VkLogServer: failed to spill log to '%s': %s",
+                  qPrintable( spill->fileName() ),
+                  qPrintable( spill->errorString() ) );
+      spill->remove();
+      delete spill;
+      spillFailed = true;
+      return;
+   }
+
+   spills[id] = spill;
+   logs[id] = QByteArray();
+}
+
+
+/*!
+  Valgrind's done with this log
+*/
+void VkLogServer::socketClosed()
+{
+   QTcpSocket* sock = qobject_cast<QTcpSocket*>( sender() );
+   int id = sockets.indexOf( sock );
+   if ( id == -1 ) {
+      return;
+   }
+
+   // anything still buffered, paused or not: that's all there is
+   readLog( id );
+
+   sockets[id] = 0;
+   sock->disconnect( this );
+   sock->deleteLater();
+
+   // the log's complete: flush any spill file, ready for saving.
+   if ( spills[id] != 0 ) {
+      spills[id]->close();
+   }
+
+   emit closed( id );
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+** VkLogServer definition
+**  - receives valgrind xml logs over local socket connections
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VK_LOGSERVER_H
+#define __VK_LOGSERVER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+class QTcpServer;
+class QTcpSocket;
+
+
+// ============================================================
+/*!
+  class VkLogServer
+   - Listens on localhost, for valgrind's --xml-socket=<address()>:
+     valgrind connects once per process (so once per traced child),
+     and each connection is a complete log.
+   - Connections are numbered from 0, in the order they're made:
+     data is passed on via received() as it arrives.
+   - setPaused() stops us reading a connection, e.g. while whoever
+     gets the data is behind: TCP flow control holds back the sender.
+   - Each log is kept in memory, and only written to disk by
+     saveLog(), in the background: saved() reports the outcome.
+   - Except a log that grows past VK_LOGSERVER_MEM_MAX: that's spilled
+     to a temporary file, and goes on there. saveLog() copies it.
+     If it can't be spilled, it stays in memory.
+   - Spill files go once the logs are forgotten: clear(), listen(),
+     or when we go.
+*/
+class VkLogServer : public QObject
+{
+   Q_OBJECT
+public:
+   VkLogServer( QObject* parent );
+   ~VkLogServer();
+
+   bool listen( QString spillBase );   // forgets any previous logs
+   void close();            // stop listening, drop all connections
+   bool isListening();
+   QString address();       // <ip>:<port>
+   QString errorString();
+
+   void acceptPending();    // connections not yet signalled
+
+   // logs received since the last listen()
+   int count() {
+      return logs.count();
+   }
+   void clear();
+   void saveLog( int id, QString fname );
+   void setPaused( int id, bool pause );
+
+signals:
+   void opened( int id );
+   void received( int id, QByteArray data );
+   void closed( int id );
+   void saved( QString fname, QString errMsg );
+
+private slots:
+   void newConnection();
+   void readSocket();
+   void socketClosed();
+   void writeDone( QString fname, QString errMsg );
+
+private:
+   void readLog( int id );
+   void spillLog( int id );
+
+private:
+   QTcpServer* server;
+   QList<QTcpSocket*> sockets;  // by connection id: 0 once closed
+   QList<bool> paused;          // by connection id
+   QList<QByteArray> logs;      // everything received, by connection id
+   QList<QFile*> spills;        // by connection id: 0 unless spilled
+   QStringList spillErrors;     // by connection id: why it can't be saved
+   QString spillPath;           // spill files: <spillPath>_<datetime>.xml
+   bool spillFailed;            // no more spilling: keep it all in memory
+   QThreadPool writers;
+};
+
+#endif // #ifndef __VK_LOGSERVER_H
@@ -12,4 +12,6 @@ QT += printsupport
 TEMPLATE = subdirs
 SUBDIRS  = src
 
+# bench/ (benchmarks) is built on its own
+
 
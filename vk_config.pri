@@ -28,10 +28,6 @@ target.path    = $$BINDIR
 doc.path       = $$DATADIR/$$PACKAGE/doc
 doc_imgs.path  = $$DATADIR/$$PACKAGE/doc/images
 
-######################################################################
-# Qt modules
-QT += xml
-
 ######################################################################
 # Project configuration & compiler options
 CONFIG           += qt